@@ -0,0 +1,63 @@
+#ifndef PILAFIJA_H
+#define PILAFIJA_H
+
+#include <stdexcept>
+
+// Pila de capacidad fija con almacenamiento en linea: push y pop no reservan memoria.
+// Se usa para el camino raiz-hoja, cuya longitud esta acotada por la altura del arbol
+// (a lo mas log_2(n) + 1 niveles, menos de 32 para n de tipo int).
+template <typename T, int CAPACIDAD = 64>
+class PilaFija {
+    private:
+        T datos[CAPACIDAD];
+        int tope;
+    public:
+        PilaFija() : tope(0) {}
+
+        void push(const T& data) {
+            if (tope == CAPACIDAD)
+                throw std::length_error("Pila llena");
+            datos[tope++] = data;
+        }
+
+        T pop() {
+            if (is_empty())
+                throw std::runtime_error("Pila vacía");
+            return datos[--tope];
+        }
+
+        T& top() {
+            if (is_empty())
+                throw std::runtime_error("Pila vacía");
+            return datos[tope - 1];
+        }
+
+        const T& top() const {
+            if (is_empty())
+                throw std::runtime_error("Pila vacía");
+            return datos[tope - 1];
+        }
+
+        bool is_empty() const {
+            return tope == 0;
+        }
+
+        int size() const {
+            return tope;
+        }
+
+        // acceso desde la base (0 = raiz en un camino)
+        T& operator[](int i) {
+            return datos[i];
+        }
+
+        const T& operator[](int i) const {
+            return datos[i];
+        }
+
+        void clear() {
+            tope = 0;
+        }
+};
+
+#endif
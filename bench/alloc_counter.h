@@ -0,0 +1,57 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+// Reemplaza el operator new global para contar reservas y los bytes vivos en el heap
+// (tamaño real de cada bloque segun malloc). Incluir en un solo .cpp por ejecutable.
+namespace bench {
+    inline std::size_t reservas = 0;
+    inline std::size_t bytesVivos = 0;
+
+    inline void* registrar(void* p) {
+        if (p == nullptr)
+            throw std::bad_alloc();
+        ++reservas;
+        bytesVivos += malloc_usable_size(p);
+        return p;
+    }
+
+    inline void liberar(void* p) {
+        if (p != nullptr)
+            bytesVivos -= malloc_usable_size(p);
+        std::free(p);
+    }
+}
+
+void* operator new(std::size_t bytes) {
+    return bench::registrar(std::malloc(bytes ? bytes : 1));
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alineacion) {
+    std::size_t a = static_cast<std::size_t>(alineacion);
+    return bench::registrar(std::aligned_alloc(a, (bytes + a - 1) / a * a));
+}
+
+void* operator new[](std::size_t bytes) {
+    return operator new(bytes);
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t alineacion) {
+    return operator new(bytes, alineacion);
+}
+
+void operator delete(void* p) noexcept { bench::liberar(p); }
+void operator delete(void* p, std::size_t) noexcept { bench::liberar(p); }
+void operator delete[](void* p) noexcept { bench::liberar(p); }
+void operator delete[](void* p, std::size_t) noexcept { bench::liberar(p); }
+void operator delete(void* p, std::align_val_t) noexcept { bench::liberar(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { bench::liberar(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { bench::liberar(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { bench::liberar(p); }
+
+#endif
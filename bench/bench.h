@@ -0,0 +1,175 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// utilidades comunes de los benchmarks
+namespace bench {
+
+    class Cronometro {
+    private:
+        std::chrono::steady_clock::time_point inicio;
+    public:
+        Cronometro() : inicio(std::chrono::steady_clock::now()) {}
+
+        void reiniciar() {
+            inicio = std::chrono::steady_clock::now();
+        }
+
+        double segundos() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        }
+    };
+
+    // evita que el compilador elimine un resultado que no se usa
+    template <typename T>
+    inline void noOptimizar(const T& valor) {
+        asm volatile("" : : "r"(&valor) : "memory");
+    }
+
+    // contador de hardware (por defecto fallos de cache) via perf_event_open.
+    // Si el kernel no lo permite, disponible() es false y leer() retorna 0.
+    class ContadorHardware {
+    private:
+        int fd = -1;
+    public:
+#if defined(__linux__)
+        explicit ContadorHardware(uint64_t evento = PERF_COUNT_HW_CACHE_MISSES) {
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = evento;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        ~ContadorHardware() {
+            if (fd >= 0)
+                close(fd);
+        }
+
+        void iniciar() {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+
+        uint64_t leer() {
+            uint64_t valor = 0;
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                if (read(fd, &valor, sizeof(valor)) != sizeof(valor))
+                    valor = 0;
+            }
+            return valor;
+        }
+#else
+        explicit ContadorHardware(uint64_t = 0) {}
+        void iniciar() {}
+        uint64_t leer() { return 0; }
+#endif
+        ContadorHardware(const ContadorHardware&) = delete;
+        ContadorHardware& operator=(const ContadorHardware&) = delete;
+
+        bool disponible() const {
+            return fd >= 0;
+        }
+    };
+
+    // argv[i] como entero, o porDefecto si no se paso
+    inline size_t argumento(int argc, char** argv, int i, size_t porDefecto) {
+        return (i < argc) ? std::strtoull(argv[i], nullptr, 10) : porDefecto;
+    }
+
+    // n enteros aleatorios en [0, maximo)
+    inline std::vector<int> enterosAleatorios(size_t n, int maximo, uint32_t semilla = 42) {
+        std::mt19937 rng(semilla);
+        std::uniform_int_distribution<int> dist(0, maximo - 1);
+        std::vector<int> result(n);
+        for (auto& x : result)
+            x = dist(rng);
+        return result;
+    }
+
+    // Rangos 1..n con distribucion Zipf de exponente s (el rango k sale con probabilidad
+    // proporcional a 1 / k^s), por rechazo-inversion (Hormann y Derflinger): O(1) por muestra y
+    // sin tablas, asi sirve para n de 10^8.
+    class Zipf {
+    private:
+        double n, s;
+        double hIntegralX1, hIntegralN, umbral;
+
+        // log1p(x) / x y expm1(x) / x, estables cerca de 0
+        static double auxiliar1(double x) {
+            return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1 - x / 2 + x * x / 3;
+        }
+
+        static double auxiliar2(double x) {
+            return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1 + x / 2 + x * x / 6;
+        }
+
+        double h(double x) const {
+            return std::exp(-s * std::log(x));
+        }
+
+        double hIntegral(double x) const {
+            double logX = std::log(x);
+            return auxiliar2((1 - s) * logX) * logX;
+        }
+
+        double hIntegralInversa(double x) const {
+            double t = std::max(-1.0, x * (1 - s));
+            return std::exp(auxiliar1(t) * x);
+        }
+    public:
+        Zipf(uint64_t n_, double s_ = 0.99)
+            : n(static_cast<double>(n_)), s(s_), hIntegralX1(hIntegral(1.5) - 1), hIntegralN(hIntegral(n + 0.5)),
+              umbral(2 - hIntegralInversa(hIntegral(2.5) - h(2))) {}
+
+        template <typename Rng>
+        uint64_t operator()(Rng& rng) {
+            std::uniform_real_distribution<double> uniforme(0, 1);
+            while (true) {
+                double u = hIntegralN + uniforme(rng) * (hIntegralX1 - hIntegralN);
+                double x = hIntegralInversa(u);
+                double k = std::min(n, std::max(1.0, std::floor(x + 0.5)));
+                if (k - x <= umbral || u >= hIntegral(k + 0.5) - h(k))
+                    return static_cast<uint64_t>(k);
+            }
+        }
+    };
+
+    // mezcla los bits de x (splitmix64): dispersa los rangos populares de Zipf por todo el dominio
+    inline uint64_t dispersar(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    // claves string de ancho fijo para que el orden lexicografico coincida con el numerico
+    inline std::string claveString(int x) {
+        std::string s = std::to_string(x);
+        return std::string(12 - s.size(), '0') + s;
+    }
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+// BTreeMap<int, long> contra la combinacion BTree<int> + std::unordered_map<int, long>
+// para guardar un payload por key: memoria, insercion, busqueda del valor y actualizacion.
+// uso: btree_map [n_claves] [M]
+#include <cstdio>
+#include <unordered_map>
+
+#include "../btreemap.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 32));
+    std::vector<int> claves = bench::enterosAleatorios(n, 1 << 30, 1);
+    std::vector<int> consultas = bench::enterosAleatorios(n, static_cast<int>(n), 2);
+    for (int& c : consultas)
+        c = claves[c];
+
+    std::printf("M = %d, n = %zu\n", M, n);
+    std::printf("%-22s %12s %14s %14s %14s\n", "", "MiB", "insert ops/s", "find ops/s", "update ops/s");
+
+    long suma = 0;
+    {
+        size_t antes = bench::bytesVivos;
+        bench::Cronometro cronometro;
+        BTree<int> indice(M);
+        std::unordered_map<int, long> payload;
+        for (int key : claves) {
+            indice.insert(key);
+            payload[key] = key;
+        }
+        double insercion = n / cronometro.segundos();
+        double mib = (bench::bytesVivos - antes) / 1048576.0;
+
+        cronometro.reiniciar();
+        for (int key : consultas)
+            if (indice.search(key))
+                suma += payload.find(key)->second;
+        double busqueda = n / cronometro.segundos();
+
+        cronometro.reiniciar();
+        for (int key : consultas)
+            if (indice.search(key))
+                payload[key] += 1;
+        double actualizacion = n / cronometro.segundos();
+        std::printf("%-22s %12.1f %14.0f %14.0f %14.0f\n", "BTree + unordered_map", mib, insercion, busqueda, actualizacion);
+    }
+    {
+        size_t antes = bench::bytesVivos;
+        bench::Cronometro cronometro;
+        BTreeMap<int, long> mapa(M);
+        for (int key : claves)
+            mapa.insert_or_assign(key, key);
+        double insercion = n / cronometro.segundos();
+        double mib = (bench::bytesVivos - antes) / 1048576.0;
+
+        cronometro.reiniciar();
+        for (int key : consultas)
+            if (const long* valor = mapa.find(key))
+                suma += *valor;
+        double busqueda = n / cronometro.segundos();
+
+        cronometro.reiniciar();
+        for (int key : consultas)
+            if (long* valor = mapa.find(key))
+                *valor += 1;
+        double actualizacion = n / cronometro.segundos();
+        std::printf("%-22s %12.1f %14.0f %14.0f %14.0f\n", "BTreeMap", mib, insercion, busqueda, actualizacion);
+    }
+    bench::noOptimizar(suma);
+    return 0;
+}
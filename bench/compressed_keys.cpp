@@ -0,0 +1,74 @@
+// Keys comprimidas contra el layout normal: BTree<std::string> / BTree<long> armados con la carga
+// masiva contra CompressedBTree sobre las mismas keys. Bytes por key en el heap (incluye el heap
+// de cada std::string), busquedas aleatorias de keys presentes y un rangeSearch corto.
+// Strings: URLs ordenadas que comparten prefijos largos. Enteros: IDs crecientes con saltos chicos.
+// uso: compressed_keys [n_claves] [M]
+#include <cstdio>
+#include <string>
+
+#include "../btree.h"
+#include "../compressedbtree.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+template <typename Arbol, typename TK>
+static void medir(const char* nombre, const std::vector<TK>& claves, const std::vector<int>& consultas,
+                  Arbol* (*construir)(const std::vector<TK>&)) {
+    size_t antes = bench::bytesVivos;
+    Arbol* arbol = construir(claves);
+    double bytesPorKey = double(bench::bytesVivos - antes) / claves.size();
+
+    bench::Cronometro cronometro;
+    size_t encontradas = 0;
+    for (int i : consultas)
+        encontradas += arbol->search(claves[i]);
+    double nsBusqueda = cronometro.segundos() * 1e9 / consultas.size();
+
+    cronometro.reiniciar();
+    size_t total = 0;
+    const size_t rangos = consultas.size() / 16;
+    for (size_t r = 0; r < rangos; ++r) {
+        int i = consultas[r];
+        int j = std::min<int>(i + 100, static_cast<int>(claves.size()) - 1);
+        total += arbol->rangeSearch(claves[i], claves[j]).size();
+    }
+    double nsRango = cronometro.segundos() * 1e9 / rangos;
+    bench::noOptimizar(encontradas + total);
+    std::printf("%-28s %12.2f %14.1f %18.1f\n", nombre, bytesPorKey, nsBusqueda, nsRango);
+    delete arbol;
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    static int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+
+    std::vector<std::string> urls(n);
+    std::vector<long> ids(n);
+    std::vector<int> saltos = bench::enterosAleatorios(n, 1000, 3);
+    long id = 1000000000000L;
+    for (size_t i = 0; i < n; ++i) {
+        char url[96];
+        std::snprintf(url, sizeof(url), "https://www.example.com/api/v2/users/%010zu/profile", i * 7);
+        urls[i] = url;
+        id += 1 + saltos[i];
+        ids[i] = id;
+    }
+    std::vector<int> consultas = bench::enterosAleatorios(n, static_cast<int>(n), 4);
+
+    std::printf("n = %zu, M = %d, bloques de 64 keys\n", n, M);
+    std::printf("%-28s %12s %14s %18s\n", "", "bytes/key", "ns/search", "ns/rangeSearch(100)");
+    medir<BTree<std::string>, std::string>("BTree<string>", urls, consultas, [](const std::vector<std::string>& v) {
+        return BTree<std::string>::build_from_ordered_vector_parallel(v, M, 1);
+    });
+    medir<CompressedBTree<std::string>, std::string>("CompressedBTree<string>", urls, consultas,
+                                                     [](const std::vector<std::string>& v) {
+        return new CompressedBTree<std::string>(v);
+    });
+    medir<BTree<long>, long>("BTree<long>", ids, consultas, [](const std::vector<long>& v) {
+        return BTree<long>::build_from_ordered_vector_parallel(v, M, 1);
+    });
+    medir<CompressedBTree<long>, long>("CompressedBTree<long>", ids, consultas, [](const std::vector<long>& v) {
+        return new CompressedBTree<long>(v);
+    });
+    return 0;
+}
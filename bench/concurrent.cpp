@@ -0,0 +1,69 @@
+// Throughput con varios hilos: ConcurrentBTree (optimistic lock coupling) contra BTree con un
+// mutex global, barriendo la proporcion de lecturas y la cantidad de hilos.
+// uso: concurrent [n_claves] [M] [ops_por_hilo] [max_hilos]
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include "../btree.h"
+#include "../concurrentbtree.h"
+#include "bench.h"
+
+template <typename Operar>
+double medir(unsigned hilos, size_t ops, const Operar& operar) {
+    std::vector<std::thread> trabajadores;
+    bench::Cronometro cronometro;
+    for (unsigned h = 0; h < hilos; ++h)
+        trabajadores.emplace_back([&, h] { operar(h, ops); });
+    for (std::thread& trabajador : trabajadores)
+        trabajador.join();
+    return hilos * ops / cronometro.segundos();
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 32));
+    size_t ops = bench::argumento(argc, argv, 3, 1 << 19);
+    unsigned maxHilos = static_cast<unsigned>(
+            bench::argumento(argc, argv, 4, std::max(8u, std::thread::hardware_concurrency())));
+    const int rango = static_cast<int>(2 * n);
+
+    std::printf("M = %d, n = %zu, nucleos = %u\n", M, n, std::thread::hardware_concurrency());
+    std::printf("%8s %6s %18s %18s %8s\n", "lecturas", "hilos", "mutex ops/s", "olc ops/s", "mejora");
+    for (int lecturas : {100, 95, 50, 0}) {
+        for (unsigned hilos = 1; hilos <= maxHilos; hilos *= 2) {
+            // la mitad de las escrituras inserta y la otra mitad elimina: el tamaño se mantiene
+            auto carga = [&](auto& arbol, auto&& bloquear) {
+                return [&, bloquear](unsigned h, size_t cantidad) {
+                    std::mt19937 rng(h + 1);
+                    long suma = 0;
+                    for (size_t i = 0; i < cantidad; ++i) {
+                        int key = static_cast<int>(rng() % rango);
+                        int tipo = static_cast<int>(rng() % 100);
+                        [[maybe_unused]] auto guard = bloquear();
+                        if (tipo < lecturas)
+                            suma += arbol.search(key);
+                        else if (tipo % 2 == 0)
+                            arbol.insert(key);
+                        else
+                            arbol.remove(key);
+                    }
+                    bench::noOptimizar(suma);
+                };
+            };
+
+            BTree<int> conMutex(M);
+            std::mutex mutexGlobal;
+            ConcurrentBTree<int> olc(M);
+            for (int key : bench::enterosAleatorios(n, rango, 9)) {
+                conMutex.insert(key);
+                olc.insert(key);
+            }
+
+            double mutex = medir(hilos, ops, carga(conMutex, [&] { return std::unique_lock<std::mutex>(mutexGlobal); }));
+            double optimista = medir(hilos, ops, carga(olc, [] { return 0; }));
+            std::printf("%7d%% %6u %18.0f %18.0f %7.2fx\n", lecturas, hilos, mutex, optimista, optimista / mutex);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Contadores internos y stats(): inserta, busca y elimina keys aleatorias (dos pasadas y una
+// pasada) y reporta ns por operacion y, si se compilo con -DBTREE_CONTADORES, los contadores
+// por operacion de cada fase. Al final el histograma de llenado por nivel de stats().
+// Compilar con y sin -DBTREE_CONTADORES para ver el costo de los contadores.
+// uso: counters [n_claves] [M]
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+static void imprimir(const char* fase, double segundos, const ContadoresBTree& c, size_t ops) {
+    std::printf("%-22s %8.1f", fase, segundos * 1e9 / ops);
+#ifdef BTREE_CONTADORES
+    auto por = [&](std::uint64_t x) { return double(x) / ops; };
+    std::printf(" %8.2f %8.2f %8.2f %8.4f %8.4f %8.4f %8.4f %8.4f %8.4f", por(c.descensos), por(c.nodosVisitados),
+                por(c.comparaciones), por(c.splits), por(c.merges), por(c.rotacionesIzquierda),
+                por(c.rotacionesDerecha), por(c.nodosReservados), por(c.nodosLiberados));
+#else
+    (void)c;
+#endif
+    std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 16));
+    std::vector<int> claves = bench::enterosAleatorios(n, 1 << 30, 9);
+
+#ifdef BTREE_CONTADORES
+    std::printf("M = %d, n = %zu, con contadores (valores por operacion)\n", M, n);
+    std::printf("%-22s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "", "ns/op", "bajadas", "nodos", "comps",
+                "splits", "merges", "rot izq", "rot der", "reserv", "liber");
+#else
+    std::printf("M = %d, n = %zu, sin contadores (compilar con -DBTREE_CONTADORES para verlos)\n", M, n);
+    std::printf("%-22s %8s\n", "", "ns/op");
+#endif
+    for (bool unaPasada : {false, true}) {
+        if (unaPasada && M % 2 != 0)
+            break;
+        BTree<int> btree(M);
+        btree.set_single_pass(unaPasada);
+
+        bench::Cronometro cronometro;
+        for (int key : claves)
+            btree.insert(key);
+        imprimir(unaPasada ? "insert una pasada" : "insert dos pasadas", cronometro.segundos(), btree.counters(), n);
+
+        if (!unaPasada) {
+            btree.reset_counters();
+            cronometro.reiniciar();
+            size_t encontradas = 0;
+            for (int key : claves)
+                encontradas += btree.search(key);
+            bench::noOptimizar(encontradas);
+            imprimir("search", cronometro.segundos(), btree.counters(), n);
+
+            EstadisticasBTree e = btree.stats();
+            std::printf("  altura %d, %zu nodos, %.2f bytes/key en nodos, %.2f reservados\n", e.altura, e.nodos,
+                        double(e.bytesNodos) / e.keys, double(e.bytesReservados) / e.keys);
+            std::printf("  %-6s %9s %7s  llenado (decimos de M - 1)\n", "nivel", "nodos", "keys/n");
+            for (size_t i = 0; i < e.niveles.size(); ++i) {
+                const EstadisticasBTree::Nivel& nivel = e.niveles[i];
+                std::printf("  %-6zu %9zu %7.2f ", i, nivel.nodos, double(nivel.keys) / nivel.nodos);
+                for (std::size_t cantidad : nivel.llenado)
+                    std::printf(" %7zu", cantidad);
+                std::printf("\n");
+            }
+        }
+
+        btree.reset_counters();
+        cronometro.reiniciar();
+        for (int key : claves)
+            btree.remove(key);
+        imprimir(unaPasada ? "remove una pasada" : "remove dos pasadas", cronometro.segundos(), btree.counters(), n);
+    }
+    return 0;
+}
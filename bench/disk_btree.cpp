@@ -0,0 +1,95 @@
+// DiskBTree con paginas de 4 KiB y 16 KiB y distintos tamaños de buffer pool: por operacion
+// (insert, search y rangeSearch aleatorios) reporta page faults del pool (paginas leidas del
+// archivo), escrituras de paginas y los page faults del proceso (getrusage).
+// uso: disk_btree [n_claves] [ruta del archivo]
+#include <cstdio>
+#include <string>
+
+#include <sys/resource.h>
+
+#include "../diskbtree.h"
+#include "bench.h"
+
+struct Medicion {
+    EstadisticasDisco disco;
+    long faultsMenores;
+    long faultsMayores;
+    double segundos;
+};
+
+static void faultsProceso(long& menores, long& mayores) {
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    menores = uso.ru_minflt;
+    mayores = uso.ru_majflt;
+}
+
+template <typename F>
+static Medicion medir(DiskBTree<int>& btree, F operaciones) {
+    long menores, mayores;
+    btree.reset_stats();
+    faultsProceso(menores, mayores);
+    bench::Cronometro cronometro;
+    operaciones();
+    Medicion m{btree.stats(), 0, 0, cronometro.segundos()};
+    faultsProceso(m.faultsMenores, m.faultsMayores);
+    m.faultsMenores -= menores;
+    m.faultsMayores -= mayores;
+    return m;
+}
+
+static void imprimir(const char* operacion, const Medicion& m, size_t ops) {
+    std::printf("  %-12s %10.0f %12.3f %12.3f %12.3f %12.4f %12.4f\n", operacion, ops / m.segundos,
+                double(m.disco.fallos) / ops, double(m.disco.escrituras) / ops,
+                double(m.disco.aciertos + m.disco.fallos) / ops, double(m.faultsMenores) / ops,
+                double(m.faultsMayores) / ops);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    std::string ruta = argc > 2 ? argv[2] : "/tmp/disk_btree.db";
+    const int rango = static_cast<int>(2 * n);
+    const size_t consultas = n / 4;
+
+    std::vector<int> claves = bench::enterosAleatorios(n, rango, 1);
+    std::vector<int> buscadas = bench::enterosAleatorios(consultas, rango, 2);
+
+    std::printf("n = %zu, archivo %s\n", n, ruta.c_str());
+    for (size_t bytesPagina : {4096, 16384}) {
+        for (size_t paginasEnCache : {16, 256, 4096}) {
+            std::remove(ruta.c_str());
+            DiskBTree<int> btree(ruta, bytesPagina, paginasEnCache);
+            std::printf("pagina %zu B (M = %d), cache %zu paginas (%.1f MiB)\n", bytesPagina, btree.order(),
+                        paginasEnCache, paginasEnCache * bytesPagina / 1048576.0);
+            std::printf("  %-12s %10s %12s %12s %12s %12s %12s\n", "operacion", "ops/s", "lect/op", "escr/op",
+                        "accesos/op", "minflt/op", "majflt/op");
+
+            Medicion m = medir(btree, [&] {
+                for (int key : claves)
+                    btree.insert(key);
+                btree.flush();
+            });
+            imprimir("insert", m, n);
+
+            m = medir(btree, [&] {
+                size_t encontradas = 0;
+                for (int key : buscadas)
+                    encontradas += btree.search(key);
+                bench::noOptimizar(encontradas);
+            });
+            imprimir("search", m, consultas);
+
+            const size_t rangos = consultas / 64;
+            m = medir(btree, [&] {
+                size_t total = 0;
+                for (size_t i = 0; i < rangos; ++i)
+                    total += btree.rangeSearch(buscadas[i], buscadas[i] + 200).size();
+                bench::noOptimizar(total);
+            });
+            imprimir("rangeSearch", m, rangos);
+            std::printf("  altura %d, %u paginas en el archivo\n", btree.height(), btree.pages());
+        }
+    }
+    std::remove(ruta.c_str());
+    return 0;
+}
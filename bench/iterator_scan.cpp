@@ -0,0 +1,67 @@
+// Recorridos con iteradores: escaneo completo con begin()/end() contra rangeSearch, y
+// consultas "primeras k keys desde x" con el cursor perezoso contra rangeSearch (que
+// materializa todo el rango aunque solo se usen k keys).
+// uso: iterator_scan [n_claves] [M]
+#include <cstdio>
+
+#include "../btree.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 22);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+
+    std::vector<int> claves(n);
+    for (size_t i = 0; i < n; ++i)
+        claves[i] = static_cast<int>(2 * i);
+    BTree<int>* btree = BTree<int>::build_from_ordered_vector(claves, M);
+    std::printf("M = %d, n = %zu\n", M, n);
+
+    // escaneo completo
+    long suma = 0;
+    size_t reservas = bench::reservas;
+    bench::Cronometro cronometro;
+    for (int key : *btree)
+        suma += key;
+    double iterador = n / cronometro.segundos();
+    size_t reservasIterador = bench::reservas - reservas;
+
+    reservas = bench::reservas;
+    cronometro.reiniciar();
+    for (int key : btree->rangeSearch(claves.front(), claves.back()))
+        suma += key;
+    double vector = n / cronometro.segundos();
+    size_t reservasVector = bench::reservas - reservas;
+    std::printf("escaneo completo: iterador %.0f keys/s (%zu reservas), rangeSearch %.0f keys/s (%zu reservas)\n",
+                iterador, reservasIterador, vector, reservasVector);
+
+    // primeras k keys de un rango largo
+    std::printf("%8s %20s %20s\n", "k", "cursor consultas/s", "rangeSearch cons/s");
+    const size_t largo = 100000;
+    for (size_t k : {1ul, 10ul, 100ul}) {
+        size_t consultas = 2000;
+        std::vector<int> inicios = bench::enterosAleatorios(consultas, static_cast<int>(2 * (n - largo)), 5);
+
+        cronometro.reiniciar();
+        for (int inicio : inicios) {
+            size_t vistos = 0;
+            for (auto c = btree->cursor(inicio, inicio + static_cast<int>(2 * largo)); c.valid() && vistos < k; c.next(), ++vistos)
+                suma += c.key();
+        }
+        double conCursor = consultas / cronometro.segundos();
+
+        cronometro.reiniciar();
+        for (int inicio : inicios) {
+            std::vector<int> rango = btree->rangeSearch(inicio, inicio + static_cast<int>(2 * largo));
+            for (size_t i = 0; i < k && i < rango.size(); ++i)
+                suma += rango[i];
+        }
+        double conVector = consultas / cronometro.segundos();
+        std::printf("%8zu %20.0f %20.0f\n", k, conCursor, conVector);
+    }
+    bench::noOptimizar(suma);
+
+    delete btree;
+    return 0;
+}
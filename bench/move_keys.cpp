@@ -0,0 +1,107 @@
+// Keys pesadas (strings de 48 caracteres, fuera del buffer corto de std::string): insert con
+// la key copiada, movida y construida en el arbol (emplace), y remove. Por operacion reporta
+// ns, copias y movimientos de keys y reservas de memoria (las de los nodos incluidas).
+// uso: move_keys [n_claves] [M]
+#include <cstdio>
+#include <string>
+
+#include "../btree.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+// string que cuenta sus copias y movimientos
+struct Clave {
+    static inline size_t copias = 0;
+    static inline size_t movimientos = 0;
+    std::string texto;
+
+    Clave() = default;
+    explicit Clave(std::string t) : texto(std::move(t)) {}
+    Clave(const char* inicio, size_t largo) : texto(inicio, largo) {}
+    Clave(const Clave& otra) : texto(otra.texto) { ++copias; }
+    Clave(Clave&& otra) noexcept : texto(std::move(otra.texto)) { ++movimientos; }
+    Clave& operator=(const Clave& otra) {
+        texto = otra.texto;
+        ++copias;
+        return *this;
+    }
+    Clave& operator=(Clave&& otra) noexcept {
+        texto = std::move(otra.texto);
+        ++movimientos;
+        return *this;
+    }
+
+    bool operator<(const Clave& otra) const { return texto < otra.texto; }
+    bool operator>(const Clave& otra) const { return otra < *this; }
+    bool operator<=(const Clave& otra) const { return !(otra < *this); }
+    bool operator>=(const Clave& otra) const { return !(*this < otra); }
+    bool operator==(const Clave& otra) const { return texto == otra.texto; }
+    bool operator!=(const Clave& otra) const { return texto != otra.texto; }
+};
+
+std::ostream& operator<<(std::ostream& os, const Clave& c) {
+    return os << c.texto;
+}
+
+static std::string texto(int x) {
+    return bench::claveString(x) + std::string(36, 'k');
+}
+
+template <typename F>
+static void medir(const char* nombre, size_t ops, F operacion) {
+    Clave::copias = Clave::movimientos = 0;
+    size_t reservas = bench::reservas;
+    bench::Cronometro cronometro;
+    operacion();
+    double segundos = cronometro.segundos();
+    std::printf("%-22s %10.1f %10.2f %10.2f %10.2f\n", nombre, segundos * 1e9 / ops, double(Clave::copias) / ops,
+                double(Clave::movimientos) / ops, double(bench::reservas - reservas) / ops);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 19);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 32));
+    std::vector<int> numeros = bench::enterosAleatorios(n, 1 << 30, 5);
+    std::vector<std::string> textos;
+    textos.reserve(n);
+    for (int x : numeros)
+        textos.push_back(texto(x));
+
+    std::printf("M = %d, n = %zu, keys de %zu bytes\n", M, n, textos[0].size());
+    std::printf("%-22s %10s %10s %10s %10s\n", "", "ns/op", "copias", "movs", "reservas");
+    for (bool unaPasada : {false, true}) {
+        if (unaPasada && M % 2 != 0)
+            break;
+        std::printf("%s\n", unaPasada ? "una pasada" : "dos pasadas");
+        {
+            std::vector<Clave> claves(textos.begin(), textos.end());
+            BTree<Clave> btree(M);
+            btree.set_single_pass(unaPasada);
+            medir("insert(const TK&)", n, [&] {
+                for (const Clave& key : claves)
+                    btree.insert(key);
+            });
+        }
+        {
+            std::vector<Clave> claves(textos.begin(), textos.end());
+            BTree<Clave> btree(M);
+            btree.set_single_pass(unaPasada);
+            medir("insert(TK&&)", n, [&] {
+                for (Clave& key : claves)
+                    btree.insert(std::move(key));
+            });
+        }
+        BTree<Clave> btree(M);
+        btree.set_single_pass(unaPasada);
+        medir("emplace", n, [&] {
+            for (const std::string& t : textos)
+                btree.emplace(t.data(), t.size());
+        });
+        std::vector<Clave> claves(textos.begin(), textos.end());
+        medir("remove", n, [&] {
+            for (const Clave& key : claves)
+                btree.remove(key);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Fallos de cache por busqueda y bytes por key de la representacion de nodos.
+// Solo usa la API publica de BTree, asi que el mismo archivo compila contra versiones
+// anteriores de node.h para comparar el antes y el despues.
+// uso: node_layout [n_claves] [n_busquedas]
+#include <cstdio>
+
+#include "../btree.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 21);
+    size_t q = bench::argumento(argc, argv, 2, 1 << 21);
+
+    std::vector<int> claves = bench::enterosAleatorios(n, 1 << 30, 1);
+    std::vector<int> consultas = bench::enterosAleatorios(q, 1 << 30, 2);
+    for (size_t i = 0; i < q; i += 2) // la mitad de las consultas existen
+        consultas[i] = claves[(i * 7919) % n];
+
+    bench::ContadorHardware fallos;
+    if (!fallos.disponible())
+        std::printf("(perf_event_open no disponible: fallos de cache = 0)\n");
+
+    std::printf("%5s %12s %12s %14s %14s\n", "M", "bytes/key", "reservas", "fallos/busq", "busq/s");
+    for (int M : {3, 4, 8, 16, 32, 64, 128, 256}) {
+        size_t reservasAntes = bench::reservas;
+        size_t bytesAntes = bench::bytesVivos;
+        BTree<int> btree(M);
+        for (int key : claves)
+            btree.insert(key);
+        double bytesPorKey = static_cast<double>(bench::bytesVivos - bytesAntes) / btree.size();
+        size_t reservas = bench::reservas - reservasAntes;
+
+        size_t encontrados = 0;
+        bench::Cronometro cronometro;
+        fallos.iniciar();
+        for (int key : consultas)
+            encontrados += btree.search(key);
+        uint64_t totalFallos = fallos.leer();
+        double segundos = cronometro.segundos();
+        bench::noOptimizar(encontrados);
+
+        std::printf("%5d %12.2f %12zu %14.2f %14.0f\n", M, bytesPorKey, reservas,
+                    static_cast<double>(totalFallos) / q, q / segundos);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Insert/remove alternados sobre un arbol de tamaño estable y costo de clear().
+// Reporta operaciones por segundo y reservas del heap por operacion con el recurso por
+// defecto y con un std::pmr::unsynchronized_pool_resource.
+// uso: node_pool [n_claves] [n_operaciones]
+#include <cstdio>
+
+#include "../btree.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+void medir(const char* nombre, int M, std::pmr::memory_resource* recurso,
+           const std::vector<int>& claves, const std::vector<int>& nuevas) {
+    BTree<int> btree(M, recurso);
+    for (int key : claves)
+        btree.insert(key);
+
+    size_t reservasAntes = bench::reservas;
+    bench::Cronometro cronometro;
+    for (size_t i = 0; i < nuevas.size(); ++i) {
+        btree.insert(nuevas[i]);
+        btree.remove(claves[i % claves.size()]);
+        btree.insert(claves[i % claves.size()]);
+        btree.remove(nuevas[i]);
+    }
+    double segundos = cronometro.segundos();
+    double operaciones = 4.0 * nuevas.size();
+    double reservasPorOp = (bench::reservas - reservasAntes) / operaciones;
+
+    cronometro.reiniciar();
+    btree.clear();
+    double segundosClear = cronometro.segundos();
+
+    std::printf("%4d %-10s %14.0f %14.4f %12.3f\n", M, nombre, operaciones / segundos, reservasPorOp,
+                segundosClear * 1e3);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    size_t q = bench::argumento(argc, argv, 2, 1 << 19);
+    std::vector<int> claves = bench::enterosAleatorios(n, 1 << 30, 1);
+    std::vector<int> nuevas = bench::enterosAleatorios(q, 1 << 30, 2);
+
+    std::printf("%4s %-10s %14s %14s %12s\n", "M", "recurso", "ops/s", "reservas/op", "clear ms");
+    for (int M : {4, 16, 64}) {
+        medir("default", M, std::pmr::get_default_resource(), claves, nuevas);
+        std::pmr::unsynchronized_pool_resource pool;
+        medir("pmr-pool", M, &pool, claves, nuevas);
+    }
+    return 0;
+}
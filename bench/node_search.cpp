@@ -0,0 +1,45 @@
+// Busquedas por segundo de BTree::search segun el orden M.
+// uso: node_search [n_claves] [n_busquedas]
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+template <typename TK>
+double busquedasPorSegundo(std::vector<TK>& ordenados, const std::vector<TK>& consultas, int M, size_t& encontrados) {
+    BTree<TK>* btree = BTree<TK>::build_from_ordered_vector(ordenados, M);
+    bench::Cronometro cronometro;
+    encontrados = 0;
+    for (const TK& key : consultas)
+        encontrados += btree->search(key);
+    double segundos = cronometro.segundos();
+    delete btree;
+    return consultas.size() / segundos;
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    size_t q = bench::argumento(argc, argv, 2, 1 << 21);
+
+    // claves pares, la mitad de las consultas no existen
+    std::vector<int> enteros(n);
+    for (size_t i = 0; i < n; ++i)
+        enteros[i] = static_cast<int>(2 * i);
+    std::vector<int> consultas = bench::enterosAleatorios(q, static_cast<int>(2 * n));
+
+    std::vector<std::string> strings(n);
+    for (size_t i = 0; i < n; ++i)
+        strings[i] = bench::claveString(enteros[i]);
+    std::vector<std::string> consultasString(q / 4);
+    for (size_t i = 0; i < consultasString.size(); ++i)
+        consultasString[i] = bench::claveString(consultas[i]);
+
+    std::printf("%5s %16s %16s\n", "M", "int busq/s", "string busq/s");
+    for (int M : {3, 4, 5, 8, 16, 32, 64, 128, 256}) {
+        size_t encontradosInt = 0, encontradosString = 0;
+        double porSegundoInt = busquedasPorSegundo(enteros, consultas, M, encontradosInt);
+        double porSegundoString = busquedasPorSegundo(strings, consultasString, M, encontradosString);
+        std::printf("%5d %16.0f %16.0f\n", M, porSegundoInt, porSegundoString);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Conteos por subarbol (CONTEO = true): costo de mantenerlos en insert/remove (dos pasadas y una
+// pasada) contra BTree<int> sin conteos, y consultas count_range / select contra contar con
+// rangeSearch().size() y recorrer con el iterador.
+// uso: order_statistics [n_claves] [M]
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+template <typename Arbol>
+static void mutaciones(const char* nombre, const std::vector<int>& claves, int M, bool unaPasada) {
+    Arbol btree(M);
+    btree.set_single_pass(unaPasada);
+    bench::Cronometro cronometro;
+    for (int key : claves)
+        btree.insert(key);
+    double nsInsert = cronometro.segundos() * 1e9 / claves.size();
+    bool valido = btree.check_properties();
+
+    cronometro.reiniciar();
+    for (int key : claves)
+        btree.remove(key);
+    double nsRemove = cronometro.segundos() * 1e9 / claves.size();
+    std::printf("%-34s %12.1f %12.1f\n", nombre, nsInsert, nsRemove);
+    if (!valido || !btree.empty())
+        std::printf("  ERROR: el arbol no cumple las propiedades\n");
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 16));
+    const int rango = 1 << 30;
+    std::vector<int> claves = bench::enterosAleatorios(n, rango, 5);
+
+    std::printf("M = %d, n = %zu\n", M, n);
+    std::printf("%-34s %12s %12s\n", "", "ns/insert", "ns/remove");
+    mutaciones<BTree<int>>("sin conteos, dos pasadas", claves, M, false);
+    mutaciones<BTree<int, 0, void, true>>("con conteos, dos pasadas", claves, M, false);
+    if (M % 2 == 0) {
+        mutaciones<BTree<int>>("sin conteos, una pasada", claves, M, true);
+        mutaciones<BTree<int, 0, void, true>>("con conteos, una pasada", claves, M, true);
+    }
+
+    BTree<int, 0, void, true> btree(M);
+    for (int key : claves)
+        btree.insert(key);
+    const int total = btree.size();
+    std::vector<int> inicios = bench::enterosAleatorios(1000, rango, 6);
+    std::vector<int> posiciones = bench::enterosAleatorios(1000, total, 7);
+
+    long calentamiento = 0; // la primera medicion no paga los fallos de cache del arbol recien armado
+    for (int a : inicios)
+        calentamiento += btree.count_range(a, a + 1000);
+    bench::noOptimizar(calentamiento);
+
+    std::printf("\n%-34s %12s %12s\n", "consulta", "ns/consulta", "keys/consulta");
+    for (int ancho : {1000, 100000, 10000000}) {
+        double keysPorRango = double(ancho) * total / rango;
+        bench::Cronometro cronometro;
+        long suma = 0;
+        for (int a : inicios)
+            suma += btree.count_range(a, a + ancho);
+        double nsConteo = cronometro.segundos() * 1e9 / inicios.size();
+
+        cronometro.reiniciar();
+        long sumaRango = 0;
+        for (int a : inicios)
+            sumaRango += btree.rangeSearch(a, a + ancho).size();
+        double nsRango = cronometro.segundos() * 1e9 / inicios.size();
+        bench::noOptimizar(suma + sumaRango);
+
+        char nombre[64];
+        std::snprintf(nombre, sizeof(nombre), "count_range (ancho %d)", ancho);
+        std::printf("%-34s %12.1f %12.0f\n", nombre, nsConteo, keysPorRango);
+        std::snprintf(nombre, sizeof(nombre), "rangeSearch().size() (ancho %d)", ancho);
+        std::printf("%-34s %12.1f %12.0f\n", nombre, nsRango, keysPorRango);
+        if (suma != sumaRango)
+            std::printf("  ERROR: count_range no coincide con rangeSearch\n");
+    }
+
+    bench::Cronometro cronometro;
+    long suma = 0;
+    for (int k : posiciones)
+        suma += btree.select(k);
+    std::printf("%-34s %12.1f\n", "select(k)", cronometro.segundos() * 1e9 / posiciones.size());
+
+    // sin conteos, la k-esima key se obtiene avanzando el iterador k veces
+    const size_t pocas = 20;
+    cronometro.reiniciar();
+    long sumaIterador = 0;
+    for (size_t i = 0; i < pocas; ++i) {
+        auto it = btree.begin();
+        for (int k = 0; k < posiciones[i]; ++k)
+            ++it;
+        sumaIterador += *it;
+    }
+    std::printf("%-34s %12.1f\n", "begin() + k pasos", cronometro.segundos() * 1e9 / pocas);
+
+    cronometro.reiniciar();
+    for (int i = 0; i < 1000; ++i)
+        suma += btree.percentile(i / 1000.0);
+    std::printf("%-34s %12.1f\n", "percentile(p)", cronometro.segundos() * 1e9 / 1000);
+    bench::noOptimizar(suma + sumaIterador);
+    return 0;
+}
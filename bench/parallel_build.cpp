@@ -0,0 +1,39 @@
+// Escalamiento de build_from_ordered_vector_parallel con la cantidad de hilos, contra el
+// build_from_ordered_vector de un solo hilo.
+// uso: parallel_build [n_claves] [M] [max_hilos] [llenado en %]
+#include <cstdio>
+#include <thread>
+
+#include "../btree.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 24);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+    unsigned maxHilos = static_cast<unsigned>(
+            bench::argumento(argc, argv, 3, std::max(4u, std::thread::hardware_concurrency())));
+    double llenado = bench::argumento(argc, argv, 4, 100) / 100.0;
+
+    std::vector<int> claves(n);
+    for (size_t i = 0; i < n; ++i)
+        claves[i] = static_cast<int>(i);
+    std::printf("M = %d, n = %zu, llenado = %.2f, nucleos = %u\n", M, n, llenado, std::thread::hardware_concurrency());
+
+    bench::Cronometro cronometro;
+    BTree<int>* btree = BTree<int>::build_from_ordered_vector(claves, M);
+    double serial = n / cronometro.segundos();
+    delete btree;
+    std::printf("%-10s %14.0f keys/s\n", "serial", serial);
+
+    double base = 0;
+    for (unsigned hilos = 1; hilos <= maxHilos; hilos *= 2) {
+        cronometro.reiniciar();
+        btree = BTree<int>::build_from_ordered_vector_parallel(claves, M, hilos, llenado);
+        double paralelo = n / cronometro.segundos();
+        delete btree;
+        if (hilos == 1)
+            base = paralelo;
+        std::printf("%2u hilos   %14.0f keys/s  %5.2fx\n", hilos, paralelo, paralelo / base);
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+// Reservas del heap por insert/remove y operaciones por segundo.
+// Con el camino en PilaFija y los nodos en el pool, las reservas por operacion deben ser
+// ~0 (solo quedan los slabs nuevos que pide el pool cuando el arbol crece).
+// uso: path_stack [n_claves]
+#include <cstdio>
+
+#include "../btree.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    std::vector<int> claves = bench::enterosAleatorios(n, 1 << 30, 1);
+
+    std::printf("%4s %14s %14s %14s %14s\n", "M", "insert/s", "reservas/ins", "remove/s", "reservas/rem");
+    for (int M : {3, 8, 32, 128}) {
+        BTree<int> btree(M);
+
+        size_t reservasAntes = bench::reservas;
+        bench::Cronometro cronometro;
+        for (int key : claves)
+            btree.insert(key);
+        double insertPorSegundo = n / cronometro.segundos();
+        double reservasInsert = static_cast<double>(bench::reservas - reservasAntes) / n;
+
+        reservasAntes = bench::reservas;
+        cronometro.reiniciar();
+        for (int key : claves)
+            btree.remove(key);
+        double removePorSegundo = n / cronometro.segundos();
+        double reservasRemove = static_cast<double>(bench::reservas - reservasAntes) / n;
+
+        std::printf("%4d %14.0f %14.4f %14.0f %14.4f\n", M, insertPorSegundo, reservasInsert,
+                    removePorSegundo, reservasRemove);
+    }
+    return 0;
+}
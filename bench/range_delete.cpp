@@ -0,0 +1,81 @@
+// Borrado de rangos: rangeSearch y un remove por key contra remove_range (suelta los subarboles
+// del medio enteros y une los dos bordes), con rangos de distintos largos. Y borrados dispersos
+// de un lote ordenado: un remove por key contra remove_sorted_batch.
+// uso: range_delete [n_claves] [M]
+#include <algorithm>
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 22);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+
+    std::vector<int> claves(n);
+    for (size_t i = 0; i < n; ++i)
+        claves[i] = static_cast<int>(i);
+
+    std::printf("M = %d, n = %zu\n", M, n);
+    std::printf("%-22s %10s %14s %14s %14s %8s\n", "", "keys", "loop ms", "batch ms", "batch ns/key", "mejora");
+    // mismo total de keys borradas con cada largo: muchos rangos cortos o pocos largos
+    for (size_t largo : {size_t{16}, size_t{1000}, size_t{100000}, n / 2}) {
+        const size_t rangos = std::max<size_t>(1, (n / 4) / largo);
+        std::vector<int> inicios = bench::enterosAleatorios(rangos, static_cast<int>(n - largo), 5);
+
+        BTree<int>* btree = BTree<int>::build_from_ordered_vector_parallel(claves, M, 1, 0.7);
+        size_t borradas = 0;
+        bench::Cronometro cronometro;
+        for (int inicio : inicios) {
+            for (int key : btree->rangeSearch(inicio, inicio + static_cast<int>(largo) - 1)) {
+                btree->remove(key);
+                ++borradas;
+            }
+        }
+        double loop = cronometro.segundos();
+        delete btree;
+
+        btree = BTree<int>::build_from_ordered_vector_parallel(claves, M, 1, 0.7);
+        size_t borradasBatch = 0;
+        cronometro.reiniciar();
+        for (int inicio : inicios)
+            borradasBatch += btree->remove_range(inicio, inicio + static_cast<int>(largo) - 1);
+        double batch = cronometro.segundos();
+        if (borradas != borradasBatch || !btree->check_properties())
+            std::printf("remove_range no coincide con el loop\n");
+        delete btree;
+
+        char nombre[40];
+        std::snprintf(nombre, sizeof(nombre), "remove_range %zu", largo);
+        std::printf("%-22s %10zu %14.2f %14.2f %14.2f %7.1fx\n", nombre, borradas, loop * 1e3, batch * 1e3,
+                    batch * 1e9 / std::max<size_t>(borradas, 1), loop / batch);
+    }
+
+    // borrados dispersos: de 1 en 1000 keys a 1 en 4
+    for (size_t paso : {size_t{1000}, size_t{32}, size_t{4}}) {
+        std::vector<int> lote = bench::enterosAleatorios(n / paso, static_cast<int>(n), 6);
+        std::sort(lote.begin(), lote.end());
+
+        BTree<int>* btree = BTree<int>::build_from_ordered_vector_parallel(claves, M, 1, 0.7);
+        bench::Cronometro cronometro;
+        for (int key : lote)
+            btree->remove(key);
+        double loop = cronometro.segundos();
+        size_t quedan = btree->size();
+        delete btree;
+
+        btree = BTree<int>::build_from_ordered_vector_parallel(claves, M, 1, 0.7);
+        cronometro.reiniciar();
+        btree->remove_sorted_batch(lote.begin(), lote.end());
+        double batch = cronometro.segundos();
+        if (quedan != static_cast<size_t>(btree->size()) || !btree->check_properties())
+            std::printf("remove_sorted_batch no coincide con el loop\n");
+        delete btree;
+
+        char nombre[40];
+        std::snprintf(nombre, sizeof(nombre), "sorted_batch 1/%zu", paso);
+        std::printf("%-22s %10zu %14.2f %14.2f %14.2f %7.1fx\n", nombre, lote.size(), loop * 1e3, batch * 1e3,
+                    batch * 1e9 / lote.size(), loop / batch);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+// Throughput de rangos largos: BTree::rangeSearch (recursivo) contra BPlusTree::rangeSearch
+// (vector) y BPlusTree::rangeScan (recorrido de hojas sin copiar el rango).
+// uso: range_scan [n_claves] [M]
+#include <cstdio>
+
+#include "../bplustree.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 22);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+
+    std::vector<int> claves(n);
+    for (size_t i = 0; i < n; ++i)
+        claves[i] = static_cast<int>(2 * i);
+    BTree<int>* btree = BTree<int>::build_from_ordered_vector(claves, M);
+    BPlusTree<int>* bplus = BPlusTree<int>::build_from_ordered_vector(claves, M);
+
+    std::printf("M = %d, n = %zu\n", M, n);
+    std::printf("%10s %18s %18s %18s\n", "largo", "btree keys/s", "b+ vector keys/s", "b+ scan keys/s");
+    for (size_t largo : {10ul, 1000ul, 100000ul, n / 2}) {
+        size_t rangos = std::max<size_t>(1, (size_t{1} << 24) / largo);
+        std::vector<int> inicios = bench::enterosAleatorios(rangos, static_cast<int>(2 * (n - largo)), 3);
+
+        size_t total = 0;
+        bench::Cronometro cronometro;
+        for (int inicio : inicios)
+            total += btree->rangeSearch(inicio, inicio + static_cast<int>(2 * largo)).size();
+        double btreeKeys = total / cronometro.segundos();
+
+        total = 0;
+        cronometro.reiniciar();
+        for (int inicio : inicios)
+            total += bplus->rangeSearch(inicio, inicio + static_cast<int>(2 * largo)).size();
+        double bplusVector = total / cronometro.segundos();
+
+        total = 0;
+        long suma = 0;
+        cronometro.reiniciar();
+        for (int inicio : inicios)
+            bplus->rangeScan(inicio, inicio + static_cast<int>(2 * largo), [&](int key) { suma += key; ++total; });
+        double bplusScan = total / cronometro.segundos();
+        bench::noOptimizar(suma);
+
+        std::printf("%10zu %18.0f %18.0f %18.0f\n", largo, btreeKeys, bplusVector, bplusScan);
+    }
+
+    delete btree;
+    delete bplus;
+    return 0;
+}
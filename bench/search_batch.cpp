@@ -0,0 +1,83 @@
+// Busquedas en lote sobre un arbol mas grande que la cache: un loop de search contra
+// search_batch (busquedas intercaladas con prefetch del siguiente nivel), y para el lote
+// ordenado un loop de search contra search_sorted_batch (camino compartido).
+// uso: search_batch [n_claves] [M] [tamaño del lote]
+#include <algorithm>
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+template <typename F>
+static void medir(const char* nombre, size_t consultas, F buscar) {
+    bench::Cronometro cronometro;
+    size_t encontradas = buscar();
+    double segundos = cronometro.segundos();
+    std::printf("%-34s %12.1f %14.2f %12zu\n", nombre, segundos * 1e9 / consultas, consultas / segundos / 1e6,
+                encontradas);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 26);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 16));
+    size_t lote = bench::argumento(argc, argv, 3, 4096);
+    const size_t consultas = 1 << 22;
+
+    std::vector<int> claves(n);
+    for (size_t i = 0; i < n; ++i)
+        claves[i] = static_cast<int>(2 * i);
+    BTree<int>* btree = BTree<int>::build_from_ordered_vector_parallel(claves, M, 1);
+    std::vector<int>().swap(claves);
+    // la mitad de las busquedas encuentra la key
+    std::vector<int> buscadas = bench::enterosAleatorios(consultas, static_cast<int>(2 * n), 8);
+
+    std::printf("n = %zu, M = %d, altura %d, %zu consultas en lotes de %zu\n", n, M, btree->height(),
+                consultas, lote);
+    std::printf("%-34s %12s %14s %12s\n", "", "ns/key", "Mkeys/s", "encontradas");
+    std::vector<bool> resultado;
+    auto contar = [&] { return static_cast<size_t>(std::count(resultado.begin(), resultado.end(), true)); };
+
+    medir("loop de search", consultas, [&] {
+        size_t encontradas = 0;
+        for (int key : buscadas)
+            encontradas += btree->search(key);
+        return encontradas;
+    });
+    medir("search_batch", consultas, [&] {
+        size_t encontradas = 0;
+        for (size_t i = 0; i < consultas; i += lote) {
+            btree->search_batch(buscadas.begin() + i, buscadas.begin() + std::min(i + lote, consultas), resultado);
+            encontradas += contar();
+        }
+        return encontradas;
+    });
+
+    // cada lote ordenado por separado (como llegarian las keys de un join ya ordenado)
+    for (size_t i = 0; i < consultas; i += lote)
+        std::sort(buscadas.begin() + i, buscadas.begin() + std::min(i + lote, consultas));
+    medir("loop de search (lotes ordenados)", consultas, [&] {
+        size_t encontradas = 0;
+        for (int key : buscadas)
+            encontradas += btree->search(key);
+        return encontradas;
+    });
+    medir("search_batch (lotes ordenados)", consultas, [&] {
+        size_t encontradas = 0;
+        for (size_t i = 0; i < consultas; i += lote) {
+            btree->search_batch(buscadas.begin() + i, buscadas.begin() + std::min(i + lote, consultas), resultado);
+            encontradas += contar();
+        }
+        return encontradas;
+    });
+    medir("search_sorted_batch", consultas, [&] {
+        size_t encontradas = 0;
+        for (size_t i = 0; i < consultas; i += lote) {
+            btree->search_sorted_batch(buscadas.begin() + i, buscadas.begin() + std::min(i + lote, consultas),
+                                       resultado);
+            encontradas += contar();
+        }
+        return encontradas;
+    });
+    delete btree;
+    return 0;
+}
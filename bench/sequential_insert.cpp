@@ -0,0 +1,45 @@
+// Inserts en orden ascendente (timestamps, ids de secuencia), descendente y aleatorio, en dos
+// pasadas y una pasada. Los ascendentes entran por el dedo de la ultima hoja sin bajar desde la
+// raiz, y en los ordenados los nodos llenos del borde reparten con su hermano en lugar de partirse
+// por la mediana. Reporta inserts por segundo, bytes por key (en los nodos del arbol y en los
+// slabs reservados) y el llenado promedio de los nodos.
+// uso: sequential_insert [n_claves] [M]
+#include <algorithm>
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 22);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+
+    std::vector<int> ascendentes(n);
+    for (size_t i = 0; i < n; ++i)
+        ascendentes[i] = static_cast<int>(i);
+    std::vector<int> descendentes(ascendentes.rbegin(), ascendentes.rend());
+    std::vector<int> aleatorios = ascendentes;
+    std::shuffle(aleatorios.begin(), aleatorios.end(), std::mt19937(3));
+
+    std::printf("M = %d, n = %zu\n", M, n);
+    std::printf("%-13s %-12s %12s %12s %12s %9s\n", "", "", "Minserts/s", "bytes/key", "reservados", "llenado");
+    for (bool unaPasada : {false, true}) {
+        if (unaPasada && M % 2 != 0)
+            break;
+        const std::pair<const char*, const std::vector<int>*> flujos[] = {
+            {"ascendente", &ascendentes}, {"descendente", &descendentes}, {"aleatorio", &aleatorios}};
+        for (const auto& flujo : flujos) {
+            BTree<int> btree(M);
+            btree.set_single_pass(unaPasada);
+            bench::Cronometro cronometro;
+            for (int key : *flujo.second)
+                btree.insert(key);
+            double segundos = cronometro.segundos();
+            EstadisticasBTree e = btree.stats();
+            std::printf("%-13s %-12s %12.2f %12.2f %12.2f %8.1f%%\n", unaPasada ? "una pasada" : "dos pasadas",
+                        flujo.first, n / segundos / 1e6, double(e.bytesNodos) / e.keys,
+                        double(e.bytesReservados) / e.keys, 100.0 * e.keys / e.nodos / (M - 1));
+        }
+    }
+    return 0;
+}
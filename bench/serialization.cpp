@@ -0,0 +1,65 @@
+// Exportar y volver a cargar n keys enteras: toString + insertar una por una contra
+// save + load binario (escritura de las hojas en bloque y carga masiva de una pasada).
+// uso: serialization [n_claves] [M] [ruta del archivo]
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../btree.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 10000000);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+    std::string ruta = argc > 3 ? argv[3] : "/tmp/serialization.bin";
+
+    std::vector<int> claves(n);
+    for (size_t i = 0; i < n; ++i)
+        claves[i] = static_cast<int>(2 * i);
+    BTree<int>* btree = BTree<int>::build_from_ordered_vector_parallel(claves, M, 1);
+    std::vector<int>().swap(claves); // con 10^8 keys la memoria alcanza justo
+    std::printf("M = %d, n = %zu\n", M, n);
+    std::printf("%-28s %12s %12s\n", "", "segundos", "MiB");
+
+    if (n <= 10000000) { // con 10^8 el texto y los inserts tardan minutos
+        bench::Cronometro cronometro;
+        std::string texto = btree->toString();
+        std::printf("%-28s %12.3f %12.1f\n", "toString", cronometro.segundos(), texto.size() / 1048576.0);
+
+        cronometro.reiniciar();
+        std::istringstream entrada(texto);
+        BTree<int> copia(M);
+        for (int key; entrada >> key;)
+            copia.insert(key);
+        std::printf("%-28s %12.3f\n", "parsear + insert", cronometro.segundos());
+    }
+
+    bench::Cronometro cronometro;
+    {
+        std::ofstream archivo(ruta, std::ios::binary);
+        btree->save(archivo);
+    }
+    std::ifstream::pos_type bytes = std::ifstream(ruta, std::ios::binary | std::ios::ate).tellg();
+    std::printf("%-28s %12.3f %12.1f\n", "save", cronometro.segundos(), bytes / 1048576.0);
+    int guardadas = btree->size();
+    delete btree; // la carga no compite por memoria con el arbol original
+
+    unsigned maxHilos = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned hilos = 1;; hilos = maxHilos) {
+        cronometro.reiniciar();
+        std::ifstream archivo(ruta, std::ios::binary);
+        BTree<int> copia(M);
+        copia.load(archivo, hilos);
+        char nombre[32];
+        std::snprintf(nombre, sizeof(nombre), "load (%u hilos)", hilos);
+        std::printf("%-28s %12.3f\n", nombre, cronometro.segundos());
+        if (copia.size() != guardadas)
+            return 1;
+        if (hilos == maxHilos)
+            break;
+    }
+
+    std::remove(ruta.c_str());
+    return 0;
+}
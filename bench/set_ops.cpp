@@ -0,0 +1,128 @@
+// Partir y unir arboles: split_at y join contra pasar las keys una por una a otro arbol, y
+// set_union / set_intersection / set_difference contra la version ingenua (un insert, search o
+// remove por key) con arboles casi disjuntos (bloques de keys contiguas), intercalados key por key
+// y uno chico contra uno grande.
+// uso: set_ops [n_claves] [M]
+#include <cstdio>
+#include <memory>
+
+#include "../btree.h"
+#include "bench.h"
+
+using Arbol = BTree<int>;
+
+// n keys en bloques de largo keys contiguas: el arbol a toma los bloques pares y b los impares
+static std::unique_ptr<Arbol> bloques(size_t n, size_t largo, int M, int paridad) {
+    std::vector<int> claves;
+    claves.reserve(n);
+    for (size_t i = 0; claves.size() < n; ++i) {
+        if ((i / largo) % 2 == static_cast<size_t>(paridad))
+            claves.push_back(static_cast<int>(i));
+    }
+    return std::unique_ptr<Arbol>(Arbol::build_from_ordered_vector_parallel(claves, M, 1, 0.7));
+}
+
+static void fila(const char* nombre, size_t keys, double ingenuo, double rapido) {
+    std::printf("%-30s %10zu %12.3f %12.3f %9.1fx\n", nombre, keys, ingenuo * 1e3, rapido * 1e3, ingenuo / rapido);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 21);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+
+    std::printf("M = %d, n = %zu\n", M, n);
+    std::printf("%-30s %10s %12s %12s %10s\n", "", "keys", "ingenuo ms", "ms", "mejora");
+
+    { // split_at en la mitad y join de vuelta
+        std::unique_ptr<Arbol> a = bloques(n, n, M, 0);
+        const int mitad = static_cast<int>(n / 2);
+        bench::Cronometro cronometro;
+        Arbol derecho(M);
+        for (int key : a->rangeSearch(mitad, static_cast<int>(n))) {
+            derecho.insert(key);
+            a->remove(key);
+        }
+        double ingenuo = cronometro.segundos();
+        cronometro.reiniciar();
+        for (int key : derecho.rangeSearch(mitad, static_cast<int>(n)))
+            a->insert(key);
+        double ingenuoJoin = cronometro.segundos();
+
+        std::unique_ptr<Arbol> b = bloques(n, n, M, 0);
+        cronometro.reiniciar();
+        std::unique_ptr<Arbol> pedazo(b->split_at(mitad));
+        double split = cronometro.segundos();
+        cronometro.reiniciar();
+        b->join(*pedazo);
+        double join = cronometro.segundos();
+        if (b->size() != static_cast<int>(n) || !b->check_properties())
+            std::printf("split_at/join perdio keys\n");
+        fila("split_at (mitad)", n / 2, ingenuo, split);
+        fila("join", n / 2, ingenuoJoin, join);
+    }
+
+    // pares de arboles: bloques de 2^16 y 64 keys (casi disjuntos), key por key (intercalados) y
+    // uno de n/1000 keys sueltas contra uno de n
+    struct Caso {
+        const char* nombre;
+        size_t largoA, largoB, keysB;
+    };
+    const Caso casos[] = {{"bloques de 65536", 1 << 16, 1 << 16, n},
+                          {"bloques de 64", 64, 64, n},
+                          {"intercalados", 1, 1, n},
+                          {"chico contra grande", 1, 1000, n / 1000}};
+    for (const Caso& caso : casos) {
+        for (int op = 0; op < 3; ++op) {
+            // en interseccion y diferencia b tambien toma el primer octavo de las keys de a, para que compartan keys
+            auto armar = [&](std::unique_ptr<Arbol>& a, std::unique_ptr<Arbol>& b) {
+                a = bloques(n, caso.largoA, M, 0);
+                b = bloques(caso.keysB, caso.largoB, M, 1);
+                if (op == 0)
+                    return;
+                std::vector<int> comunes;
+                for (auto it = a->begin(); comunes.size() < n / 8; ++it)
+                    comunes.push_back(*it);
+                b->insert_sorted_batch(comunes.begin(), comunes.end());
+            };
+
+            std::unique_ptr<Arbol> a, b;
+            armar(a, b);
+            const size_t keys = a->size() + b->size();
+            bench::Cronometro cronometro;
+            if (op == 0) {
+                for (int key : *b)
+                    a->insert(key);
+            } else if (op == 1) {
+                std::unique_ptr<Arbol> resultado(new Arbol(M));
+                for (int key : *a) {
+                    if (b->search(key))
+                        resultado->insert(key);
+                }
+                a.swap(resultado);
+            } else {
+                for (int key : *b)
+                    a->remove(key);
+            }
+            double ingenuo = cronometro.segundos();
+            const int esperado = a->size();
+
+            armar(a, b);
+            cronometro.reiniciar();
+            if (op == 0)
+                a->set_union(*b);
+            else if (op == 1)
+                a->set_intersection(*b);
+            else
+                a->set_difference(*b);
+            double rapido = cronometro.segundos();
+            if (a->size() != esperado || !a->check_properties())
+                std::printf("el resultado no coincide con la version ingenua\n");
+
+            static const char* const operaciones[] = {"union", "interseccion", "diferencia"};
+            char nombre[64];
+            std::snprintf(nombre, sizeof(nombre), "%s %s", operaciones[op], caso.nombre);
+            fila(nombre, keys, ingenuo, rapido);
+        }
+    }
+    return 0;
+}
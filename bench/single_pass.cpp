@@ -0,0 +1,58 @@
+// Latencia por operacion (p50, p99, p99.9, maximo) de insert y remove: algoritmo de dos pasadas
+// (bajar con findPathToKey y arreglar subiendo) contra el modo de una pasada (set_single_pass).
+// uso: single_pass [n_claves] [M]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+struct Percentiles {
+    double p50, p99, p999, maximo, promedio;
+};
+
+Percentiles resumir(std::vector<double>& ns) {
+    double total = 0;
+    for (double x : ns)
+        total += x;
+    std::sort(ns.begin(), ns.end());
+    auto p = [&](double q) { return ns[static_cast<size_t>(q * (ns.size() - 1))]; };
+    return {p(0.5), p(0.99), p(0.999), ns.back(), total / ns.size()};
+}
+
+template <typename Operar>
+Percentiles medir(const std::vector<int>& claves, Operar operar) {
+    std::vector<double> ns(claves.size());
+    for (size_t i = 0; i < claves.size(); ++i) {
+        auto inicio = std::chrono::steady_clock::now();
+        operar(claves[i]);
+        ns[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - inicio).count();
+    }
+    return resumir(ns);
+}
+
+void imprimir(const char* nombre, const Percentiles& p) {
+    std::printf("%-22s %8.0f %8.0f %8.0f %10.0f %8.1f\n", nombre, p.p50, p.p99, p.p999, p.maximo, p.promedio);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 16));
+    std::vector<int> claves = bench::enterosAleatorios(n, 1 << 30, 4);
+
+    std::printf("M = %d, n = %zu (ns por operacion)\n", M, n);
+    std::printf("%-22s %8s %8s %8s %10s %8s\n", "", "p50", "p99", "p99.9", "max", "prom");
+    for (bool unaPasada : {false, true}) {
+        BTree<int> btree(M);
+        btree.set_single_pass(unaPasada);
+        Percentiles insercion = medir(claves, [&](int key) { btree.insert(key); });
+        bool valido = btree.check_properties();
+        Percentiles eliminacion = medir(claves, [&](int key) { btree.remove(key); });
+        imprimir(unaPasada ? "insert una pasada" : "insert dos pasadas", insercion);
+        imprimir(unaPasada ? "remove una pasada" : "remove dos pasadas", eliminacion);
+        if (!valido || !btree.empty())
+            std::printf("  ERROR: el arbol no cumple las propiedades\n");
+    }
+    return 0;
+}
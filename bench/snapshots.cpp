@@ -0,0 +1,52 @@
+// Costo de los snapshots copy-on-write: con 0, 1, 10 y 100 snapshots vivos (se toma uno nuevo
+// cada ops/snapshots operaciones y se suelta el mas viejo), throughput de insert/remove
+// aleatorios y memoria extra en el heap respecto al arbol sin snapshots.
+// uso: snapshots [n_claves] [M] [ops]
+#include <cstdio>
+#include <deque>
+#include <memory>
+
+#include "../btree.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 32));
+    size_t ops = bench::argumento(argc, argv, 3, 1 << 20);
+    const int rango = static_cast<int>(2 * n);
+
+    std::vector<int> base = bench::enterosAleatorios(n, rango, 1);
+    std::vector<int> claves = bench::enterosAleatorios(ops, rango, 2);
+
+    std::printf("M = %d, n = %zu, ops = %zu\n", M, n, ops);
+    std::printf("%10s %14s %14s %16s\n", "snapshots", "ops/s", "MiB arbol", "MiB extra");
+    double mibBase = 0;
+    for (size_t vivos : {0, 1, 10, 100}) {
+        size_t antes = bench::bytesVivos;
+        BTree<int> btree(M);
+        for (int key : base)
+            btree.insert(key);
+
+        std::deque<std::shared_ptr<const BTree<int>>> snapshots;
+        size_t cada = vivos == 0 ? ops + 1 : std::max<size_t>(1, ops / vivos);
+        bench::Cronometro cronometro;
+        for (size_t i = 0; i < ops; ++i) {
+            if (i % cada == 0) {
+                snapshots.push_back(btree.snapshot());
+                if (snapshots.size() > vivos)
+                    snapshots.pop_front();
+            }
+            if (i % 2 == 0)
+                btree.insert(claves[i]);
+            else
+                btree.remove(claves[i - 1]);
+        }
+        double throughput = ops / cronometro.segundos();
+        double mib = (bench::bytesVivos - antes) / 1048576.0;
+        if (vivos == 0)
+            mibBase = mib;
+        std::printf("%10zu %14.0f %14.1f %16.1f\n", snapshots.size(), throughput, mib, mib - mibBase);
+    }
+    return 0;
+}
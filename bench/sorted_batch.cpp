@@ -0,0 +1,45 @@
+// Insercion de lotes ordenados en un arbol con datos: insert en un bucle contra
+// insert_sorted_batch, con lotes ralos (pocas keys por hoja) y densos (varias keys por hoja,
+// o tan grandes que conviene mezclar y reconstruir).
+// uso: sorted_batch [n_claves_en_el_arbol] [M]
+#include <algorithm>
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 21);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 64));
+
+    // keys pares en el arbol, el lote trae keys impares
+    std::vector<int> base(n);
+    for (size_t i = 0; i < n; ++i)
+        base[i] = static_cast<int>(2 * i);
+
+    std::printf("M = %d, n = %zu\n", M, n);
+    std::printf("%10s %12s %16s %16s %8s\n", "lote", "keys/hoja", "loop keys/s", "batch keys/s", "mejora");
+    for (size_t lote : {size_t{10000}, size_t{100000}, size_t{400000}, n, 4 * n}) {
+        std::vector<int> claves = bench::enterosAleatorios(lote, static_cast<int>(n), 7);
+        for (int& c : claves)
+            c = 2 * c + 1;
+        std::sort(claves.begin(), claves.end());
+
+        BTree<int>* btree = BTree<int>::build_from_ordered_vector(base, M);
+        bench::Cronometro cronometro;
+        for (int key : claves)
+            btree->insert(key);
+        double loop = lote / cronometro.segundos();
+        delete btree;
+
+        btree = BTree<int>::build_from_ordered_vector(base, M);
+        cronometro.reiniciar();
+        btree->insert_sorted_batch(claves.begin(), claves.end());
+        double batch = lote / cronometro.segundos();
+        delete btree;
+
+        double porHoja = static_cast<double>(lote) / (n / (M - 1));
+        std::printf("%10zu %12.2f %16.0f %16.0f %7.1fx\n", lote, porHoja, loop, batch, batch / loop);
+    }
+    return 0;
+}
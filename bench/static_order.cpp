@@ -0,0 +1,59 @@
+// Compara BTree<TK> (orden en tiempo de ejecucion) con BTree<TK, M> (orden fijo)
+// en insert, search y remove.
+// uso: static_order [n_claves]
+#include <cstdio>
+
+#include "../btree.h"
+#include "bench.h"
+
+struct Resultado {
+    double insertPorSegundo;
+    double searchPorSegundo;
+    double removePorSegundo;
+};
+
+template <typename Arbol>
+Resultado medir(Arbol& btree, const std::vector<int>& claves, const std::vector<int>& consultas) {
+    Resultado r{};
+    bench::Cronometro cronometro;
+    for (int key : claves)
+        btree.insert(key);
+    r.insertPorSegundo = claves.size() / cronometro.segundos();
+
+    size_t encontrados = 0;
+    cronometro.reiniciar();
+    for (int key : consultas)
+        encontrados += btree.search(key);
+    r.searchPorSegundo = consultas.size() / cronometro.segundos();
+    bench::noOptimizar(encontrados);
+
+    cronometro.reiniciar();
+    for (int key : claves)
+        btree.remove(key);
+    r.removePorSegundo = claves.size() / cronometro.segundos();
+    return r;
+}
+
+template <int M>
+void comparar(const std::vector<int>& claves, const std::vector<int>& consultas) {
+    BTree<int> dinamico(M);
+    BTree<int, M> fijo;
+    Resultado d = medir(dinamico, claves, consultas);
+    Resultado f = medir(fijo, claves, consultas);
+    std::printf("%4d %-8s %14.0f %14.0f %14.0f\n", M, "dinamico", d.insertPorSegundo, d.searchPorSegundo, d.removePorSegundo);
+    std::printf("%4d %-8s %14.0f %14.0f %14.0f\n", M, "fijo", f.insertPorSegundo, f.searchPorSegundo, f.removePorSegundo);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    std::vector<int> claves = bench::enterosAleatorios(n, 1 << 30, 1);
+    std::vector<int> consultas = bench::enterosAleatorios(n, 1 << 30, 2);
+    for (size_t i = 0; i < n; i += 2)
+        consultas[i] = claves[(i * 7919) % n];
+
+    std::printf("%4s %-8s %14s %14s %14s\n", "M", "variante", "insert/s", "search/s", "remove/s");
+    comparar<16>(claves, consultas);
+    comparar<32>(claves, consultas);
+    comparar<64>(claves, consultas);
+    return 0;
+}
@@ -0,0 +1,243 @@
+// Suite de regresion con Google Benchmark: insert, search, remove, rangeSearch y
+// build_from_ordered_vector para keys int, uint64_t y std::string, ordenes M 8/32/128,
+// distribuciones secuencial, uniforme y Zipf (s = 0.99) y tamaños 10^4, 10^6 y 10^8.
+// Cada benchmark reporta items_per_second (keys u operaciones por segundo).
+//
+// uso: suite [--n_max=N] [opciones de Google Benchmark]
+//   --n_max=N   tamaño maximo (10^6 por defecto; 10^8 pide unos 2 GiB con int, y las keys
+//               std::string se limitan a 10^7)
+//   --benchmark_out=reporte.json --benchmark_out_format=json  reporte para comparar entre PRs
+//   (el target bench_report de CMake lo genera en el directorio de build)
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "../btree.h"
+#include "bench.h"
+
+enum class Distribucion { SECUENCIAL, UNIFORME, ZIPF };
+
+static const char* nombreDistribucion(Distribucion d) {
+    switch (d) {
+        case Distribucion::SECUENCIAL: return "secuencial";
+        case Distribucion::UNIFORME: return "uniforme";
+        default: return "zipf";
+    }
+}
+
+// cantidad valores en [0, dominio): 0, 1, 2... (secuencial), uniformes, o rangos Zipf dispersados
+// por el dominio (las keys populares no quedan juntas)
+static std::vector<uint64_t> generar(Distribucion d, size_t cantidad, uint64_t dominio, uint64_t semilla) {
+    std::vector<uint64_t> valores(cantidad);
+    std::mt19937_64 rng(semilla);
+    if (d == Distribucion::SECUENCIAL) {
+        for (size_t i = 0; i < cantidad; ++i)
+            valores[i] = i % dominio;
+    } else if (d == Distribucion::UNIFORME) {
+        std::uniform_int_distribution<uint64_t> uniforme(0, dominio - 1);
+        for (uint64_t& v : valores)
+            v = uniforme(rng);
+    } else {
+        bench::Zipf zipf(dominio);
+        for (uint64_t& v : valores)
+            v = bench::dispersar(zipf(rng)) % dominio;
+    }
+    return valores;
+}
+
+template <typename TK>
+static TK convertir(uint64_t x) {
+    if constexpr (std::is_same_v<TK, std::string>) {
+        char texto[24];
+        std::snprintf(texto, sizeof(texto), "%016" PRIu64, x); // ancho fijo: mismo orden que x
+        return texto;
+    } else {
+        return static_cast<TK>(x);
+    }
+}
+
+template <typename TK>
+static const char* nombreTipo() {
+    if constexpr (std::is_same_v<TK, int>)
+        return "int";
+    else if constexpr (std::is_same_v<TK, uint64_t>)
+        return "uint64";
+    else
+        return "string";
+}
+
+// Keys de una configuracion (tipo, distribucion, n): la secuencia de operaciones y las keys
+// distintas ordenadas
+template <typename TK>
+struct Datos {
+    std::vector<TK> operaciones; // n keys en el orden en que se insertan / buscan / eliminan
+    std::vector<TK> ordenadas;   // keys distintas de operaciones, ascendentes
+};
+
+// Se guarda solo la ultima configuracion (de cualquier tipo) para no juntar varios arreglos de 10^8
+static std::shared_ptr<void> ultimo;
+static std::string ultimaClave;
+
+template <typename TK>
+static const Datos<TK>& obtenerDatos(Distribucion d, size_t n) {
+    std::string clave = std::string(nombreTipo<TK>()) + "/" + nombreDistribucion(d) + "/" + std::to_string(n);
+    if (clave != ultimaClave) {
+        ultimo.reset(); // libera antes de generar la siguiente
+        auto datos = std::make_shared<Datos<TK>>();
+        std::vector<uint64_t> valores = generar(d, n, d == Distribucion::SECUENCIAL ? n : 2 * n, 42);
+        datos->operaciones.reserve(n);
+        for (uint64_t v : valores)
+            datos->operaciones.push_back(convertir<TK>(v));
+        std::sort(valores.begin(), valores.end());
+        valores.erase(std::unique(valores.begin(), valores.end()), valores.end());
+        datos->ordenadas.reserve(valores.size());
+        for (uint64_t v : valores)
+            datos->ordenadas.push_back(convertir<TK>(v));
+        ultimo = datos;
+        ultimaClave = clave;
+    }
+    return *static_cast<const Datos<TK>*>(ultimo.get());
+}
+
+// Arbol con las keys de la configuracion para search/remove/rangeSearch. Se arma con la carga
+// masiva al 70% de llenado (lo que dejan los inserts aleatorios): con 10^8 keys armarlo a fuerza
+// de inserts toma mas de 20 minutos.
+template <typename TK>
+static std::unique_ptr<BTree<TK>> llenar(const Datos<TK>& datos, int M) {
+    return std::unique_ptr<BTree<TK>>(BTree<TK>::build_from_ordered_vector_parallel(datos.ordenadas, M, 1, 0.7));
+}
+
+template <typename TK>
+static void insertar(benchmark::State& state, Distribucion d, size_t n, int M) {
+    const Datos<TK>& datos = obtenerDatos<TK>(d, n);
+    for (auto _ : state) {
+        auto btree = std::make_unique<BTree<TK>>(M);
+        for (const TK& key : datos.operaciones)
+            btree->insert(key);
+        state.PauseTiming();
+        btree.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename TK>
+static void buscar(benchmark::State& state, Distribucion d, size_t n, int M) {
+    const Datos<TK>& datos = obtenerDatos<TK>(d, n);
+    auto btree = llenar(datos, M);
+    // las busquedas siguen la misma distribucion con otra semilla (las uniformes fallan la mitad)
+    std::vector<TK> buscadas;
+    for (uint64_t v : generar(d, std::min<size_t>(n, 1 << 20), d == Distribucion::SECUENCIAL ? n : 2 * n, 7))
+        buscadas.push_back(convertir<TK>(v));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(btree->search(buscadas[i]));
+        if (++i == buscadas.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename TK>
+static void eliminar(benchmark::State& state, Distribucion d, size_t n, int M) {
+    const Datos<TK>& datos = obtenerDatos<TK>(d, n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto btree = llenar(datos, M);
+        state.ResumeTiming();
+        for (const TK& key : datos.operaciones)
+            btree->remove(key);
+        state.PauseTiming();
+        btree.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// rangos de 100 keys consecutivas; el inicio sigue la distribucion
+template <typename TK>
+static void rango(benchmark::State& state, Distribucion d, size_t n, int M) {
+    const Datos<TK>& datos = obtenerDatos<TK>(d, n);
+    const std::vector<TK>& keys = datos.ordenadas;
+    auto btree = llenar(datos, M);
+    const size_t ancho = std::min<size_t>(100, keys.size() - 1);
+    std::vector<uint64_t> inicios = generar(d, std::min<size_t>(n, 1 << 16), keys.size() - ancho, 11);
+    size_t i = 0, total = 0;
+    for (auto _ : state) {
+        std::vector<TK> resultado = btree->rangeSearch(keys[inicios[i]], keys[inicios[i] + ancho]);
+        total += resultado.size();
+        benchmark::DoNotOptimize(resultado.data());
+        if (++i == inicios.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(total);
+}
+
+template <typename TK>
+static void construir(benchmark::State& state, Distribucion d, size_t n, int M) {
+    std::vector<TK> keys = obtenerDatos<TK>(d, n).ordenadas; // build_from_ordered_vector pide un vector no const
+    for (auto _ : state) {
+        BTree<TK>* btree = BTree<TK>::build_from_ordered_vector(keys, M);
+        state.PauseTiming();
+        delete btree;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// nombre: operacion<tipo>/distribucion/M:m/n:n
+template <typename TK>
+static void registrar(const char* operacion, void (*f)(benchmark::State&, Distribucion, size_t, int),
+                      Distribucion d, size_t n, int M) {
+    std::string nombre = std::string(operacion) + "<" + nombreTipo<TK>() + ">/" + nombreDistribucion(d) +
+                         "/M:" + std::to_string(M) + "/n:" + std::to_string(n);
+    benchmark::RegisterBenchmark(nombre.c_str(), f, d, n, M)->Unit(benchmark::kNanosecond);
+}
+
+template <typename TK>
+static void registrarTipo(size_t nMax) {
+    if (std::is_same_v<TK, std::string>)
+        nMax = std::min<size_t>(nMax, 10000000);
+    // en el orden en que corren, los benchmarks seguidos comparten (distribucion, n) y reusan los datos
+    for (size_t n = 10000; n <= nMax; n *= 100) {
+        for (Distribucion d : {Distribucion::SECUENCIAL, Distribucion::UNIFORME, Distribucion::ZIPF}) {
+            for (int M : {8, 32, 128}) {
+                registrar<TK>("insert", insertar<TK>, d, n, M);
+                registrar<TK>("search", buscar<TK>, d, n, M);
+                registrar<TK>("remove", eliminar<TK>, d, n, M);
+                registrar<TK>("rangeSearch", rango<TK>, d, n, M);
+                // la carga masiva solo depende de cuantas keys distintas hay
+                if (d == Distribucion::SECUENCIAL)
+                    registrar<TK>("build_from_ordered_vector", construir<TK>, d, n, M);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t nMax = 1000000;
+    int restantes = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--n_max=", 8) == 0)
+            nMax = std::strtoull(argv[i] + 8, nullptr, 10);
+        else
+            argv[restantes++] = argv[i];
+    }
+    argc = restantes;
+
+    registrarTipo<int>(nMax);
+    registrarTipo<uint64_t>(nMax);
+    registrarTipo<std::string>(nMax);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Busquedas con keys string que llegan como std::string_view (por ejemplo, cortadas de un buffer
+// de entrada): BTree<std::string> obliga a construir un std::string por consulta, y con
+// Compare = std::less<> (transparente) se busca con el string_view directo. Se miden reservas
+// en el heap y tiempo por consulta, con keys cortas (entran en el buffer interno del string) y
+// largas (cada std::string temporal pide memoria).
+// uso: transparent_lookup [n_claves] [M]
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "../btreemap.h"
+#include "alloc_counter.h"
+#include "bench.h"
+
+template <typename Compare>
+using Arbol = BTree<std::string, 0, void, false, Compare>;
+
+template <typename Compare>
+using Mapa = BTreeMap<std::string, int, 0, Compare>;
+
+static void fila(const char* nombre, size_t consultas, size_t reservas, double segundos) {
+    std::printf("%-36s %14.2f %12.1f\n", nombre, static_cast<double>(reservas) / consultas, segundos * 1e9 / consultas);
+}
+
+// f(consulta) por cada consulta, contando reservas y tiempo
+template <typename F>
+static void medir(const char* nombre, const std::vector<std::string_view>& consultas, F f) {
+    size_t reservas = bench::reservas;
+    bench::Cronometro cronometro;
+    long encontradas = 0;
+    for (std::string_view consulta : consultas)
+        encontradas += f(consulta);
+    double segundos = cronometro.segundos();
+    reservas = bench::reservas - reservas;
+    bench::noOptimizar(encontradas);
+    fila(nombre, consultas.size(), reservas, segundos);
+}
+
+int main(int argc, char** argv) {
+    size_t n = bench::argumento(argc, argv, 1, 1 << 20);
+    int M = static_cast<int>(bench::argumento(argc, argv, 2, 32));
+    std::vector<int> numeros = bench::enterosAleatorios(n, 1 << 30, 1);
+    std::vector<int> posiciones = bench::enterosAleatorios(n, static_cast<int>(n), 2);
+
+    std::printf("M = %d, n = %zu\n", M, n);
+    for (const char* prefijo : {"", "/api/v1/usuarios/"}) {
+        std::vector<std::string> claves;
+        claves.reserve(n);
+        for (int x : numeros)
+            claves.push_back(prefijo + bench::claveString(x));
+
+        // las consultas son vistas a un solo buffer, la mitad de keys que estan y la mitad no
+        // (los numeros de las claves son menores que 2^30)
+        std::string buffer;
+        for (size_t i = 0; i < n; ++i)
+            buffer += i % 2 == 0 ? claves[posiciones[i]] : prefijo + bench::claveString((1 << 30) + posiciones[i]);
+        std::vector<std::string_view> consultas;
+        consultas.reserve(n);
+        const size_t largo = claves[0].size();
+        for (size_t i = 0; i < n; ++i)
+            consultas.emplace_back(buffer.data() + i * largo, largo);
+
+        Arbol<std::less<std::string>> arbol(M);
+        Arbol<std::less<>> transparente(M);
+        Mapa<std::less<std::string>> mapa(M);
+        Mapa<std::less<>> mapaTransparente(M);
+        for (const std::string& key : claves) {
+            arbol.insert(key);
+            transparente.insert(key);
+            mapa.insert_or_assign(key, 1);
+            mapaTransparente.insert_or_assign(key, 1);
+        }
+
+        std::printf("\nkeys de %zu caracteres\n", largo);
+        std::printf("%-36s %14s %12s\n", "", "reservas/op", "ns/op");
+        medir("search(std::string(sv))", consultas,
+              [&](std::string_view sv) { return arbol.search(std::string(sv)); });
+        medir("search(sv), std::less<>", consultas, [&](std::string_view sv) { return transparente.search(sv); });
+        medir("lower_bound(std::string(sv))", consultas,
+              [&](std::string_view sv) { return arbol.lower_bound(std::string(sv)) != arbol.end(); });
+        medir("lower_bound(sv), std::less<>", consultas,
+              [&](std::string_view sv) { return transparente.lower_bound(sv) != transparente.end(); });
+        medir("BTreeMap::find(std::string(sv))", consultas,
+              [&](std::string_view sv) { return mapa.find(std::string(sv)) != nullptr; });
+        medir("BTreeMap::find(sv), std::less<>", consultas,
+              [&](std::string_view sv) { return mapaTransparente.find(sv) != nullptr; });
+    }
+    return 0;
+}
@@ -0,0 +1,629 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "btree.h"
+
+// Nodo del arbol B+, en un solo bloque alineado igual que Node<TK, 0>:
+// [count, leaf, punteros][keys (M-1)][children (M), solo si no es hoja]
+// Las hojas guardan todas las keys y se enlazan con sus hermanas; los nodos internos
+// solo guardan separadores (copias de la key minima de cada subarbol derecho).
+template <typename TK>
+struct BPlusNode {
+    // array de keys (separadores en los nodos internos)
+    TK* keys;
+    // array de punteros a hijos (nullptr si es hoja)
+    BPlusNode** children;
+    // hojas vecinas (solo en hojas)
+    BPlusNode* prev;
+    BPlusNode* next;
+    // cantidad de keys
+    int count;
+    // indicador de nodo hoja
+    bool leaf;
+
+    static constexpr std::size_t ALINEACION = std::max<std::size_t>(64, alignof(TK));
+
+    static constexpr std::size_t alinear(std::size_t x, std::size_t a) {
+        return (x + a - 1) / a * a;
+    }
+
+    static constexpr std::size_t offsetKeys() {
+        return alinear(sizeof(BPlusNode), alignof(TK));
+    }
+
+    static constexpr std::size_t offsetChildren(const int& M) {
+        return alinear(offsetKeys() + (M - 1) * sizeof(TK), alignof(BPlusNode*));
+    }
+
+    static constexpr std::size_t bytes(const int& M, bool leaf) {
+        return alinear(leaf ? offsetChildren(M) : offsetChildren(M) + M * sizeof(BPlusNode*), ALINEACION);
+    }
+
+    static BPlusNode* create(void* memoria, const int& M, bool leaf) {
+        char* bloque = static_cast<char*>(memoria);
+        BPlusNode* node = new (bloque) BPlusNode();
+        node->keys = reinterpret_cast<TK*>(bloque + offsetKeys());
+        std::uninitialized_value_construct_n(node->keys, M - 1);
+        if (!leaf) {
+            node->children = reinterpret_cast<BPlusNode**>(bloque + offsetChildren(M));
+            std::uninitialized_value_construct_n(node->children, M);
+        }
+        node->leaf = leaf;
+        return node;
+    }
+
+    static void destroy(BPlusNode* node, const int& M) {
+        std::destroy_n(node->keys, M - 1);
+        node->~BPlusNode();
+    }
+
+private:
+    BPlusNode() : keys(nullptr), children(nullptr), prev(nullptr), next(nullptr), count(0), leaf(true) {}
+};
+
+
+// Arbol B+ de orden M: todas las keys estan en hojas enlazadas, asi un rango se recorre
+// con una sola bajada hasta la primera hoja y luego una caminata secuencial por las hojas.
+template <typename TK>
+class BPlusTree : private OrdenArbol<0> {
+private:
+    using OrdenArbol<0>::M;
+    using OrdenArbol<0>::minKeys; // minimo de separadores en un nodo interno (no raiz)
+
+    using Nodo = BPlusNode<TK>;
+    using Camino = PilaFija<Pair<Nodo*, int>>;
+
+    Nodo* root;
+    int n; // total de elementos en el arbol
+    int minHoja; // minimo de keys en una hoja (no raiz)
+
+    NodePool poolHojas;
+    NodePool poolInternos;
+
+public:
+    explicit BPlusTree(const int& M_, std::pmr::memory_resource* recurso = std::pmr::get_default_resource())
+        : OrdenArbol<0>(M_), root(nullptr), n(0), minHoja(M_ / 2),
+          poolHojas(Nodo::bytes(M, true), Nodo::ALINEACION, recurso),
+          poolInternos(Nodo::bytes(M, false), Nodo::ALINEACION, recurso) {}
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    ~BPlusTree() {
+        clear();
+    }
+
+    bool search(const TK& key) const {
+        if (root == nullptr)
+            return false;
+        Nodo* hoja = buscarHoja(key);
+        int i = nodesearch::lowerBound(hoja->keys, hoja->count, key);
+        return i < hoja->count && !(key < hoja->keys[i]);
+    }
+
+    void insert(const TK& key) {
+        if (root == nullptr) {
+            root = nuevoNodo(true);
+            root->keys[0] = key;
+            root->count = 1;
+            ++n;
+            return;
+        }
+
+        Camino pila; // pares (nodo interno, hijo por el que se bajo)
+        Nodo* hoja = root;
+        while (!hoja->leaf) {
+            int i = indiceHijo(hoja, key);
+            pila.push({hoja, i});
+            hoja = hoja->children[i];
+        }
+
+        int pos = nodesearch::lowerBound(hoja->keys, hoja->count, key);
+        if (pos < hoja->count && !(key < hoja->keys[pos]))
+            return; // ya existe
+        ++n;
+
+        if (hoja->count < M - 1) {
+            insertarEnHoja(hoja, pos, key);
+            return;
+        }
+
+        // la hoja se divide y la key minima de la nueva hoja sube como separador
+        Nodo* izquierdo = hoja;
+        Nodo* derecho = dividirHoja(hoja, pos, key);
+        TK separador = derecho->keys[0];
+
+        while (true) {
+            if (pila.is_empty()) {
+                root = nuevoNodo(false);
+                root->keys[0] = separador;
+                root->children[0] = izquierdo;
+                root->children[1] = derecho;
+                root->count = 1;
+                break;
+            }
+            Pair<Nodo*, int> tope = pila.pop();
+            if (tope.first->count < M - 1) {
+                insertarEnInterno(tope.first, tope.second, separador, derecho);
+                break;
+            }
+            Pair<Nodo*, TK> result = dividirInterno(tope.first, tope.second, separador, derecho);
+            izquierdo = tope.first;
+            derecho = result.first;
+            separador = result.second;
+        }
+    }
+
+    void remove(const TK& key) {
+        if (root == nullptr)
+            return;
+
+        Camino pila;
+        Nodo* hoja = root;
+        while (!hoja->leaf) {
+            int i = indiceHijo(hoja, key);
+            pila.push({hoja, i});
+            hoja = hoja->children[i];
+        }
+
+        int pos = nodesearch::lowerBound(hoja->keys, hoja->count, key);
+        if (pos == hoja->count || key < hoja->keys[pos])
+            return; // no existe la key
+        eliminarDeHoja(hoja, pos);
+        --n;
+
+        if (hoja == root) {
+            if (hoja->count == 0) {
+                liberarNodo(root);
+                root = nullptr;
+            }
+            return;
+        }
+        if (hoja->count >= minHoja)
+            return;
+
+        // los separadores que quedan en los nodos internos siguen siendo validos para guiar
+        // la busqueda, solo se arreglan los nodos que quedan con pocas keys
+        Pair<Nodo*, int> tope = pila.pop();
+        arreglarHoja(hoja, tope.first, tope.second);
+
+        Nodo* current = tope.first;
+        while (current != root && current->count < minKeys) {
+            tope = pila.pop();
+            arreglarInterno(current, tope.first, tope.second);
+            current = tope.first;
+        }
+
+        if (root->count == 0) { // la raiz interna se quedo sin separadores
+            Nodo* viejo = root;
+            root = root->children[0];
+            liberarNodo(viejo);
+        }
+    }
+
+    int height() const {
+        if (root == nullptr)
+            return 0;
+        int height = 0;
+        for (Nodo* current = root; !current->leaf; current = current->children[0])
+            ++height;
+        return height;
+    }
+
+    std::string toString(const std::string& sep = " ") const {
+        std::string result;
+        for (Nodo* hoja = primeraHoja(); hoja != nullptr; hoja = hoja->next) {
+            for (int i = 0; i < hoja->count; ++i) {
+                if (!result.empty())
+                    result += sep;
+                result += keyToString(hoja->keys[i]);
+            }
+        }
+        return result;
+    }
+
+    std::vector<TK> rangeSearch(const TK& begin, const TK& end) const {
+        std::vector<TK> result;
+        rangeScan(begin, end, [&result](const TK& key) { result.push_back(key); });
+        return result;
+    }
+
+    // llama a visitar(key) para cada key en [begin, end], en orden, sin copiar el rango
+    template <typename F>
+    void rangeScan(const TK& begin, const TK& end, F visitar) const {
+        if (root == nullptr || end < begin)
+            return;
+        Nodo* hoja = buscarHoja(begin);
+        int i = nodesearch::lowerBound(hoja->keys, hoja->count, begin);
+        while (hoja != nullptr) {
+            for (; i < hoja->count; ++i) {
+                if (end < hoja->keys[i])
+                    return;
+                visitar(hoja->keys[i]);
+            }
+            hoja = hoja->next;
+            i = 0;
+        }
+    }
+
+    TK minKey() const {
+        if (root == nullptr)
+            throw std::runtime_error("Arbol vacio");
+        return primeraHoja()->keys[0];
+    }
+
+    TK maxKey() const {
+        if (root == nullptr)
+            throw std::runtime_error("Arbol vacio");
+        Nodo* current = root;
+        while (!current->leaf)
+            current = current->children[current->count];
+        return current->keys[current->count - 1];
+    }
+
+    void clear() {
+        if constexpr (!std::is_trivially_destructible_v<TK>) {
+            if (root != nullptr)
+                destruirSubarbol(root);
+        }
+        poolHojas.liberarTodo();
+        poolInternos.liberarTodo();
+        root = nullptr;
+        n = 0;
+    }
+
+    const int& size() const {
+        return n;
+    }
+
+    bool empty() const {
+        return root == nullptr;
+    }
+
+    // Construye el arbol por niveles a partir de un vector ordenado y sin repetidos:
+    // las hojas se llenan de forma pareja y se enlazan, luego se arman los niveles internos
+    static BPlusTree* build_from_ordered_vector(const std::vector<TK>& elements, const int& M,
+                                                std::pmr::memory_resource* recurso = std::pmr::get_default_resource()) {
+        BPlusTree* arbol = new BPlusTree(M, recurso);
+        if (elements.empty())
+            return arbol;
+
+        std::size_t nHojas = (elements.size() + M - 2) / (M - 1);
+        std::vector<Nodo*> nivel(nHojas);
+        std::vector<const TK*> minimos(nHojas); // key minima de cada subarbol del nivel
+        std::size_t base = elements.size() / nHojas;
+        std::size_t extra = elements.size() % nHojas;
+        std::size_t k = 0;
+        Nodo* anterior = nullptr;
+        for (std::size_t h = 0; h < nHojas; ++h) {
+            Nodo* hoja = arbol->nuevoNodo(true);
+            std::size_t c = base + (h < extra ? 1 : 0);
+            for (std::size_t j = 0; j < c; ++j)
+                hoja->keys[j] = elements[k++];
+            hoja->count = static_cast<int>(c);
+            hoja->prev = anterior;
+            if (anterior != nullptr)
+                anterior->next = hoja;
+            anterior = hoja;
+            nivel[h] = hoja;
+            minimos[h] = &hoja->keys[0];
+        }
+
+        while (nivel.size() > 1) {
+            std::size_t nPadres = (nivel.size() + M - 1) / M;
+            std::vector<Nodo*> siguiente(nPadres);
+            std::vector<const TK*> minimosSiguiente(nPadres);
+            base = nivel.size() / nPadres;
+            extra = nivel.size() % nPadres;
+            k = 0;
+            for (std::size_t p = 0; p < nPadres; ++p) {
+                Nodo* padre = arbol->nuevoNodo(false);
+                std::size_t c = base + (p < extra ? 1 : 0);
+                minimosSiguiente[p] = minimos[k];
+                for (std::size_t j = 0; j < c; ++j, ++k) {
+                    padre->children[j] = nivel[k];
+                    if (j > 0)
+                        padre->keys[j - 1] = *minimos[k];
+                }
+                padre->count = static_cast<int>(c) - 1;
+                siguiente[p] = padre;
+            }
+            nivel.swap(siguiente);
+            minimos.swap(minimosSiguiente);
+        }
+
+        arbol->root = nivel[0];
+        arbol->n = static_cast<int>(elements.size());
+        return arbol;
+    }
+
+    // Verifica: ocupacion minima y maxima, hojas al mismo nivel, keys ordenadas y dentro del
+    // rango de sus separadores, y que la lista de hojas coincida con el recorrido del arbol
+    bool check_properties() const {
+        if (root == nullptr)
+            return n == 0;
+        std::vector<Nodo*> hojas;
+        int nivelHojas = -1;
+        if (!check_properties_rec(root, nullptr, nullptr, 0, nivelHojas, hojas))
+            return false;
+
+        long total = 0;
+        Nodo* anterior = nullptr;
+        for (Nodo* hoja : hojas) {
+            if (hoja->prev != anterior || (anterior != nullptr && anterior->next != hoja))
+                return false;
+            if (anterior != nullptr && !(anterior->keys[anterior->count - 1] < hoja->keys[0]))
+                return false;
+            total += hoja->count;
+            anterior = hoja;
+        }
+        return anterior->next == nullptr && total == n;
+    }
+
+private:
+    Nodo* nuevoNodo(bool leaf) {
+        NodePool& pool = leaf ? poolHojas : poolInternos;
+        return Nodo::create(pool.reservar(), M, leaf);
+    }
+
+    void liberarNodo(Nodo* node) {
+        NodePool& pool = node->leaf ? poolHojas : poolInternos;
+        Nodo::destroy(node, M);
+        pool.devolver(node);
+    }
+
+    void destruirSubarbol(Nodo* node) {
+        if (!node->leaf) {
+            for (int i = 0; i <= node->count; ++i)
+                destruirSubarbol(node->children[i]);
+        }
+        Nodo::destroy(node, M);
+    }
+
+    // hijo por el que se baja buscando key: los separadores iguales a key quedan a la izquierda
+    static int indiceHijo(const Nodo* node, const TK& key) {
+        int i = nodesearch::lowerBound(node->keys, node->count, key);
+        if (i < node->count && !(key < node->keys[i]))
+            ++i;
+        return i;
+    }
+
+    Nodo* buscarHoja(const TK& key) const {
+        Nodo* current = root;
+        while (!current->leaf)
+            current = current->children[indiceHijo(current, key)];
+        return current;
+    }
+
+    Nodo* primeraHoja() const {
+        if (root == nullptr)
+            return nullptr;
+        Nodo* current = root;
+        while (!current->leaf)
+            current = current->children[0];
+        return current;
+    }
+
+    void insertarEnHoja(Nodo* hoja, int pos, const TK& key) {
+        for (int i = hoja->count; i > pos; --i)
+            hoja->keys[i] = hoja->keys[i - 1];
+        hoja->keys[pos] = key;
+        ++hoja->count;
+    }
+
+    void eliminarDeHoja(Nodo* hoja, int pos) {
+        for (int i = pos; i < hoja->count - 1; ++i)
+            hoja->keys[i] = hoja->keys[i + 1];
+        hoja->keys[hoja->count - 1] = TK();
+        --hoja->count;
+    }
+
+    // inserta el separador en la posicion index y su hijo derecho en index + 1
+    void insertarEnInterno(Nodo* node, int index, const TK& separador, Nodo* derecho) {
+        for (int i = node->count; i > index; --i)
+            node->keys[i] = node->keys[i - 1];
+        for (int i = node->count + 1; i > index + 1; --i)
+            node->children[i] = node->children[i - 1];
+        node->keys[index] = separador;
+        node->children[index + 1] = derecho;
+        ++node->count;
+    }
+
+    // quita el separador index y su hijo derecho
+    void quitarDeInterno(Nodo* node, int index) {
+        for (int i = index; i < node->count - 1; ++i)
+            node->keys[i] = node->keys[i + 1];
+        for (int i = index + 1; i < node->count; ++i)
+            node->children[i] = node->children[i + 1];
+        node->keys[node->count - 1] = TK();
+        node->children[node->count] = nullptr;
+        --node->count;
+    }
+
+    // Divide una hoja llena al insertar key en pos. Se trabaja sobre la secuencia virtual de
+    // M keys (las de la hoja con key insertada): primero se llena la hoja derecha y luego se
+    // acomoda la izquierda de atras hacia adelante, sin arrays temporales.
+    Nodo* dividirHoja(Nodo* hoja, int pos, const TK& key) {
+        auto clave = [&](int j) -> const TK& {
+            return j < pos ? hoja->keys[j] : (j == pos ? key : hoja->keys[j - 1]);
+        };
+        int izquierda = (M + 1) / 2;
+        Nodo* derecha = nuevoNodo(true);
+        for (int j = izquierda; j < M; ++j)
+            derecha->keys[j - izquierda] = clave(j);
+        derecha->count = M - izquierda;
+
+        if (pos < izquierda) {
+            for (int j = izquierda - 1; j > pos; --j)
+                hoja->keys[j] = hoja->keys[j - 1];
+            hoja->keys[pos] = key;
+        }
+        for (int j = izquierda; j < M - 1; ++j)
+            hoja->keys[j] = TK();
+        hoja->count = izquierda;
+
+        derecha->next = hoja->next;
+        if (derecha->next != nullptr)
+            derecha->next->prev = derecha;
+        derecha->prev = hoja;
+        hoja->next = derecha;
+        return derecha;
+    }
+
+    // Divide un nodo interno lleno al insertar (separador, derecho) en index. La key del medio
+    // de la secuencia virtual sube al padre, igual que en BTree::split.
+    Pair<Nodo*, TK> dividirInterno(Nodo* node, int index, const TK& separador, Nodo* derecho) {
+        auto clave = [&](int j) -> const TK& {
+            return j < index ? node->keys[j] : (j == index ? separador : node->keys[j - 1]);
+        };
+        auto hijo = [&](int j) -> Nodo* {
+            return j <= index ? node->children[j] : (j == index + 1 ? derecho : node->children[j - 1]);
+        };
+        int medio = (M - 1) / 2;
+        TK arriba = clave(medio);
+
+        Nodo* derecha = nuevoNodo(false);
+        for (int j = medio + 1; j < M; ++j)
+            derecha->keys[j - medio - 1] = clave(j);
+        for (int j = medio + 1; j <= M; ++j)
+            derecha->children[j - medio - 1] = hijo(j);
+        derecha->count = M - 1 - medio;
+
+        if (index < medio) {
+            for (int j = medio - 1; j > index; --j)
+                node->keys[j] = node->keys[j - 1];
+            node->keys[index] = separador;
+            for (int j = medio; j > index + 1; --j)
+                node->children[j] = node->children[j - 1];
+            node->children[index + 1] = derecho;
+        }
+        for (int j = medio; j < M - 1; ++j) {
+            node->keys[j] = TK();
+            node->children[j + 1] = nullptr;
+        }
+        node->count = medio;
+        return {derecha, arriba};
+    }
+
+    // hoja con menos de minHoja keys: se presta una key de una hermana o se fusionan
+    void arreglarHoja(Nodo* hoja, Nodo* padre, int index) {
+        Nodo* izquierda = index > 0 ? padre->children[index - 1] : nullptr;
+        Nodo* derecha = index < padre->count ? padre->children[index + 1] : nullptr;
+
+        if (izquierda != nullptr && izquierda->count > minHoja) {
+            insertarEnHoja(hoja, 0, izquierda->keys[izquierda->count - 1]);
+            eliminarDeHoja(izquierda, izquierda->count - 1);
+            padre->keys[index - 1] = hoja->keys[0];
+        } else if (derecha != nullptr && derecha->count > minHoja) {
+            insertarEnHoja(hoja, hoja->count, derecha->keys[0]);
+            eliminarDeHoja(derecha, 0);
+            padre->keys[index] = derecha->keys[0];
+        } else if (derecha != nullptr) {
+            fusionarHojas(hoja, derecha);
+            quitarDeInterno(padre, index);
+        } else {
+            fusionarHojas(izquierda, hoja);
+            quitarDeInterno(padre, index - 1);
+        }
+    }
+
+    // pasa las keys de derecha a izquierda y saca derecha de la lista de hojas
+    void fusionarHojas(Nodo* izquierda, Nodo* derecha) {
+        for (int j = 0; j < derecha->count; ++j)
+            izquierda->keys[izquierda->count + j] = derecha->keys[j];
+        izquierda->count += derecha->count;
+        izquierda->next = derecha->next;
+        if (izquierda->next != nullptr)
+            izquierda->next->prev = izquierda;
+        liberarNodo(derecha);
+    }
+
+    // nodo interno con menos de minKeys separadores: rotacion a traves del padre o fusion
+    void arreglarInterno(Nodo* node, Nodo* padre, int index) {
+        Nodo* izquierda = index > 0 ? padre->children[index - 1] : nullptr;
+        Nodo* derecha = index < padre->count ? padre->children[index + 1] : nullptr;
+
+        if (izquierda != nullptr && izquierda->count > minKeys) {
+            for (int i = node->count; i > 0; --i)
+                node->keys[i] = node->keys[i - 1];
+            for (int i = node->count + 1; i > 0; --i)
+                node->children[i] = node->children[i - 1];
+            node->keys[0] = padre->keys[index - 1];
+            node->children[0] = izquierda->children[izquierda->count];
+            ++node->count;
+            padre->keys[index - 1] = izquierda->keys[izquierda->count - 1];
+            izquierda->keys[izquierda->count - 1] = TK();
+            izquierda->children[izquierda->count] = nullptr;
+            --izquierda->count;
+        } else if (derecha != nullptr && derecha->count > minKeys) {
+            node->keys[node->count] = padre->keys[index];
+            node->children[node->count + 1] = derecha->children[0];
+            ++node->count;
+            padre->keys[index] = derecha->keys[0];
+            for (int i = 0; i < derecha->count - 1; ++i)
+                derecha->keys[i] = derecha->keys[i + 1];
+            for (int i = 0; i < derecha->count; ++i)
+                derecha->children[i] = derecha->children[i + 1];
+            derecha->keys[derecha->count - 1] = TK();
+            derecha->children[derecha->count] = nullptr;
+            --derecha->count;
+        } else if (derecha != nullptr) {
+            fusionarInternos(node, padre->keys[index], derecha);
+            quitarDeInterno(padre, index);
+        } else {
+            fusionarInternos(izquierda, padre->keys[index - 1], node);
+            quitarDeInterno(padre, index - 1);
+        }
+    }
+
+    // izquierda + separador del padre + derecha en un solo nodo
+    void fusionarInternos(Nodo* izquierda, const TK& separador, Nodo* derecha) {
+        izquierda->keys[izquierda->count] = separador;
+        for (int j = 0; j < derecha->count; ++j)
+            izquierda->keys[izquierda->count + 1 + j] = derecha->keys[j];
+        for (int j = 0; j <= derecha->count; ++j)
+            izquierda->children[izquierda->count + 1 + j] = derecha->children[j];
+        izquierda->count += 1 + derecha->count;
+        liberarNodo(derecha);
+    }
+
+    // keys del subarbol en [inferior, superior) (nullptr = sin cota)
+    bool check_properties_rec(Nodo* node, const TK* inferior, const TK* superior, int nivel,
+                              int& nivelHojas, std::vector<Nodo*>& hojas) const {
+        if (node->count > M - 1)
+            return false;
+        if (node != root && node->count < (node->leaf ? minHoja : minKeys))
+            return false;
+        if (node->count == 0)
+            return false;
+        for (int i = 0; i < node->count; ++i) {
+            if (i > 0 && !(node->keys[i - 1] < node->keys[i]))
+                return false;
+            if (inferior != nullptr && node->keys[i] < *inferior)
+                return false;
+            if (superior != nullptr && !(node->keys[i] < *superior))
+                return false;
+        }
+
+        if (node->leaf) {
+            if (nivelHojas == -1)
+                nivelHojas = nivel;
+            hojas.push_back(node);
+            return nivelHojas == nivel;
+        }
+        for (int i = 0; i <= node->count; ++i) {
+            const TK* inf = i == 0 ? inferior : &node->keys[i - 1];
+            const TK* sup = i == node->count ? superior : &node->keys[i];
+            if (!check_properties_rec(node->children[i], inf, sup, nivel + 1, nivelHojas, hojas))
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -5,10 +5,25 @@
 #include <stdexcept>
 #include <sstream>
 #include <type_traits>
+#include <iterator>
+#include <cstddef>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <limits>
+#include <cmath>
+#include <array>
+#include <cstdint>
+#include <functional>
 
 #include "node.h"
-#include "Pila.h"
+#include "nodepool.h"
+#include "PilaFija.h"
 #include "Pair.h"
+#include "nodesearch.h"
+#include "serializador.h"
 
 
 // para permitir que la key se pueda convertir a string
@@ -30,520 +45,2888 @@ std::string keyToString(const TK& key) {
 }
 
 
-template <typename TK>
-class BTree {
-private:
-  Node<TK>* root;
-  int M;  // grado u orden del arbol
+// valor de un BTree sin valores asociados (TV = void)
+struct SinValor {};
+
+
+// grado u orden del arbol: fijo en tiempo de compilacion (ORDEN > 0) o elegido al construir (ORDEN = 0)
+template <int ORDEN>
+struct OrdenArbol {
+    static_assert(ORDEN >= 3, "El grado del arbol debe de ser mínimo 3");
+    static constexpr int M = ORDEN;
+    static constexpr int minDegree = (M % 2 == 0) ? M / 2 : (M + 1) / 2;
+    static constexpr int minKeys = minDegree - 1;
+
+    OrdenArbol() = default;
+    explicit OrdenArbol(const int& M_) {
+        if (M_ != ORDEN)
+            throw std::invalid_argument("El grado no coincide con el orden del arbol");
+    }
+};
+
+template <>
+struct OrdenArbol<0> {
+    int M;
+    int minDegree;
+    int minKeys;
+
+    explicit OrdenArbol(const int& M_)
+        : M(M_), minDegree((M_ % 2 == 0) ? M_ / 2 : (M_ + 1) / 2), minKeys(minDegree - 1) {
+        if (M < 3)
+            throw std::out_of_range("El grado del arbol debe de ser mínimo 3");
+    }
+};
+
+// Contadores de lo que hacen insert/remove/search por dentro (ver BTree::counters). Solo se
+// compilan con -DBTREE_CONTADORES: sin el flag BTREE_CONTAR no genera codigo, el arbol no tiene
+// el miembro y counters() retorna todo en 0.
+struct ContadoresBTree {
+    std::uint64_t descensos = 0;          // bajadas desde la raiz (una por search/insert/remove)
+    std::uint64_t nodosVisitados = 0;     // nodos en los que se busco una key
+    std::uint64_t comparaciones = 0;      // comparaciones de keys dentro de los nodos
+    std::uint64_t splits = 0;
+    std::uint64_t merges = 0;
+    std::uint64_t rotacionesIzquierda = 0; // el nodo toma una key del hermano izquierdo
+    std::uint64_t rotacionesDerecha = 0;   // el nodo toma una key del hermano derecho
+    std::uint64_t cesiones = 0;            // un nodo lleno del borde reparte con su hermano en lugar de partirse
+    std::uint64_t crecimientosRaiz = 0;    // la altura sube en 1
+    std::uint64_t reduccionesRaiz = 0;     // la altura baja en 1
+    std::uint64_t nodosReservados = 0;
+    std::uint64_t nodosLiberados = 0;
+};
+
+#ifdef BTREE_CONTADORES
+#define BTREE_CONTAR(campo, cantidad) (this->contadores.campo += (cantidad))
+#else
+#define BTREE_CONTAR(campo, cantidad) ((void)0)
+#endif
+
+// Resultado de BTree::stats: se recorre el arbol completo, O(n)
+struct EstadisticasBTree {
+    struct Nivel {
+        std::size_t nodos = 0;
+        std::size_t keys = 0;
+        // llenado[d]: nodos con count / (M - 1) en [d / 10, (d + 1) / 10); los llenos van en llenado[9]
+        std::array<std::size_t, 10> llenado{};
+    };
+
+    int altura = 0;
+    std::size_t nodos = 0;
+    std::size_t keys = 0;
+    std::size_t bytesNodos = 0;      // bloques de los nodos del arbol
+    std::size_t bytesReservados = 0; // slabs pedidos por los pools (incluye bloques libres)
+    std::vector<Nivel> niveles;      // niveles[0] es la raiz, niveles[altura] las hojas
+};
+
+// Compare transparente: define is_transparent (std::less<>, std::greater<>, ...)
+template <typename Compare, typename = void>
+struct EsTransparente : std::false_type {};
+
+template <typename Compare>
+struct EsTransparente<Compare, std::void_t<typename Compare::is_transparent>> : std::true_type {};
+
+// TV != void guarda un valor por key en un array paralelo del nodo (ver BTreeMap en btreemap.h)
+// CONTEO = true mantiene el tamaño del subarbol de cada hijo para rank/select/count_range
+// Compare ordena las keys; si es transparente (std::less<>, o define is_transparent) las
+// busquedas aceptan cualquier tipo comparable con TK sin construir un TK
+template <typename TK, int ORDEN = 0, typename TV = void, bool CONTEO = false, typename Compare = std::less<TK>>
+class BTree : private OrdenArbol<ORDEN> {
+protected:
+  using OrdenArbol<ORDEN>::M;
+  using OrdenArbol<ORDEN>::minKeys;
+
+  // camino raiz-hoja: pares (puntero al nodo, posicion de busqueda), sin reservas en el heap
+  using Camino = PilaFija<Pair<Node<TK, ORDEN, TV, CONTEO>*, int>>;
+
+  // lotes mas chicos que esto siempre se insertan en el arbol existente
+  static constexpr std::size_t UMBRAL_LOTE_DENSO = 1024;
+
+  // busquedas que search_batch avanza intercaladas, nivel por nivel
+  static constexpr int BUSQUEDAS_EN_VUELO = 16;
+
+  // set_union/intersection/difference: pasos del iterador antes de buscar la siguiente key desde
+  // la raiz, y costos (en descensos) para elegir entre tramos, mezcla y una operacion por key
+  static constexpr int PASOS_ANTES_DE_BUSCAR = 4;
+  static constexpr long long COSTO_TRAMO = 12;
+  static constexpr long long KEYS_POR_DESCENSO = 6;
+
+  // maximo de lineas de cache que se precargan de un nodo
+  static constexpr std::size_t LINEAS_PRECARGA = 8;
+
+  // valor asociado a cada key; vacio si el arbol no guarda valores
+  using Valor = std::conditional_t<std::is_void_v<TV>, SinValor, TV>;
+
+  // las busquedas aceptan una key de tipo K si es TK o si Compare es transparente; las versiones
+  // con const TK& quedan para convertir a TK cuando no lo es (como en std::map)
+  template <typename K>
+  using SiBuscable = std::enable_if_t<std::is_same_v<K, TK> || EsTransparente<Compare>::value, int>;
+
+  Node<TK, ORDEN, TV, CONTEO>* root;
   int n; // total de elementos en el arbol 
+  bool unaPasada; // insert/remove de una sola bajada (ver set_single_pass)
+
+  // Dedo para inserts ascendentes: camino a la ultima hoja (la de la key maxima). Una key que cae
+  // en esa hoja se inserta sin bajar desde la raiz. forma cuenta los nodos reservados o liberados
+  // (solo asi cambia la forma del arbol): el dedo sirve mientras forma no cambie.
+  Camino dedo;
+  std::uint64_t forma;
+  std::uint64_t formaDedo;
+
+  // Bloques para hojas y nodos internos (en el orden dinamico tienen tamaños distintos).
+  // Se comparten con los snapshots y con los pedazos de split_at, que pueden vivir mas que el
+  // arbol y soltar nodos desde otro hilo: mientras los use mas de un arbol van con el mutex.
+  struct Estado {
+      NodePool poolHojas;
+      NodePool poolInternos;
+      std::mutex mutexPools;
+      std::atomic<int> arboles; // arboles vivos que usan el estado
+
+      Estado(const int& M, std::pmr::memory_resource* recurso)
+          : poolHojas(Node<TK, ORDEN, TV, CONTEO>::bytes(M, true), Node<TK, ORDEN, TV, CONTEO>::ALINEACION, recurso),
+            poolInternos(Node<TK, ORDEN, TV, CONTEO>::bytes(M, false), Node<TK, ORDEN, TV, CONTEO>::ALINEACION, recurso),
+            arboles(1) {}
+  };
+
+  std::shared_ptr<Estado> estado;
+  bool esSnapshot;
+  Compare comp;
+
+#ifdef BTREE_CONTADORES
+  // tambien se cuenta desde los metodos const. No son atomicos: con varios hilos leyendo el
+  // mismo arbol (un snapshot compartido) hay que compilar sin el flag.
+  mutable ContadoresBTree contadores;
+#endif
+
+public:
+
+    // los nodos se sacan de slabs pedidos a recurso, que debe vivir mas que el arbol
+    explicit BTree(const int& M_, std::pmr::memory_resource* recurso = std::pmr::get_default_resource(),
+                   const Compare& comp_ = Compare())
+        : OrdenArbol<ORDEN>(M_), root(nullptr), n(0), unaPasada(false), forma(0), formaDedo(0),
+          estado(std::make_shared<Estado>(M, recurso)), esSnapshot(false), comp(comp_) {}
+
+    explicit BTree(std::pmr::memory_resource* recurso = std::pmr::get_default_resource(),
+                   const Compare& comp_ = Compare())
+        : root(nullptr), n(0), unaPasada(false), forma(0), formaDedo(0),
+          estado(std::make_shared<Estado>(M, recurso)), esSnapshot(false), comp(comp_) {
+        static_assert(ORDEN != 0, "Un arbol de orden dinamico necesita el grado M");
+    }
+
+    BTree(const BTree&) = delete;
+    BTree& operator=(const BTree&) = delete;
+
+
+
+
+    bool search(const TK &key) const {
+        return search<TK>(key);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    bool search(const K& key) const {
+        BTREE_CONTAR(descensos, 1);
+        Node<TK, ORDEN, TV, CONTEO> *current = root;
+        while (current != nullptr) {
+            int i = buscarEnNodo(current, key);
+            if (i < current->count && !comp(key, current->keys[i]))
+                return true;
+            current = current->leaf ? nullptr : current->children[i];
+        }
+        return false;
+    }
+
+    // Busca las keys de [begin, end) (iterador de acceso aleatorio): encontradas[i] = search(begin[i]).
+    // Avanza BUSQUEDAS_EN_VUELO busquedas a la vez, un nivel por vuelta, y precarga el hijo al que
+    // baja cada una: mientras llega ese nodo se trabaja con las otras, asi los fallos de cache de
+    // distintas keys se solapan en lugar de esperarse uno tras otro.
+    template <typename It>
+    void search_batch(It begin, It end, std::vector<bool>& encontradas) const {
+        const std::size_t cantidad = std::distance(begin, end);
+        encontradas.assign(cantidad, false);
+        if (root == nullptr)
+            return;
+        Node<TK, ORDEN, TV, CONTEO>* actual[BUSQUEDAS_EN_VUELO];
+        for (std::size_t base = 0; base < cantidad; base += BUSQUEDAS_EN_VUELO) {
+            const int grupo = static_cast<int>(std::min<std::size_t>(BUSQUEDAS_EN_VUELO, cantidad - base));
+            for (int j = 0; j < grupo; ++j)
+                actual[j] = root;
+            BTREE_CONTAR(descensos, grupo);
+            for (int activas = grupo; activas > 0;) {
+                for (int j = 0; j < grupo; ++j) {
+                    Node<TK, ORDEN, TV, CONTEO>* node = actual[j];
+                    if (node == nullptr)
+                        continue;
+                    const TK& key = begin[base + j];
+                    int i = buscarEnNodo(node, key);
+                    if (i < node->count && !comp(key, node->keys[i])) {
+                        encontradas[base + j] = true;
+                        actual[j] = nullptr;
+                        --activas;
+                    } else if (node->leaf) {
+                        actual[j] = nullptr;
+                        --activas;
+                    } else {
+                        actual[j] = node->children[i];
+                        precargar(actual[j]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Igual que search_batch para un lote ordenado (ascendente): las keys consecutivas comparten
+    // el camino desde la raiz, como en insert_sorted_batch; mientras caen en la misma hoja solo
+    // se busca en ella, y si no se sube hasta el ancestro cuyo rango contiene la key.
+    template <typename It>
+    void search_sorted_batch(It begin, It end, std::vector<bool>& encontradas) const {
+        encontradas.assign(std::distance(begin, end), false);
+        if (root == nullptr)
+            return;
+        Camino pila;
+        TK limite = TK();
+        bool hayLimite = false;
+        for (std::size_t k = 0; begin != end; ++begin, ++k) {
+            const TK& key = *begin;
+            if (pila.is_empty() || (hayLimite && !comp(key, limite))) {
+                encontradas[k] = !reubicarCamino(key, pila);
+                if (!pila.top().first->leaf) { // estaba en un nodo interno
+                    pila.clear();
+                    continue;
+                }
+                hayLimite = limiteDeHoja(pila, limite);
+            } else { // sigue en la misma hoja
+                Node<TK, ORDEN, TV, CONTEO>* hoja = pila.top().first;
+                int i = buscarEnNodo(hoja, key);
+                encontradas[k] = i < hoja->count && !comp(key, hoja->keys[i]);
+            }
+        }
+    }
+
+    void insert(const TK &key) {
+        insertar(key);
+    }
+
+    // la key se mueve al arbol (sin copiarla); sirve para keys que no se pueden copiar
+    void insert(TK&& key) {
+        insertar(std::move(key));
+    }
+
+    // construye la key con args y la mueve al arbol
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        insertar(TK(std::forward<Args>(args)...));
+    }
+
+    // la key no se copia: no debe ser una referencia a una key del propio arbol, que se mueven al rebalancear
+    void remove(const TK& key) {
+        if (unaPasada) {
+            removerUnaPasada(key);
+            return;
+        }
+        Camino pila; // almacena los pares (puntero al nodo y posicion de busqueda)
+        bool existe = findPathToKey(key, pila);
+        if (!existe)
+            return; // no existe la key
+
+        asegurarCamino(pila); // copy-on-write si hay snapshots
+        Node<TK, ORDEN, TV, CONTEO>* current = pila.top().first;
+        int index = pila.top().second;
+
+        if (!current->leaf) {
+            int successorIndex = successor(pila); // la pila tambien tiene el nodo del succesor en este caso
+            asegurarCamino(pila);
+            moverClave(current, index, pila.top().first, successorIndex); // reemplazar por sucesor
+            // actualizar nuevo a eliminar, el sucesor siempre es una hoja
+            current = pila.top().first;
+            index = successorIndex;
+        }
+        removeKeyFromLeaf(current, index);
+        sumarEnCamino(pila, -1);
+
+        if (current == root) {
+            if (current->count == 0) {
+                liberarNodo(root);
+                root = nullptr;
+                BTREE_CONTAR(reduccionesRaiz, 1);
+            }
+            --n;
+            return;
+        }
+
+        while (current->count < minKeys) {
+            pila.pop();
+            Node<TK, ORDEN, TV, CONTEO>* parentNode = pila.top().first;
+            int parentChildIndex = pila.top().second;
+
+            if (parentChildIndex != parentNode->count
+                && parentNode->children[parentChildIndex + 1]->count > minKeys) { // si el hermano derecho tiene suficiente keys
+                unico(parentNode->children[parentChildIndex + 1]);
+                rotate(current, parentNode, parentChildIndex, false);
+            } else if (parentChildIndex != 0
+                       && parentNode->children[parentChildIndex -1]->count > minKeys) { // si el hermano izquierdo tiene suficiente keys
+                unico(parentNode->children[parentChildIndex - 1]);
+                rotate(current, parentNode, parentChildIndex, true);
+            } else if (parentChildIndex != parentNode->count) { // merge con el hermano derecho
+                unico(parentNode->children[parentChildIndex + 1]);
+                merge(current, parentNode, parentChildIndex, false);
+                if (parentNode == root) {
+                    if (parentNode->count == 0) { // caso donde la raiz se queda sin keys
+                        // eliminando root
+                        root->children[0]  = nullptr;
+                        limpiarClave(root, 0);
+                        liberarNodo(root);
+                        root = current;
+                        BTREE_CONTAR(reduccionesRaiz, 1);
+                    }
+                    break;
+
+                } else {
+                    current = parentNode;
+                }
+            } else { // merge con el hermano izquierdo
+                unico(parentNode->children[parentChildIndex - 1]);
+                merge(current, parentNode, parentChildIndex, true);
+                if (parentNode == root) {
+                    if (parentNode->count == 0) { // caso donde la raiz se queda sin keys
+                        Node<TK, ORDEN, TV, CONTEO>* sibling = parentNode->children[parentChildIndex - 1];
+                        // eliminando root
+                        root->children[0] = nullptr;
+                        limpiarClave(root, 0);
+                        liberarNodo(root);
+                        root = sibling;
+                        BTREE_CONTAR(reduccionesRaiz, 1);
+                    }
+                    break;
+                } else {
+                    current = parentNode;
+                }
+            }
+        }
+        --n;
+    }
+//elimina un elemento
+    int height() const {
+        if (root == nullptr)
+            return 0; // no estoy de acuerdo, pero creo que decia eso en las indicaciones. Caso contrario la altura es -1 de un arbol vacio
+
+        Node<TK, ORDEN, TV, CONTEO> *current = root;
+        int height = 0;
+
+        while (true) {
+            if (current->leaf)
+                return height;
+            current = current->children[0];
+            ++height;
+        }
+    }//altura del arbol. Considerar altura 0 para arbol vacio
+    std::string toString(const std::string &sep = " ") const {
+        std::string result;
+        toString(root, result, sep);
+        return result;
+    } // recorrido inorder
+    std::vector<TK> rangeSearch(const TK& begin,const TK& end) const {
+        return rangeSearch<TK>(begin, end);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    std::vector<TK> rangeSearch(const K& begin, const K& end) const {
+        std::vector<TK> result;
+        if (root == nullptr) // con end < begin rangeSearchRec no encuentra keys
+            return result;
+        BTREE_CONTAR(descensos, 1);
+        rangeSearchRec(root, begin, end, result);
+        return result;
+    }
+
+    TK minKey() const {
+        if (root == nullptr)
+            throw std::runtime_error("Arbol vacio");
+
+        Node<TK, ORDEN, TV, CONTEO> *current = root;
+        while (true) {
+            if (current->leaf)
+                return current->keys[0];
+            current = current->children[0];
+        }
+    }// minimo valor de la llave en el arbol
+    TK maxKey() const {
+        if (root == nullptr)
+            throw std::runtime_error("Arbol vacio");
+
+        Node<TK, ORDEN, TV, CONTEO> *current = root;
+        while (true) {
+            if (current->leaf)
+                return current->keys[current->count - 1];
+            current = current->children[current->count];
+        }
+    }// maximo valor de la llave en el arbol
+    void clear() {
+        if (hayCompartidos()) {
+            // puede haber nodos compartidos con snapshots (o pools con otro pedazo de split_at):
+            // solo se sueltan las referencias propias
+            if (root != nullptr)
+                soltar(root);
+        } else {
+            if constexpr (!std::is_trivially_destructible_v<TK> || !std::is_trivially_destructible_v<Valor>) {
+                if (root != nullptr)
+                    destruirSubarbol(root);
+            }
+            // todos los nodos salen de los pools: se devuelven los slabs completos
+            estado->poolHojas.liberarTodo();
+            estado->poolInternos.liberarTodo();
+        }
+        root = nullptr;
+        n = 0;
+        ++forma; // los slabs se liberan sin pasar por liberarNodo
+        dedo.clear();
+    }// eliminar todos lo elementos del arbol
+    const int& size() const {
+        return n;
+    }// retorna el total de elementos insertados
+
+    // Construya un árbol B a partir de un vector de elementos ordenados
+    static BTree* build_from_ordered_vector(std::vector<TK> &elements, const int& M,
+                                            std::pmr::memory_resource* recurso = std::pmr::get_default_resource()) {
+        BTree* btree = new BTree(M, recurso);
+        btree->construir(elements);
+        return btree;
+    }
+
+    static BTree* build_from_ordered_vector(std::vector<TK> &elements,
+                                            std::pmr::memory_resource* recurso = std::pmr::get_default_resource()) {
+        static_assert(ORDEN != 0, "Un arbol de orden dinamico necesita el grado M");
+        return build_from_ordered_vector(elements, ORDEN, recurso);
+    }
+
+    // Carga masiva en paralelo, de las hojas hacia la raiz. En cada nivel la cantidad de keys de
+    // cada nodo sale de una formula cerrada (ver Reparto), asi cada hilo llena su rango de nodos sin
+    // coordinarse con los demas. llenado en (0, 1] es la fraccion de las M-1 keys que recibe cada
+    // nodo (deja espacio para inserciones futuras), sin bajar del minimo de un arbol B.
+    // Los bloques se piden a los pools en un solo hilo; construir y llenar los nodos es paralelo.
+    static BTree* build_from_ordered_vector_parallel(const std::vector<TK>& elements, const int& M,
+                                                     unsigned hilos = std::thread::hardware_concurrency(),
+                                                     double llenado = 1.0,
+                                                     std::pmr::memory_resource* recurso = std::pmr::get_default_resource()) {
+        if (!(llenado > 0 && llenado <= 1))
+            throw std::invalid_argument("El llenado debe estar en (0, 1]");
+        BTree* btree = new BTree(M, recurso);
+        btree->construirParalelo(elements, nullptr, hilos, llenado);
+        return btree;
+    }
+
+    // Inserta un lote ordenado de keys (ascendente; las repetidas se ignoran).
+    // Las keys consecutivas que caen en la misma hoja se insertan sin volver a bajar desde la raiz:
+    // se reusa el camino anterior y solo se sube hasta el ancestro cuyo rango contiene la key.
+    // Si el lote es denso respecto al arbol se mezcla todo y se reconstruye (solo sin valores).
+    template <typename It>
+    void insert_sorted_batch(It begin, It end) {
+        if constexpr (std::is_void_v<TV>) {
+            std::size_t cantidad = std::distance(begin, end);
+            if (cantidad >= UMBRAL_LOTE_DENSO && cantidad * 4 >= static_cast<std::size_t>(n)) {
+                mezclarYReconstruir(begin, end);
+                return;
+            }
+        }
+
+        Camino pila;
+        TK limite = TK(); // primera key de un ancestro mayor a todas las keys de la hoja actual
+        bool hayLimite = false;
+
+        for (; begin != end; ++begin) {
+            const TK& key = *begin;
+            if (root == nullptr) {
+                insertarEnCamino(pila, key, Valor());
+                continue;
+            }
+            if (pila.is_empty() || (hayLimite && !comp(key, limite))) {
+                if (!reubicarCamino(key, pila)) { // ya existe
+                    pila.clear();
+                    continue;
+                }
+                asegurarCamino(pila);
+                hayLimite = limiteDeHoja(pila, limite);
+            } else { // sigue en la misma hoja
+                Node<TK, ORDEN, TV, CONTEO>* hoja = pila.top().first;
+                int i = buscarEnNodo(hoja, key);
+                if (i < hoja->count && !comp(key, hoja->keys[i]))
+                    continue; // ya existe
+                pila.top().second = i;
+            }
+
+            Node<TK, ORDEN, TV, CONTEO>* hoja = pila.top().first;
+            if (hoja->count < M - 1) {
+                insertIntoNode(hoja, pila.top().second, key, Valor(), nullptr);
+                sumarEnCamino(pila, 1);
+                ++n;
+            } else { // la hoja se parte: el camino deja de ser valido
+                insertarEnCamino(pila, key, Valor());
+                pila.clear();
+            }
+        }
+    }
+
+    // Elimina las keys de [begin, end] y retorna cuantas habia. Si el rango cae en una sola hoja que
+    // no baja del minimo se borra ahi de una vez. Si no, el arbol se parte en las keys menores a
+    // begin, las de [begin, end] y las mayores a end: el pedazo del medio se suelta entero y los otros
+    // dos se unen. Solo se tocan los caminos de los dos bordes: O(log n + nodos liberados).
+    int remove_range(const TK& begin, const TK& end) {
+        if (root == nullptr || comp(end, begin))
+            return 0;
+        Camino pila;
+        findPathToKey(begin, pila);
+        Node<TK, ORDEN, TV, CONTEO>* hoja = pila.top().first;
+        if (hoja->leaf) {
+            const int i = pila.top().second;
+            int j = buscarEnNodo(hoja, end);
+            if (j < hoja->count && !comp(end, hoja->keys[j]))
+                ++j;
+            const TK* limite = separadorDerecho(pila);
+            if (j < hoja->count || limite == nullptr || comp(end, *limite)) { // el rango no sale de la hoja
+                if (j > i) {
+                    asegurarCamino(pila);
+                    hoja = pila.top().first;
+                    moverClaves(hoja, i, hoja, j, hoja->count);
+                    for (int c = hoja->count - (j - i); c < hoja->count; ++c)
+                        limpiarClave(hoja, c);
+                    hoja->count -= j - i;
+                    sumarEnCamino(pila, -(j - i));
+                    n -= j - i;
+                    completarCamino(pila);
+                }
+                return j - i;
+            }
+        }
+
+        ++forma; // los pedazos reusan nodos: el dedo puede quedar apuntando a uno que ya no es la ultima hoja
+        Pair<Subarbol, Subarbol> menores = partir(desprender(), begin, false);
+        Pair<Subarbol, Subarbol> medio = partir(menores.second, end, true);
+        const int eliminadas = contarKeys(medio.first.raiz);
+        if (medio.first.raiz != nullptr)
+            soltar(medio.first.raiz);
+        root = concatenar(menores.first, medio.second).raiz;
+        n -= eliminadas;
+        return eliminadas;
+    }
+
+    // Elimina un lote ordenado de keys (ascendente; las que no estan se ignoran), pensado para borrados
+    // dispersos. Como en insert_sorted_batch se reusa el camino: las keys que caen en la misma hoja se
+    // borran ahi sin volver a bajar; si la hoja queda corta se completa subiendo por el camino.
+    template <typename It>
+    void remove_sorted_batch(It begin, It end) {
+        Camino pila;
+        TK limite = TK(); // primera key de un ancestro mayor a todas las keys de la hoja actual
+        bool hayLimite = false;
+
+        for (; begin != end && root != nullptr; ++begin) {
+            const TK& key = *begin;
+            if (pila.is_empty() || (hayLimite && !comp(key, limite))) {
+                bool falta = reubicarCamino(key, pila);
+                if (!pila.top().first->leaf) { // esta en un nodo interno
+                    remove(key);
+                    pila.clear();
+                    continue;
+                }
+                hayLimite = limiteDeHoja(pila, limite);
+                if (falta)
+                    continue;
+            } else { // sigue en la misma hoja
+                Node<TK, ORDEN, TV, CONTEO>* hoja = pila.top().first;
+                int i = buscarEnNodo(hoja, key);
+                if (i == hoja->count || comp(key, hoja->keys[i]))
+                    continue; // no esta
+                pila.top().second = i;
+            }
+
+            asegurarCamino(pila);
+            Node<TK, ORDEN, TV, CONTEO>* hoja = pila.top().first;
+            removeKeyFromLeaf(hoja, pila.top().second);
+            sumarEnCamino(pila, -1);
+            --n;
+            if (hoja != root && hoja->count < minKeys) { // al completarla cambian los nodos del camino
+                completarCamino(pila);
+                pila.clear();
+            }
+        }
+    }
+
+    // Deja en este arbol las keys menores a key y retorna un arbol nuevo con las demas (hay que
+    // liberarlo con delete, como los de build_from_ordered_vector). Solo se parten los nodos del
+    // camino de key: O(log n), mas recorrer el pedazo mas chico para contar sus keys si no hay
+    // CONTEO. El arbol nuevo usa los mismos pools que este (con el mutex, como los snapshots), asi
+    // cada pedazo se puede pasar a otro hilo. BTreeMap lo oculta con uno que retorna un BTreeMap.
+    BTree* split_at(const TK& key) {
+        BTree* derecho = new BTree(*this, DePedazo());
+        partirEn(key, *derecho);
+        return derecho;
+    }
+
+    // Pasa a este arbol todas las keys de otro, que deben ser mayores a las de este (si no lanza
+    // invalid_argument), y deja otro vacio. Los nodos de otro se reusan: el mas bajo de los dos se
+    // cuelga del borde del otro a su altura, O(log n). Si los pools de otro los usa otro arbol (un
+    // snapshot u otro pedazo que no es este) o tienen otro memory_resource, no se pueden pasar:
+    // sus keys se mueven una por una al final de este.
+    void join(BTree& otro) {
+        if (&otro == this || otro.root == nullptr)
+            return;
+        if (otro.M != M)
+            throw std::invalid_argument("Los arboles tienen distinto grado");
+        if (root != nullptr && !comp(ultimaKey(root), primeraKey(otro.root)))
+            throw std::invalid_argument("Las keys del arbol que se une deben ser mayores");
+        ++forma;
+        ++otro.forma;
+        if (puedeAdoptar(otro)) {
+            adoptarNodos(otro);
+            root = concatenar(desprender(), otro.desprender()).raiz;
+            n += otro.n;
+            otro.n = 0;
+        } else {
+            auto agregar = [this](TK&& key, Valor&& valor) { agregarAlFinal(std::move(key), std::move(valor)); };
+            vaciarSubarbol(otro.root, true, agregar);
+            otro.clear();
+        }
+    }
+
+    // Operaciones de conjuntos con otro arbol del mismo grado; el resultado queda en este arbol y
+    // las keys que estan en los dos conservan el valor de este. Las keys de los dos arboles se
+    // recorren por tramos (ver contarTramos): cada tramo se corta entero con partir y se une al
+    // resultado con concatenar, sin mirar sus keys una por una, asi con arboles casi disjuntos el
+    // costo es O(tramos * log n). Si los tramos son muchos (keys muy intercaladas) se elige lo mas
+    // barato entre eso, mezclar las keys y reconstruir, u operar key por key.
+
+    // union: pasa a este arbol las keys de otro que no tiene; otro queda vacio
+    void set_union(BTree& otro) {
+        if (&otro == this || otro.root == nullptr)
+            return;
+        if (otro.M != M)
+            throw std::invalid_argument("Los arboles tienen distinto grado");
+        switch (elegirEstrategia(otro, puedeAdoptar(otro), otro.n)) {
+        case Estrategia::Tramos: {
+            ++forma;
+            ++otro.forma;
+            adoptarNodos(otro);
+            Subarbol a = desprender();
+            Subarbol b = otro.desprender();
+            Subarbol resultado{nullptr, -1};
+            int repetidas = 0;
+            while (a.altura >= 0 && b.altura >= 0) {
+                const TK& primeraA = primeraKey(a.raiz);
+                const TK& primeraB = primeraKey(b.raiz);
+                if (comp(primeraA, primeraB)) {
+                    Pair<Subarbol, Subarbol> pedazos = partir(a, primeraB, false);
+                    resultado = concatenar(resultado, pedazos.first);
+                    a = pedazos.second;
+                } else if (comp(primeraB, primeraA)) {
+                    Pair<Subarbol, Subarbol> pedazos = partir(b, primeraA, false);
+                    resultado = concatenar(resultado, pedazos.first);
+                    b = pedazos.second;
+                } else { // corrida de keys repetidas: quedan las de a
+                    iterator itA = inicioDe(a.raiz);
+                    iterator itB = inicioDe(b.raiz);
+                    const TK* ultimaA = nullptr;
+                    const TK* ultimaB = nullptr;
+                    repetidas += corridaComun(itA, iterator(a.raiz), itB, iterator(b.raiz), ultimaA, ultimaB);
+                    Pair<Subarbol, Subarbol> pedazosB = partir(b, *ultimaB, true);
+                    soltar(pedazosB.first.raiz);
+                    b = pedazosB.second;
+                    Pair<Subarbol, Subarbol> pedazosA = partir(a, *ultimaA, true);
+                    resultado = concatenar(resultado, pedazosA.first);
+                    a = pedazosA.second;
+                }
+            }
+            root = concatenar(resultado, a.altura >= 0 ? a : b).raiz;
+            n += otro.n - repetidas;
+            otro.n = 0;
+            break;
+        }
+        case Estrategia::Mezcla:
+            mezclar(otro, [](bool enEste, bool enOtro) { return enEste || enOtro; });
+            otro.clear();
+            break;
+        case Estrategia::PorKey: {
+            auto insertarNueva = [this](TK&& key, Valor&& valor) {
+                Camino pila;
+                if (!findPathToKey(key, pila))
+                    insertarEnCamino(pila, std::move(key), std::move(valor));
+            };
+            vaciarSubarbol(otro.root, true, insertarNueva);
+            otro.clear();
+            break;
+        }
+        }
+    }
+
+    // interseccion: deja en este arbol solo las keys que tambien estan en otro
+    void set_intersection(const BTree& otro) {
+        if (root == nullptr || &otro == this)
+            return;
+        if (otro.root == nullptr) {
+            clear();
+            return;
+        }
+        if (elegirEstrategia(otro, true, -1) == Estrategia::Tramos)
+            filtrarPorTramos(otro, true);
+        else
+            mezclar(otro, [](bool enEste, bool enOtro) { return enEste && enOtro; });
+    }
+
+    // diferencia: saca de este arbol las keys que estan en otro
+    void set_difference(const BTree& otro) {
+        if (root == nullptr || otro.root == nullptr)
+            return;
+        if (&otro == this) {
+            clear();
+            return;
+        }
+        switch (elegirEstrategia(otro, true, otro.n)) {
+        case Estrategia::Tramos:
+            filtrarPorTramos(otro, false);
+            break;
+        case Estrategia::Mezcla:
+            mezclar(otro, [](bool enEste, bool enOtro) { return enEste && !enOtro; });
+            break;
+        case Estrategia::PorKey:
+            for (iterator it = otro.lower_bound(primeraKey(root)); it != otro.end() && root != nullptr
+                                                                    && !comp(ultimaKey(root), *it); ++it)
+                remove(*it);
+            break;
+        }
+    }
+
+    // Estadisticas de orden (necesitan CONTEO = true): cada nodo interno sabe cuantas keys tiene
+    // cada hijo, asi se baja una sola vez sumando conteos en lugar de recorrer el rango.
+
+    // cantidad de keys menores que key
+    int rank(const TK& key) const {
+        return contarHasta(key, false);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    int rank(const K& key) const {
+        return contarHasta(key, false);
+    }
+
+    // k-esima key mas chica, desde 0
+    TK select(int k) const {
+        static_assert(CONTEO, "select necesita un arbol con CONTEO = true");
+        if (k < 0 || k >= n)
+            throw std::out_of_range("Posicion fuera del arbol");
+        BTREE_CONTAR(descensos, 1);
+        Node<TK, ORDEN, TV, CONTEO>* node = root;
+        while (!node->leaf) {
+            BTREE_CONTAR(nodosVisitados, 1);
+            int i = 0;
+            for (; i < node->count; ++i) {
+                if (k < node->conteos[i])
+                    break;
+                if (k == node->conteos[i])
+                    return node->keys[i];
+                k -= node->conteos[i] + 1;
+            }
+            node = node->children[i];
+        }
+        return node->keys[k];
+    }
+
+    // cantidad de keys en [begin, end]
+    int count_range(const TK& begin, const TK& end) const {
+        return count_range<TK>(begin, end);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    int count_range(const K& begin, const K& end) const {
+        return std::max(0, contarHasta(end, true) - contarHasta(begin, false)); // 0 si end < begin
+    }
+
+    // mediana (la menor de las dos del medio si n es par)
+    TK median() const {
+        return select((n - 1) / 2);
+    }
+
+    // percentil por rango mas cercano, p en [0, 1]: la menor key con al menos p * n keys <= ella
+    TK percentile(double p) const {
+        if (!(p >= 0 && p <= 1))
+            throw std::invalid_argument("El percentil debe estar en [0, 1]");
+        if (n == 0) // sin keys el clamp quedaria con limite superior -1
+            throw std::out_of_range("Posicion fuera del arbol");
+        int k = static_cast<int>(std::ceil(p * n)) - 1;
+        return select(std::clamp(k, 0, n - 1));
+    }
+
+    // Guarda las keys (y valores) en orden con el formato binario de serializador.h; las keys
+    // de cada hoja se escriben de una vez con Serializador<TK>. El formato no depende de M.
+    void save(std::ostream& os) const {
+        serializacion::Cabecera cabecera{serializacion::MAGICO, serializacion::VERSION,
+                                         static_cast<std::uint32_t>(sizeof(TK)),
+                                         static_cast<std::uint32_t>(TamValor<TV>::bytes), 0,
+                                         static_cast<std::uint64_t>(n)};
+        os.write(reinterpret_cast<const char*>(&cabecera), sizeof(cabecera));
+        if (root != nullptr) {
+            guardarKeys(root, os);
+            if constexpr (!std::is_void_v<TV>)
+                guardarValores(root, os);
+        }
+        if (!os)
+            throw std::runtime_error("Error escribiendo el arbol");
+    }
+
+    // Reemplaza el contenido por el guardado con save: lee las keys en un vector y arma el arbol
+    // de una pasada con la carga masiva (sin inserts), con los nodos llenos.
+    void load(std::istream& is, unsigned hilos = std::thread::hardware_concurrency()) {
+        serializacion::Cabecera cabecera;
+        is.read(reinterpret_cast<char*>(&cabecera), sizeof(cabecera));
+        if (!is || cabecera.magico != serializacion::MAGICO)
+            throw std::runtime_error("No es un arbol guardado con save");
+        if (cabecera.version != serializacion::VERSION)
+            throw std::runtime_error("Version de formato no soportada");
+        if (cabecera.bytesKey != sizeof(TK) || cabecera.bytesValor != TamValor<TV>::bytes)
+            throw std::runtime_error("El archivo guarda otro tipo de key o valor");
+        if (cabecera.n > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+            throw std::runtime_error("Demasiadas keys");
+
+        std::vector<TK> elements(cabecera.n);
+        Serializador<TK>::leer(is, elements.data(), elements.size());
+        std::vector<Valor> valores;
+        if constexpr (!std::is_void_v<TV>) {
+            valores.resize(cabecera.n);
+            Serializador<TV>::leer(is, valores.data(), valores.size());
+        }
+        if (!is)
+            throw std::runtime_error("Archivo incompleto");
+        for (std::size_t i = 1; i < elements.size(); ++i) {
+            if (!comp(elements[i - 1], elements[i]))
+                throw std::runtime_error("Las keys guardadas no estan ordenadas");
+        }
+
+        clear();
+        construirParalelo(elements, valores.empty() ? nullptr : valores.data(), hilos, 1.0);
+    }
+
+    // Vista de solo lectura del arbol en este momento, en O(1): comparte la raiz y los nodos llevan
+    // un contador de referencias. Los insert/remove posteriores copian solo los nodos del camino que
+    // modifican (path copying), asi el snapshot se puede leer desde otro hilo mientras este arbol
+    // sigue cambiando. El snapshot puede vivir mas que el arbol.
+    std::shared_ptr<const BTree> snapshot() const {
+        static_assert(std::is_copy_assignable_v<TK> && std::is_copy_assignable_v<Valor>,
+                      "snapshot() copia los nodos compartidos: necesita keys y valores copiables");
+        return std::shared_ptr<const BTree>(new BTree(*this, DeSnapshot()));
+    }
+
+    // Modo de una sola pasada para insert/remove: al bajar se parten los nodos llenos y se
+    // completan (rotate/merge) los que estan en el minimo, asi nunca hay que volver a subir y
+    // cada nodo del camino se toca una vez. Necesita M par: un nodo lleno (M-1 keys) se parte en
+    // dos nodos minimos mas la mediana, y dos nodos minimos mas el separador caben en uno.
+    void set_single_pass(bool activo) {
+        if (activo && M % 2 != 0)
+            throw std::invalid_argument("El modo de una pasada necesita un grado par");
+        unaPasada = activo;
+    }
+
+    bool single_pass() const {
+        return unaPasada;
+    }
+
+    // Verifique las propiedades de un árbol B
+    bool check_properties() const {
+        if constexpr (CONTEO) {
+            if (root != nullptr && contarSubarbol(root) != n)
+                return false;
+        }
+        return check_properties_rec(root).valid;
+    }
+    bool empty() const {
+        return root == nullptr;
+    }
+
+    // contadores acumulados desde la creacion o el ultimo reset_counters (todo 0 si no se
+    // compilo con -DBTREE_CONTADORES)
+    ContadoresBTree counters() const {
+#ifdef BTREE_CONTADORES
+        return contadores;
+#else
+        return ContadoresBTree();
+#endif
+    }
+
+    void reset_counters() {
+#ifdef BTREE_CONTADORES
+        contadores = ContadoresBTree();
+#endif
+    }
+
+    // Recorre el arbol (como check_properties) y reporta altura, nodos, bytes y el histograma
+    // de llenado de los nodos de cada nivel
+    EstadisticasBTree stats() const {
+        EstadisticasBTree resultado;
+        resultado.altura = height();
+        resultado.niveles.resize(root == nullptr ? 0 : resultado.altura + 1);
+        estadisticasRec(root, 0, resultado);
+        std::unique_lock<std::mutex> guard(estado->mutexPools, std::defer_lock);
+        if (hayCompartidos())
+            guard.lock();
+        resultado.bytesReservados = estado->poolHojas.bytesReservados() + estado->poolInternos.bytesReservados();
+        return resultado;
+    }
+
+    // -------------------- iteradores ---------------
+
+    // Iterador bidireccional en orden. Guarda el camino desde la raiz (O(altura) de memoria):
+    // el tope es (nodo, indice de la key actual) y cada ancestro es (nodo, indice del hijo por
+    // el que se bajo), igual que la pila que usa successor. Camino vacio = end().
+    // Cualquier insert/remove/clear invalida los iteradores.
+    class iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = TK;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const TK*;
+        using reference = const TK&;
+
+        iterator() : raiz(nullptr) {}
+
+        reference operator*() const {
+            return camino.top().first->keys[camino.top().second];
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+
+        // valor asociado a la key actual (solo si el arbol guarda valores)
+        template <typename V = TV>
+        const V& value() const {
+            return camino.top().first->values[camino.top().second];
+        }
+
+        iterator& operator++() {
+            avanzar();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator copia = *this;
+            avanzar();
+            return copia;
+        }
+
+        iterator& operator--() {
+            retroceder();
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator copia = *this;
+            retroceder();
+            return copia;
+        }
+
+        bool operator==(const iterator& otro) const {
+            if (camino.is_empty() || otro.camino.is_empty())
+                return camino.is_empty() && otro.camino.is_empty();
+            return camino.top().first == otro.camino.top().first
+                   && camino.top().second == otro.camino.top().second;
+        }
+
+        bool operator!=(const iterator& otro) const {
+            return !(*this == otro);
+        }
+
+    private:
+        friend class BTree;
+
+        // la altura es menor a 32 porque n es int y cada nodo interno tiene al menos 2 hijos
+        PilaFija<Pair<Node<TK, ORDEN, TV, CONTEO>*, int>, 32> camino;
+        Node<TK, ORDEN, TV, CONTEO>* raiz; // para poder retroceder desde end()
+
+        explicit iterator(Node<TK, ORDEN, TV, CONTEO>* const& raiz_) : raiz(raiz_) {}
+
+        void bajarIzquierda(Node<TK, ORDEN, TV, CONTEO>* node) {
+            while (!node->leaf) {
+                camino.push({node, 0});
+                node = node->children[0];
+            }
+            camino.push({node, 0});
+        }
+
+        void bajarDerecha(Node<TK, ORDEN, TV, CONTEO>* node) {
+            while (!node->leaf) {
+                camino.push({node, node->count});
+                node = node->children[node->count];
+            }
+            camino.push({node, node->count - 1});
+        }
+
+        // sube mientras el ancestro ya no tenga keys a la derecha del hijo por el que se bajo
+        void subirHastaSiguiente() {
+            while (!camino.is_empty() && camino.top().second == camino.top().first->count)
+                camino.pop();
+        }
+
+        void avanzar() {
+            Pair<Node<TK, ORDEN, TV, CONTEO>*, int>& tope = camino.top();
+            if (!tope.first->leaf) { // el sucesor es el minimo del hijo derecho
+                ++tope.second;
+                bajarIzquierda(tope.first->children[tope.second]);
+            } else if (tope.second + 1 < tope.first->count) {
+                ++tope.second;
+            } else { // el sucesor esta en un ancestro
+                camino.pop();
+                subirHastaSiguiente();
+            }
+        }
+
+        void retroceder() {
+            if (camino.is_empty()) { // --end() es el maximo
+                if (raiz != nullptr)
+                    bajarDerecha(raiz);
+                return;
+            }
+            Pair<Node<TK, ORDEN, TV, CONTEO>*, int>& tope = camino.top();
+            if (!tope.first->leaf) { // el antecesor es el maximo del hijo izquierdo
+                bajarDerecha(tope.first->children[tope.second]);
+            } else if (tope.second > 0) {
+                --tope.second;
+            } else {
+                camino.pop();
+                while (!camino.is_empty() && camino.top().second == 0)
+                    camino.pop();
+                if (!camino.is_empty())
+                    --camino.top().second;
+            }
+        }
+    };
+
+    using const_iterator = iterator;
+
+    iterator begin() const {
+        iterator it(root);
+        if (root != nullptr)
+            it.bajarIzquierda(root);
+        return it;
+    }
+
+    iterator end() const {
+        return iterator(root);
+    }
+
+    // primera key >= key
+    iterator lower_bound(const TK& key) const {
+        return lower_bound<TK>(key);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    iterator lower_bound(const K& key) const {
+        BTREE_CONTAR(descensos, 1);
+        iterator it(root);
+        Node<TK, ORDEN, TV, CONTEO>* current = root;
+        while (current != nullptr) {
+            int i = buscarEnNodo(current, key);
+            if (i < current->count && (current->leaf || !comp(key, current->keys[i]))) {
+                it.camino.push({current, i});
+                return it;
+            }
+            if (current->leaf) { // todas las keys de la hoja son menores
+                it.subirHastaSiguiente();
+                return it;
+            }
+            it.camino.push({current, i});
+            current = current->children[i];
+        }
+        return it;
+    }
+
+    // primera key > key
+    iterator upper_bound(const TK& key) const {
+        return upper_bound<TK>(key);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    iterator upper_bound(const K& key) const {
+        iterator it = lower_bound(key);
+        if (it != end() && !comp(key, *it))
+            ++it;
+        return it;
+    }
+
+    Pair<iterator, iterator> equal_range(const TK& key) const {
+        return equal_range<TK>(key);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    Pair<iterator, iterator> equal_range(const K& key) const {
+        iterator primero = lower_bound(key);
+        iterator ultimo = primero;
+        if (ultimo != end() && !comp(key, *ultimo))
+            ++ultimo;
+        return {primero, ultimo};
+    }
+
+    iterator find(const TK& key) const {
+        return find<TK>(key);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    iterator find(const K& key) const {
+        iterator it = lower_bound(key);
+        if (it != end() && comp(key, *it))
+            return end();
+        return it;
+    }
+
+    // Cursor perezoso sobre [begin, end]: entrega las keys una por una sin reservar memoria
+    // y se puede abandonar en cualquier momento sin pagar por el resto del rango.
+    //   for (auto c = btree.cursor(a, b); c.valid(); c.next()) usar(c.key());
+    // Hasta es el tipo del limite end (TK, u otro si Compare es transparente).
+    template <typename Hasta>
+    class BasicRangeCursor {
+    public:
+        bool valid() const {
+            return actual != fin && !comp(hasta, *actual);
+        }
+
+        const TK& key() const {
+            return *actual;
+        }
+
+        void next() {
+            ++actual;
+        }
+
+    private:
+        friend class BTree;
+
+        iterator actual;
+        iterator fin;
+        Hasta hasta;
+        Compare comp;
+
+        BasicRangeCursor(const iterator& actual_, const iterator& fin_, const Hasta& hasta_, const Compare& comp_)
+            : actual(actual_), fin(fin_), hasta(hasta_), comp(comp_) {}
+    };
+
+    using RangeCursor = BasicRangeCursor<TK>;
+
+    RangeCursor cursor(const TK& begin, const TK& end) const {
+        return cursor<TK>(begin, end);
+    }
+
+    // con end < begin el cursor arranca invalido: lower_bound(begin) ya es mayor que end
+    template <typename K, SiBuscable<K> = 0>
+    BasicRangeCursor<std::decay_t<const K>> cursor(const K& begin, const K& end) const {
+        return BasicRangeCursor<std::decay_t<const K>>(lower_bound(begin), this->end(), end, comp);
+    }
+
+protected:
+
+    struct DeSnapshot {};
+
+    BTree(const BTree& origen, DeSnapshot)
+        : OrdenArbol<ORDEN>(origen), root(origen.root), n(origen.n), unaPasada(false), forma(0), formaDedo(0),
+          estado(origen.estado), esSnapshot(true), comp(origen.comp) {
+        estado->arboles.fetch_add(1, std::memory_order_acq_rel);
+        if (root != nullptr)
+            root->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    struct DePedazo {};
+
+    // arbol vacio que usa los mismos pools que origen (el pedazo derecho de split_at)
+    BTree(const BTree& origen, DePedazo)
+        : OrdenArbol<ORDEN>(origen), root(nullptr), n(0), unaPasada(origen.unaPasada), forma(0), formaDedo(0),
+          estado(origen.estado), esSnapshot(false), comp(origen.comp) {
+        estado->arboles.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // split_at sobre derecho, un arbol vacio creado con DePedazo a partir de este
+    void partirEn(const TK& key, BTree& derecho) {
+        if (root == nullptr)
+            return;
+        ++forma;
+        Pair<Subarbol, Subarbol> pedazos = partir(desprender(), key, false);
+        root = pedazos.first.raiz;
+        derecho.root = pedazos.second.raiz;
+        const int total = n;
+        n = contarMenor(root, derecho.root, total);
+        derecho.n = total - n;
+    }
+
+    // hay nodos que pueden estar compartidos (y pools usados desde otros hilos)
+    bool hayCompartidos() const {
+        return esSnapshot || estado->arboles.load(std::memory_order_acquire) > 1;
+    }
+
+    Node<TK, ORDEN, TV, CONTEO>* nuevoNodo(bool leaf) {
+        BTREE_CONTAR(nodosReservados, 1);
+        ++forma;
+        NodePool& pool = leaf ? estado->poolHojas : estado->poolInternos;
+        void* bloque;
+        if (hayCompartidos()) {
+            std::lock_guard<std::mutex> guard(estado->mutexPools);
+            bloque = pool.reservar();
+        } else {
+            bloque = pool.reservar();
+        }
+        return Node<TK, ORDEN, TV, CONTEO>::create(bloque, M, leaf);
+    }
+
+    void liberarNodo(Node<TK, ORDEN, TV, CONTEO>* node) {
+        BTREE_CONTAR(nodosLiberados, 1);
+        ++forma;
+        NodePool& pool = node->leaf ? estado->poolHojas : estado->poolInternos;
+        Node<TK, ORDEN, TV, CONTEO>::destroy(node, M);
+        if (hayCompartidos()) {
+            std::lock_guard<std::mutex> guard(estado->mutexPools);
+            pool.devolver(node);
+        } else {
+            pool.devolver(node);
+        }
+    }
+
+    // suelta una referencia al nodo; si era la ultima suelta a sus hijos y lo devuelve al pool
+    void soltar(Node<TK, ORDEN, TV, CONTEO>* node) {
+        if (node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        if (!node->leaf) {
+            for (int i = 0; i <= node->count; ++i)
+                soltar(node->children[i]);
+        }
+        liberarNodo(node);
+    }
+
+    // copy-on-write: si el nodo del slot (root o un children[i]) esta compartido con un snapshot,
+    // lo reemplaza por una copia propia; los hijos pasan a estar compartidos por ambos
+    Node<TK, ORDEN, TV, CONTEO>* unico(Node<TK, ORDEN, TV, CONTEO>*& slot) {
+        Node<TK, ORDEN, TV, CONTEO>* node = slot;
+        if (node->refs.load(std::memory_order_acquire) == 1)
+            return node;
+        Node<TK, ORDEN, TV, CONTEO>* copia = nuevoNodo(node->leaf);
+        for (int i = 0; i < node->count; ++i)
+            copiarClave(copia, i, node, i);
+        if (!node->leaf) {
+            for (int i = 0; i <= node->count; ++i) {
+                moverHijo(copia, i, node, i);
+                copia->children[i]->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        copia->count = node->count;
+        slot = copia;
+        soltar(node);
+        return copia;
+    }
+
+    // hace propios todos los nodos del camino, desde la raiz
+    void asegurarCamino(Camino& pila) {
+        if (!hayCompartidos())
+            return;
+        for (int j = 0; j < pila.size(); ++j) {
+            Node<TK, ORDEN, TV, CONTEO>*& slot = j == 0 ? root : pila[j - 1].first->children[pila[j - 1].second];
+            pila[j].first = unico(slot);
+        }
+    }
+
+    // destruye las keys (y valores) de todo el subarbol sin devolver los bloques a los pools
+    void destruirSubarbol(Node<TK, ORDEN, TV, CONTEO>* node) {
+        if (!node->leaf) {
+            for (int i = 0; i <= node->count; ++i)
+                destruirSubarbol(node->children[i]);
+        }
+        Node<TK, ORDEN, TV, CONTEO>::destroy(node, M);
+    }
+
+    // insert con la key copiada (lvalue) o movida (rvalue): no se toca hasta saber que es nueva
+    template <typename K>
+    void insertar(K&& key) {
+        if (!dedo.is_empty() && formaDedo == forma) {
+            Node<TK, ORDEN, TV, CONTEO>* hoja = dedo.top().first;
+            if (comp(hoja->keys[0], key)) { // la key cae en la ultima hoja: no hace falta bajar
+                int i = buscarEnNodo(hoja, key);
+                if (i < hoja->count && !comp(key, hoja->keys[i]))
+                    return; // ya existe
+                // en el modo de una pasada el dedo solo sirve si la hoja no se parte: insertarEnCamino
+                // partiria subiendo por el camino; si no, se baja partiendo con insertarUnaPasada
+                if (!unaPasada || hoja->count < M - 1 || (i == hoja->count && hermanoIzquierdoConEspacio())) {
+                    for (int j = 0; j + 1 < dedo.size(); ++j)
+                        dedo[j].second = dedo[j].first->count;
+                    dedo.top().second = i;
+                    insertarEnCamino(dedo, std::forward<K>(key), Valor());
+                    if (formaDedo != forma) // hubo splits
+                        armarDedo();
+                    return;
+                }
+            }
+        }
+        if (unaPasada) {
+            if (insertarUnaPasada(std::forward<K>(key)))
+                armarDedo();
+            return;
+        }
+        Camino pila; // almacena los pares (puntero al nodo y posicion de busqueda)
+
+        bool existe = findPathToKey(key, pila);
+        if (existe)
+            return; // ya existe
+
+        bool alFinal = borde(pila) > 0;
+        insertarEnCamino(pila, std::forward<K>(key), Valor());
+        if (alFinal)
+            armarDedo();
+    }
+
+    // camino a la ultima hoja, con la posicion del ultimo hijo en cada nivel
+    void armarDedo() {
+        dedo.clear();
+        for (Node<TK, ORDEN, TV, CONTEO>* current = root; current != nullptr;
+             current = current->leaf ? nullptr : current->children[current->count])
+            dedo.push({current, current->count});
+        formaDedo = forma;
+    }
+
+    // la ultima hoja (la del dedo) puede ceder keys a su hermano izquierdo, ver cederAlHermano
+    bool hermanoIzquierdoConEspacio() const {
+        if (dedo.size() < 2)
+            return false;
+        const Node<TK, ORDEN, TV, CONTEO>* parent = dedo[dedo.size() - 2].first;
+        return parent->children[parent->count - 1]->count < M - 1;
+    }
+
+    // 1 si el camino baja siempre por el ultimo hijo (la key es la nueva maxima), -1 si siempre por
+    // el primero (la nueva minima) y 0 si no
+    static int borde(const Camino& pila) {
+        bool derecha = true;
+        bool izquierda = true;
+        for (int j = 0; j < pila.size(); ++j) {
+            derecha = derecha && pila[j].second == pila[j].first->count;
+            izquierda = izquierda && pila[j].second == 0;
+        }
+        return derecha ? 1 : (izquierda ? -1 : 0);
+    }
+
+    // Construye el camino desde la raíz hasta la posición donde se encuentra o debería insertarse la key.
+    template <typename K>
+    bool findPathToKey(const K &key,
+                       Camino &pila) const {
+        BTREE_CONTAR(descensos, 1);
+        Node<TK, ORDEN, TV, CONTEO> *current = root;
+        while (current != nullptr) {
+            int i = buscarEnNodo(current, key);
+            pila.push({current, i});
+            if (i < current->count && !comp(key, current->keys[i]))
+                return true;
+            current = current->leaf ? nullptr : current->children[i];
+        }
+        return false;
+    }
+
+    // Deja en la pila el camino hacia key (recien insertable, mayor que las keys anteriores del lote),
+    // bajando desde el ancestro mas alto del camino actual cuyo separador derecho no supera a key.
+    // Retorna false si la key ya existe.
+    bool reubicarCamino(const TK& key, Camino& pila) const {
+        BTREE_CONTAR(descensos, 1);
+        Node<TK, ORDEN, TV, CONTEO>* current = root;
+        for (int j = 0; j < static_cast<int>(pila.size()); ++j) {
+            const Pair<Node<TK, ORDEN, TV, CONTEO>*, int>& nivel = pila[j];
+            if (nivel.second < nivel.first->count && !comp(key, nivel.first->keys[nivel.second])) {
+                current = nivel.first; // key sale del hijo por el que se bajo en este nivel
+                while (static_cast<int>(pila.size()) > j)
+                    pila.pop();
+                break;
+            }
+        }
+        if (current == root)
+            pila.clear();
+        while (current != nullptr) {
+            int i = buscarEnNodo(current, key);
+            pila.push({current, i});
+            if (i < current->count && !comp(key, current->keys[i]))
+                return false;
+            current = current->leaf ? nullptr : current->children[i];
+        }
+        return true;
+    }
+
+    void estadisticasRec(Node<TK, ORDEN, TV, CONTEO>* const& node, const int& nivel, EstadisticasBTree& resultado) const {
+        if (node == nullptr)
+            return;
+        EstadisticasBTree::Nivel& datos = resultado.niveles[nivel];
+        ++datos.nodos;
+        datos.keys += node->count;
+        ++datos.llenado[std::min(9, node->count * 10 / (M - 1))];
+        ++resultado.nodos;
+        resultado.keys += node->count;
+        resultado.bytesNodos += Node<TK, ORDEN, TV, CONTEO>::bytes(M, node->leaf);
+        if (!node->leaf) {
+            for (int i = 0; i <= node->count; ++i)
+                estadisticasRec(node->children[i], nivel + 1, resultado);
+        }
+    }
+
+    // posicion de key en el nodo (lowerBound con comp), contando la visita
+    template <typename K>
+    int buscarEnNodo(const Node<TK, ORDEN, TV, CONTEO>* node, const K& key) const {
+        BTREE_CONTAR(nodosVisitados, 1);
+        BTREE_CONTAR(comparaciones, (nodesearch::comparaciones<TK, K, Compare>(node->count)));
+        return nodesearch::lowerBound(&node->keys[0], node->count, key, comp);
+    }
+
+    // primera key de un ancestro mayor a todas las keys de la hoja del tope; false si no hay
+    // (la hoja es la ultima del arbol)
+    static bool limiteDeHoja(const Camino& pila, TK& limite) {
+        const TK* separador = separadorDerecho(pila);
+        if (separador != nullptr)
+            limite = *separador;
+        return separador != nullptr;
+    }
+
+    // la misma key de limiteDeHoja, sin copiarla (nullptr si no hay)
+    static const TK* separadorDerecho(const Camino& pila) {
+        for (int j = static_cast<int>(pila.size()) - 2; j >= 0; --j) {
+            if (pila[j].second < pila[j].first->count)
+                return &pila[j].first->keys[pila[j].second];
+        }
+        return nullptr;
+    }
+
+    // pide a la cache las lineas del nodo (cabecera, keys y lo que entre de children) antes de usarlo
+    void precargar(const Node<TK, ORDEN, TV, CONTEO>* node) const {
+#if defined(__GNUC__)
+        const char* inicio = reinterpret_cast<const char*>(node);
+        const std::size_t bytes = std::min(Node<TK, ORDEN, TV, CONTEO>::bytes(M, false), LINEAS_PRECARGA * 64);
+        for (std::size_t b = 0; b < bytes; b += 64)
+            __builtin_prefetch(inicio + b);
+#else
+        (void)node;
+#endif
+    }
+
+    // mezcla el arbol con el lote ordenado y reconstruye desde cero
+    template <typename It>
+    void mezclarYReconstruir(It begin, It end) {
+        std::vector<TK> elements;
+        elements.reserve(n + std::distance(begin, end));
+        iterator actual = this->begin();
+        iterator fin = this->end();
+        while (actual != fin || begin != end) {
+            const TK& key = (begin == end || (actual != fin && comp(*actual, *begin))) ? *actual : *begin;
+            if (elements.empty() || comp(elements.back(), key))
+                elements.push_back(key);
+            if (actual != fin && !comp(key, *actual))
+                ++actual;
+            else
+                ++begin;
+        }
+        clear();
+        construir(elements);
+    }
+
+    // Reparto parejo de m items de un nivel (elementos o separadores) en nodos de a lo mas
+    // capacidad keys: entre nodo y nodo sube un item, y el nodo i tiene base + (i < resto) keys
+    struct Reparto {
+        std::size_t nodos;
+        std::size_t base;
+        std::size_t resto;
+
+        std::size_t inicio(std::size_t i) const {
+            return i * (base + 1) + std::min(i, resto);
+        }
+
+        int keys(std::size_t i) const {
+            return static_cast<int>(base + (i < resto));
+        }
+    };
+
+    Reparto repartir(std::size_t m, int capacidad) const {
+        std::size_t nodos = (m + 1 + capacidad) / (capacidad + 1);
+        while (nodos > 1 && (m + 1 - nodos) / nodos < static_cast<std::size_t>(minKeys))
+            --nodos;
+        std::size_t keys = m + 1 - nodos;
+        return {nodos, keys / nodos, keys % nodos};
+    }
+
+    std::vector<void*> reservarBloques(std::size_t cantidad, bool leaf) {
+        NodePool& pool = leaf ? estado->poolHojas : estado->poolInternos;
+        std::vector<void*> bloques(cantidad);
+        std::unique_lock<std::mutex> guard(estado->mutexPools, std::defer_lock);
+        if (hayCompartidos())
+            guard.lock();
+        for (void*& bloque : bloques)
+            bloque = pool.reservar();
+        BTREE_CONTAR(nodosReservados, cantidad);
+        return bloques;
+    }
+
+    // ejecuta f(desde, hasta) sobre rangos contiguos de [0, total), uno por hilo
+    template <typename F>
+    static void enParalelo(std::size_t total, unsigned hilos, const F& f) {
+        const std::size_t MIN_POR_HILO = 64;
+        hilos = static_cast<unsigned>(std::min<std::size_t>(hilos, std::max<std::size_t>(1, total / MIN_POR_HILO)));
+        if (hilos <= 1) {
+            f(std::size_t{0}, total);
+            return;
+        }
+        std::size_t porHilo = (total + hilos - 1) / hilos;
+        std::vector<std::thread> trabajadores;
+        for (unsigned t = 1; t < hilos && t * porHilo < total; ++t)
+            trabajadores.emplace_back(f, t * porHilo, std::min(total, (t + 1) * porHilo));
+        f(std::size_t{0}, porHilo);
+        for (std::thread& trabajador : trabajadores)
+            trabajador.join();
+    }
+
+    // keys menores que key (o menores o iguales si incluirIgual)
+    template <typename K>
+    int contarHasta(const K& key, bool incluirIgual) const {
+        static_assert(CONTEO, "rank y count_range necesitan un arbol con CONTEO = true");
+        BTREE_CONTAR(descensos, 1);
+        int total = 0;
+        Node<TK, ORDEN, TV, CONTEO>* node = root;
+        while (node != nullptr) {
+            int i = buscarEnNodo(node, key);
+            bool igual = i < node->count && !comp(key, node->keys[i]);
+            total += i;
+            if (node->leaf)
+                return total + (igual && incluirIgual);
+            for (int j = 0; j < i; ++j)
+                total += node->conteos[j];
+            if (igual)
+                return total + node->conteos[i] + incluirIgual;
+            node = node->children[i];
+        }
+        return total;
+    }
+
+    // tamaño real del subarbol, o -1 si algun conteo no coincide
+    int contarSubarbol(Node<TK, ORDEN, TV, CONTEO>* const& node) const {
+        int total = node->count;
+        if (!node->leaf) {
+            for (int i = 0; i <= node->count; ++i) {
+                int hijo = contarSubarbol(node->children[i]);
+                if (hijo < 0 || hijo != node->conteos[i])
+                    return -1;
+                total += hijo;
+            }
+        }
+        return total;
+    }
+
+    // Carga de las hojas hacia la raiz (ver build_from_ordered_vector_parallel) en un arbol vacio.
+    // valores es paralelo a elements, o nullptr para valores por defecto.
+    void construirParalelo(const std::vector<TK>& elements, const Valor* valores, unsigned hilos, double llenado) {
+        if (elements.empty())
+            return;
+        hilos = std::max(1u, hilos);
+        int capacidad = std::clamp(static_cast<int>(llenado * (M - 1) + 0.5), std::max(1, minKeys), M - 1);
+
+        // hojas: la hoja i toma elements[inicio(i), inicio(i) + keys(i)) y el elemento siguiente sube
+        Reparto reparto = repartir(elements.size(), capacidad);
+        std::vector<void*> bloques = reservarBloques(reparto.nodos, true);
+        std::vector<Node<TK, ORDEN, TV, CONTEO>*> nodos(reparto.nodos);
+        std::vector<std::size_t> separadores(reparto.nodos - 1); // posiciones en elements
+        enParalelo(reparto.nodos, hilos, [&](std::size_t desde, std::size_t hasta) {
+            for (std::size_t i = desde; i < hasta; ++i) {
+                Node<TK, ORDEN, TV, CONTEO>* hoja = Node<TK, ORDEN, TV, CONTEO>::create(bloques[i], M, true);
+                std::size_t inicio = reparto.inicio(i);
+                int keys = reparto.keys(i);
+                for (int j = 0; j < keys; ++j)
+                    ponerClave(hoja, j, elements[inicio + j], valorDe(valores, inicio + j));
+                hoja->count = keys;
+                nodos[i] = hoja;
+                if (i + 1 < reparto.nodos)
+                    separadores[i] = inicio + keys;
+            }
+        });
+
+        // niveles internos: lo mismo sobre los separadores del nivel de abajo
+        while (nodos.size() > 1) {
+            reparto = repartir(separadores.size(), capacidad);
+            bloques = reservarBloques(reparto.nodos, false);
+            std::vector<Node<TK, ORDEN, TV, CONTEO>*> padres(reparto.nodos);
+            std::vector<std::size_t> siguientes(reparto.nodos - 1);
+            enParalelo(reparto.nodos, hilos, [&](std::size_t desde, std::size_t hasta) {
+                for (std::size_t i = desde; i < hasta; ++i) {
+                    Node<TK, ORDEN, TV, CONTEO>* padre = Node<TK, ORDEN, TV, CONTEO>::create(bloques[i], M, false);
+                    std::size_t inicio = reparto.inicio(i);
+                    int keys = reparto.keys(i);
+                    for (int j = 0; j < keys; ++j) {
+                        std::size_t k = separadores[inicio + j];
+                        ponerClave(padre, j, elements[k], valorDe(valores, k));
+                        padre->children[j] = nodos[inicio + j];
+                    }
+                    padre->children[keys] = nodos[inicio + keys];
+                    padre->count = keys;
+                    recontarTodos(padre);
+                    padres[i] = padre;
+                    if (i + 1 < reparto.nodos)
+                        siguientes[i] = separadores[inicio + keys];
+                }
+            });
+            nodos.swap(padres);
+            separadores.swap(siguientes);
+        }
+        root = nodos[0];
+        n = static_cast<int>(elements.size());
+    }
+
+    static Valor valorDe(const Valor* valores, std::size_t i) {
+        return valores == nullptr ? Valor() : valores[i];
+    }
+
+    // recorrido inorder: las keys de una hoja son contiguas y van en una sola escritura
+    void guardarKeys(Node<TK, ORDEN, TV, CONTEO>* const& node, std::ostream& os) const {
+        if (node->leaf) {
+            Serializador<TK>::escribir(os, &node->keys[0], node->count);
+            return;
+        }
+        for (int i = 0; i < node->count; ++i) {
+            guardarKeys(node->children[i], os);
+            Serializador<TK>::escribir(os, &node->keys[i], 1);
+        }
+        guardarKeys(node->children[node->count], os);
+    }
+
+    void guardarValores(Node<TK, ORDEN, TV, CONTEO>* const& node, std::ostream& os) const {
+        if (node->leaf) {
+            Serializador<TV>::escribir(os, &node->values[0], node->count);
+            return;
+        }
+        for (int i = 0; i < node->count; ++i) {
+            guardarValores(node->children[i], os);
+            Serializador<TV>::escribir(os, &node->values[i], 1);
+        }
+        guardarValores(node->children[node->count], os);
+    }
+
+    // llena un arbol vacio con los elementos ordenados (sin repetidos)
+    void construir(const std::vector<TK>& elements) {
+        if (elements.empty())
+            return;
+        Pair<Node<TK, ORDEN, TV, CONTEO>*, int>* basePromoted = nullptr;
+        if (elements.size() < M) {
+            root = build_from_ordered_vector_recursivo(this, elements, basePromoted, elements.size() + 1, M);
+        } else {
+            basePromoted = new Pair<Node<TK, ORDEN, TV, CONTEO>*, int>[elements.size() + 1];
+            for (int i = 0; i <= elements.size(); ++i) {
+                basePromoted[i].first = nullptr;
+                basePromoted[i].second = i;
+            }
+
+            root = build_from_ordered_vector_recursivo(this, elements, basePromoted, elements.size() + 1, M);
+        }
+        n = static_cast<int>(elements.size());
+    }
+
+    // nodo y posicion de la key, o nullptr si no esta
+    template <typename K>
+    Pair<Node<TK, ORDEN, TV, CONTEO>*, int> buscarPosicion(const K& key) const {
+        BTREE_CONTAR(descensos, 1);
+        Node<TK, ORDEN, TV, CONTEO> *current = root;
+        while (current != nullptr) {
+            int i = buscarEnNodo(current, key);
+            if (i < current->count && !comp(key, current->keys[i]))
+                return {current, i};
+            current = current->leaf ? nullptr : current->children[i];
+        }
+        return {nullptr, 0};
+    }
+
+    // mueve la key j de src (con su valor) a la posicion i de dst; el slot j queda movido
+    static void moverClave(Node<TK, ORDEN, TV, CONTEO>* const& dst, const int& i, Node<TK, ORDEN, TV, CONTEO>* const& src, const int& j) {
+        dst->keys[i] = std::move(src->keys[j]);
+        if constexpr (!std::is_void_v<TV>)
+            dst->values[i] = std::move(src->values[j]);
+    }
+
+    // mueve las keys [desde, hasta) de src (con sus valores) a dst desde la posicion i. Los rangos
+    // pueden solaparse dentro del mismo nodo; para tipos trivialmente copiables es un memmove.
+    static void moverClaves(Node<TK, ORDEN, TV, CONTEO>* const& dst, const int& i, Node<TK, ORDEN, TV, CONTEO>* const& src,
+                            const int& desde, const int& hasta) {
+        if (hasta <= desde)
+            return;
+        if (dst == src && i > desde) {
+            std::move_backward(&src->keys[0] + desde, &src->keys[0] + hasta, &dst->keys[0] + i + (hasta - desde));
+            if constexpr (!std::is_void_v<TV>)
+                std::move_backward(&src->values[0] + desde, &src->values[0] + hasta, &dst->values[0] + i + (hasta - desde));
+        } else {
+            std::move(&src->keys[0] + desde, &src->keys[0] + hasta, &dst->keys[0] + i);
+            if constexpr (!std::is_void_v<TV>)
+                std::move(&src->values[0] + desde, &src->values[0] + hasta, &dst->values[0] + i);
+        }
+    }
+
+    // copia la key j de src (con su valor) a la posicion i de dst (copy-on-write)
+    static void copiarClave(Node<TK, ORDEN, TV, CONTEO>* const& dst, const int& i, Node<TK, ORDEN, TV, CONTEO>* const& src, const int& j) {
+        if constexpr (std::is_copy_assignable_v<TK> && std::is_copy_assignable_v<Valor>) {
+            dst->keys[i] = src->keys[j];
+            if constexpr (!std::is_void_v<TV>)
+                dst->values[i] = src->values[j];
+        } else {
+            // sin copia no hay snapshots (snapshot() no compila), asi que ningun nodo esta compartido
+            (void)dst, (void)i, (void)src, (void)j;
+            throw std::logic_error("Nodo compartido con keys que no se pueden copiar");
+        }
+    }
+
+    // copia el hijo j de src (con el tamaño de su subarbol) a la posicion i de dst
+    static void moverHijo(Node<TK, ORDEN, TV, CONTEO>* const& dst, const int& i, Node<TK, ORDEN, TV, CONTEO>* const& src, const int& j) {
+        dst->children[i] = src->children[j];
+        if constexpr (CONTEO)
+            dst->conteos[i] = src->conteos[j];
+    }
+
+    // cantidad de keys del subarbol (con CONTEO)
+    static int tamano(Node<TK, ORDEN, TV, CONTEO>* const& node) {
+        int total = node->count;
+        if constexpr (CONTEO) {
+            if (!node->leaf) {
+                for (int i = 0; i <= node->count; ++i)
+                    total += node->conteos[i];
+            }
+        }
+        return total;
+    }
+
+    // recalcula el tamaño del hijo i; sin CONTEO no hace nada
+    static void recontar(Node<TK, ORDEN, TV, CONTEO>* const& parent, const int& i) {
+        if constexpr (CONTEO)
+            parent->conteos[i] = tamano(parent->children[i]);
+    }
+
+    static void recontarTodos(Node<TK, ORDEN, TV, CONTEO>* const& node) {
+        if constexpr (CONTEO) {
+            for (int i = 0; i <= node->count; ++i)
+                recontar(node, i);
+        }
+    }
+
+    // suma delta al hijo por el que se bajo en cada ancestro del camino (todos menos el tope)
+    static void sumarEnCamino(const Camino& pila, const int& delta) {
+        if constexpr (CONTEO) {
+            for (int j = 0; j + 1 < pila.size(); ++j)
+                pila[j].first->conteos[pila[j].second] += delta;
+        }
+    }
+
+    // copia o mueve key y valor al slot i, segun lo que se pase
+    template <typename K, typename V>
+    static void ponerClave(Node<TK, ORDEN, TV, CONTEO>* const& node, const int& i, K&& key, V&& valor) {
+        node->keys[i] = std::forward<K>(key);
+        if constexpr (!std::is_void_v<TV>)
+            node->values[i] = std::forward<V>(valor);
+    }
+
+    // suelta lo que la key (y el valor) del slot i tenga reservado; los tipos triviales no se tocan
+    static void limpiarClave(Node<TK, ORDEN, TV, CONTEO>* const& node, const int& i) {
+        if constexpr (!std::is_trivially_destructible_v<TK>)
+            node->keys[i] = TK();
+        if constexpr (!std::is_void_v<TV> && !std::is_trivially_destructible_v<TV>)
+            node->values[i] = TV();
+    }
+
+    // saca (mueve) el valor del slot i
+    static Valor sacarValor(Node<TK, ORDEN, TV, CONTEO>* const& node, const int& i) {
+        if constexpr (!std::is_void_v<TV>)
+            return std::move(node->values[i]);
+        else
+            return Valor();
+    }
+
+    // Reparte el hijo i de parent (lleno, en el borde del arbol) con su hermano en lugar de partirlo.
+    // Con inserts ascendentes (lado > 0, i es el ultimo hijo) sus primeras keys pasan al hermano
+    // izquierdo hasta llenarlo; con descendentes (lado < 0, i = 0) las ultimas pasan al derecho.
+    // Partir por la mediana dejaria atras nodos a la mitad que ya no reciben keys; asi quedan llenos.
+    // Retorna cuantas keys cedio el hijo (0 si el hermano tambien esta lleno).
+    int cederAlHermano(Node<TK, ORDEN, TV, CONTEO>* const& parent, const int& i, const int& lado) {
+        const int j = lado > 0 ? i - 1 : i + 1;
+        if (parent->children[j]->count == M - 1)
+            return 0;
+        Node<TK, ORDEN, TV, CONTEO>* node = parent->children[i];
+        Node<TK, ORDEN, TV, CONTEO>* hermano = unico(parent->children[j]);
+        const int k = M - 1 - hermano->count; // el hijo queda con M - 1 - k >= minKeys keys
+        BTREE_CONTAR(cesiones, 1);
+
+        const int s = std::min(i, j); // separador entre los dos
+        TK sep = std::move(parent->keys[s]);
+        Valor valor = sacarValor(parent, s);
+        if (lado > 0)
+            repartir(hermano, sep, valor, node, M - 1);
+        else
+            repartir(node, sep, valor, hermano, node->count - k);
+        ponerClave(parent, s, std::move(sep), std::move(valor));
+        recontar(parent, i);
+        recontar(parent, j);
+        return k;
+    }
+
+    // -------------------- partir y unir subarboles ---------------
+
+    // pedazo suelto del arbol: raiz y altura (-1 si esta vacio). La raiz puede tener menos de
+    // minKeys keys; los demas nodos cumplen las propiedades
+    struct Subarbol {
+        Node<TK, ORDEN, TV, CONTEO>* raiz;
+        int altura;
+    };
+
+    // Reparte las keys de los vecinos a (izquierdo) y b, separados por sep, para que a quede con
+    // cuantas keys: las que sobran de un lado pasan al otro a traves de sep, con sus hijos.
+    void repartir(Node<TK, ORDEN, TV, CONTEO>* const& a, TK& sep, Valor& valor, Node<TK, ORDEN, TV, CONTEO>* const& b, const int& cuantas) {
+        if (a->count > cuantas) { // las ultimas d keys de a pasan al inicio de b
+            const int d = a->count - cuantas;
+            moverClaves(b, d, b, 0, b->count);
+            ponerClave(b, d - 1, std::move(sep), std::move(valor));
+            moverClaves(b, 0, a, cuantas + 1, a->count);
+            sep = std::move(a->keys[cuantas]);
+            valor = sacarValor(a, cuantas);
+            if (!a->leaf) {
+                for (int c = b->count; c >= 0; --c)
+                    moverHijo(b, c + d, b, c);
+                for (int c = 0; c < d; ++c) {
+                    moverHijo(b, c, a, cuantas + 1 + c);
+                    a->children[cuantas + 1 + c] = nullptr;
+                }
+            }
+            for (int c = cuantas; c < a->count; ++c)
+                limpiarClave(a, c);
+            a->count -= d;
+            b->count += d;
+        } else if (a->count < cuantas) { // las primeras d keys de b pasan al final de a
+            const int d = cuantas - a->count;
+            ponerClave(a, a->count, std::move(sep), std::move(valor));
+            moverClaves(a, a->count + 1, b, 0, d - 1);
+            sep = std::move(b->keys[d - 1]);
+            valor = sacarValor(b, d - 1);
+            moverClaves(b, 0, b, d, b->count);
+            if (!a->leaf) {
+                for (int c = 0; c < d; ++c)
+                    moverHijo(a, a->count + 1 + c, b, c);
+                for (int c = 0; c + d <= b->count; ++c)
+                    moverHijo(b, c, b, c + d);
+                for (int c = b->count - d + 1; c <= b->count; ++c)
+                    b->children[c] = nullptr;
+            }
+            for (int c = b->count - d; c < b->count; ++c)
+                limpiarClave(b, c);
+            a->count += d;
+            b->count -= d;
+        }
+    }
+
+    // pasa sep y todo b al final de a (caben) y libera b
+    void juntar(Node<TK, ORDEN, TV, CONTEO>* const& a, TK&& sep, Valor&& valor, Node<TK, ORDEN, TV, CONTEO>* const& b) {
+        ponerClave(a, a->count, std::move(sep), std::move(valor));
+        moverClaves(a, a->count + 1, b, 0, b->count);
+        if (!a->leaf) {
+            for (int c = 0; c <= b->count; ++c) {
+                moverHijo(a, a->count + 1 + c, b, c);
+                b->children[c] = nullptr;
+            }
+        }
+        a->count += 1 + b->count;
+        b->count = 0;
+        liberarNodo(b);
+    }
+
+    // Une izq, sep e der (las keys de izq son menores a sep y las de der mayores) en O(diferencia de
+    // alturas + 1): el mas bajo se cuelga como ultimo (o primer) hijo del nodo del borde del mas alto
+    // que esta a su altura mas uno, y se sube partiendo nodos llenos como en un insert.
+    Subarbol unir(Subarbol izq, TK&& sep, Valor&& valor, Subarbol der) {
+        if (izq.altura == der.altura) {
+            if (izq.altura < 0) {
+                Node<TK, ORDEN, TV, CONTEO>* hoja = nuevoNodo(true);
+                ponerClave(hoja, 0, std::move(sep), std::move(valor));
+                hoja->count = 1;
+                return {hoja, 0};
+            }
+            Node<TK, ORDEN, TV, CONTEO>* a = unico(izq.raiz);
+            Node<TK, ORDEN, TV, CONTEO>* b = unico(der.raiz);
+            if (a->count + 1 + b->count <= M - 1) {
+                juntar(a, std::move(sep), std::move(valor), b);
+                return {a, izq.altura};
+            }
+            // no caben en uno: raiz nueva y los dos se reparten (las raices pueden tener pocas keys)
+            repartir(a, sep, valor, b, (a->count + b->count) / 2);
+            Node<TK, ORDEN, TV, CONTEO>* raiz = nuevoNodo(false);
+            ponerClave(raiz, 0, std::move(sep), std::move(valor));
+            raiz->children[0] = a;
+            raiz->children[1] = b;
+            raiz->count = 1;
+            recontarTodos(raiz);
+            return {raiz, izq.altura + 1};
+        }
+
+        const bool derecha = izq.altura > der.altura; // se baja por el borde derecho de izq (o el izquierdo de der)
+        Subarbol alto = derecha ? izq : der;
+        Node<TK, ORDEN, TV, CONTEO>* bajo = derecha ? der.raiz : izq.raiz;
+        const int alturaBajo = derecha ? der.altura : izq.altura;
+
+        Camino pila;
+        Node<TK, ORDEN, TV, CONTEO>* node = unico(alto.raiz);
+        for (int h = alto.altura; h > alturaBajo + 1; --h) {
+            int c = derecha ? node->count : 0;
+            pila.push({node, c});
+            node = unico(node->children[c]);
+        }
+        // node esta a la altura de bajo mas uno
+        const int pos = derecha ? node->count : 0;
+        pila.push({node, pos});
+
+        Node<TK, ORDEN, TV, CONTEO>* nuevoHijo = nullptr;
+        if (alturaBajo >= 0) {
+            // bajo puede tener pocas keys: se junta con su vecino en node o se reparten
+            bajo = unico(bajo);
+            Node<TK, ORDEN, TV, CONTEO>* vecino = unico(node->children[pos]);
+            Node<TK, ORDEN, TV, CONTEO>* a = derecha ? vecino : bajo;
+            Node<TK, ORDEN, TV, CONTEO>* b = derecha ? bajo : vecino;
+            if (a->count + 1 + b->count <= M - 1) {
+                juntar(a, std::move(sep), std::move(valor), b);
+                node->children[pos] = a;
+                recontarBorde(alto, derecha, alturaBajo + 1);
+                return alto;
+            }
+            repartir(a, sep, valor, b, (a->count + b->count) / 2);
+            nuevoHijo = bajo;
+        }
+
+        // sep entra en node con bajo como hijo derecho (o izquierdo); se suben los splits
+        Node<TK, ORDEN, TV, CONTEO>* rightOfValue = derecha ? nuevoHijo : (node->leaf ? nullptr : node->children[0]);
+        Node<TK, ORDEN, TV, CONTEO>* leftOfValue = nullptr;
+        while (true) {
+            if (pila.is_empty()) {
+                Node<TK, ORDEN, TV, CONTEO>* raiz = nuevoNodo(false);
+                raiz->children[0] = leftOfValue;
+                insertIntoNode(raiz, 0, std::move(sep), std::move(valor), rightOfValue);
+                alto = {raiz, alto.altura + 1};
+                break;
+            }
+            Node<TK, ORDEN, TV, CONTEO>* top = pila.top().first;
+            if (top->count < M - 1) {
+                insertIntoNode(top, pila.top().second, std::move(sep), std::move(valor), rightOfValue);
+                break;
+            }
+            leftOfValue = top;
+            rightOfValue = split(top, pila.top().second, sep, valor, rightOfValue);
+            pila.pop();
+        }
+        if (!derecha && nuevoHijo != nullptr)
+            node->children[0] = nuevoHijo; // node conserva la posicion 0 aunque se haya partido
+        recontarBorde(alto, derecha, alturaBajo + 1);
+        return alto;
+    }
+
+    // recalcula los conteos del borde derecho (o izquierdo) de t, de la altura hasta hacia arriba
+    void recontarBorde(const Subarbol& t, const bool& derecha, const int& hasta) {
+        if constexpr (CONTEO) {
+            Camino borde;
+            Node<TK, ORDEN, TV, CONTEO>* node = t.raiz;
+            for (int h = t.altura; h >= hasta && h > 0; --h) {
+                borde.push({node, 0});
+                node = node->children[derecha ? node->count : 0];
+            }
+            while (!borde.is_empty())
+                recontarTodos(borde.pop().first);
+        } else {
+            (void)t, (void)derecha, (void)hasta;
+        }
+    }
+
+    // Parte t en las keys menores a key (o menores o iguales si incluir) y el resto. Se baja por el
+    // camino de key: cada nodo se corta en un pedazo izquierdo y uno derecho, que se unen con lo que
+    // devuelve el hijo. La union cuesta la diferencia de alturas y las diferencias se telescopean:
+    // O(altura) en total.
+    Pair<Subarbol, Subarbol> partir(Subarbol t, const TK& key, const bool& incluir) {
+        if (t.altura < 0)
+            return {t, t};
+        Node<TK, ORDEN, TV, CONTEO>* node = unico(t.raiz);
+        int i = buscarEnNodo(node, key);
+        if (incluir && i < node->count && !comp(key, node->keys[i]))
+            ++i;
+
+        if (node->leaf) {
+            if (i == 0)
+                return {{nullptr, -1}, {node, 0}};
+            if (i == node->count)
+                return {{node, 0}, {nullptr, -1}};
+            Node<TK, ORDEN, TV, CONTEO>* derecho = nuevoNodo(true);
+            moverClaves(derecho, 0, node, i, node->count);
+            for (int c = i; c < node->count; ++c)
+                limpiarClave(node, c);
+            derecho->count = node->count - i;
+            node->count = i;
+            return {{node, 0}, {derecho, 0}};
+        }
+
+        Pair<Subarbol, Subarbol> hijo = partir({node->children[i], t.altura - 1}, key, incluir);
+        node->children[i] = nullptr;
+
+        // pedazo derecho: keys (i, count) con los hijos (i, count]; keys[i] lo une con lo del hijo
+        Pair<Subarbol, Subarbol> resultado = hijo;
+        if (i < node->count) {
+            Node<TK, ORDEN, TV, CONTEO>* derecho = nuevoNodo(false);
+            moverClaves(derecho, 0, node, i + 1, node->count);
+            for (int c = i + 1; c <= node->count; ++c) {
+                moverHijo(derecho, c - i - 1, node, c);
+                node->children[c] = nullptr;
+            }
+            derecho->count = node->count - i - 1;
+            TK sep = std::move(node->keys[i]);
+            Valor valor = sacarValor(node, i);
+            for (int c = i; c < node->count; ++c)
+                limpiarClave(node, c);
+            node->count = i;
+            resultado.second = unir(hijo.second, std::move(sep), std::move(valor), sinRaizVacia({derecho, t.altura}));
+        }
+        // pedazo izquierdo: keys [0, i - 1) con los hijos [0, i); keys[i - 1] lo une con lo del hijo
+        if (i > 0) {
+            TK sep = std::move(node->keys[i - 1]);
+            Valor valor = sacarValor(node, i - 1);
+            limpiarClave(node, i - 1);
+            node->count = i - 1;
+            resultado.first = unir(sinRaizVacia({node, t.altura}), std::move(sep), std::move(valor), hijo.first);
+        } else {
+            liberarNodo(node);
+        }
+        return resultado;
+    }
+
+    // un pedazo cuya raiz quedo sin keys es su unico hijo
+    Subarbol sinRaizVacia(Subarbol t) {
+        if (t.raiz->count > 0)
+            return t;
+        Node<TK, ORDEN, TV, CONTEO>* hijo = t.raiz->children[0];
+        t.raiz->children[0] = nullptr;
+        liberarNodo(t.raiz);
+        return {hijo, t.altura - 1};
+    }
+
+    // une dos pedazos con todas las keys de izq menores a las de der: la menor de der hace de separador
+    Subarbol concatenar(Subarbol izq, Subarbol der) {
+        if (izq.altura < 0)
+            return der;
+        if (der.altura < 0)
+            return izq;
+        Node<TK, ORDEN, TV, CONTEO>* node = der.raiz;
+        while (!node->leaf)
+            node = node->children[0];
+        Pair<Subarbol, Subarbol> minimo = partir(der, node->keys[0], true);
+        TK sep = std::move(minimo.first.raiz->keys[0]);
+        Valor valor = sacarValor(minimo.first.raiz, 0);
+        liberarNodo(minimo.first.raiz);
+        return unir(izq, std::move(sep), std::move(valor), minimo.second);
+    }
+
+    // keys del subarbol (lo recorre entero salvo con CONTEO)
+    static int contarKeys(Node<TK, ORDEN, TV, CONTEO>* const& node) {
+        if (node == nullptr)
+            return 0;
+        if constexpr (CONTEO) {
+            return tamano(node);
+        } else {
+            int total = node->count;
+            if (!node->leaf) {
+                for (int i = 0; i <= node->count; ++i)
+                    total += contarKeys(node->children[i]);
+            }
+            return total;
+        }
+    }
 
-public:
+    // el arbol entero como pedazo suelto; root queda en nullptr (n no se toca)
+    Subarbol desprender() {
+        Subarbol todo{root, root == nullptr ? -1 : height()};
+        root = nullptr;
+        return todo;
+    }
 
-    explicit BTree(const int& M_) : root(nullptr), M(M_), n(0) {
-        if (M < 3)
-            throw std::out_of_range("El grado del arbol debe de ser mínimo 3");
+    // keys de a, sabiendo que a y b suman total: se recorren los dos a la vez, un nodo de cada uno,
+    // hasta terminar el mas chico (con CONTEO basta la raiz)
+    static int contarMenor(Node<TK, ORDEN, TV, CONTEO>* const& a, Node<TK, ORDEN, TV, CONTEO>* const& b, const int& total) {
+        if constexpr (CONTEO) {
+            (void)b, (void)total;
+            return a == nullptr ? 0 : tamano(a);
+        } else {
+            std::vector<Node<TK, ORDEN, TV, CONTEO>*> pendientesA, pendientesB;
+            if (a != nullptr)
+                pendientesA.push_back(a);
+            if (b != nullptr)
+                pendientesB.push_back(b);
+            int keysA = 0;
+            int keysB = 0;
+            auto paso = [](std::vector<Node<TK, ORDEN, TV, CONTEO>*>& pendientes, int& keys) {
+                Node<TK, ORDEN, TV, CONTEO>* node = pendientes.back();
+                pendientes.pop_back();
+                keys += node->count;
+                if (!node->leaf)
+                    pendientes.insert(pendientes.end(), &node->children[0], &node->children[0] + node->count + 1);
+            };
+            while (!pendientesA.empty() && !pendientesB.empty()) {
+                paso(pendientesA, keysA);
+                paso(pendientesB, keysB);
+            }
+            return pendientesA.empty() ? keysA : total - keysB;
+        }
     }
 
+    // menor key del subarbol
+    static const TK& primeraKey(Node<TK, ORDEN, TV, CONTEO>* node) {
+        while (!node->leaf)
+            node = node->children[0];
+        return node->keys[0];
+    }
 
+    // mayor key del subarbol
+    static const TK& ultimaKey(Node<TK, ORDEN, TV, CONTEO>* node) {
+        while (!node->leaf)
+            node = node->children[node->count];
+        return node->keys[node->count - 1];
+    }
 
+    // iterador en la menor key de un pedazo suelto (iterator(raiz) es su fin)
+    static iterator inicioDe(Node<TK, ORDEN, TV, CONTEO>* const& raiz) {
+        iterator it(raiz);
+        if (raiz != nullptr)
+            it.bajarIzquierda(raiz);
+        return it;
+    }
 
-    bool search(const TK &key) const { // asumiendo que los punteros de children estan inicializados con nullptr
-        Node<TK> *current = root;
-        while (current != nullptr) {
-            for (int i = 0; i < current->count; ++i) {
-                if (key < current->keys[i]) {
-                    current = current->children[i];
-                    break;
-                }
-                if (current->keys[i] < key) {
-                    if (i + 1 == current->count) {
-                        current = current->children[current->count];
-                        break;
-                    }
-                    continue;
-                }
-                return true;
-            }
-        }
-        return false;
+    // Los nodos de otro pueden pasar a este arbol: usan el mismo estado (pedazos de un split_at) o
+    // los pools de otro no los usa nadie mas y se pueden absorber
+    bool puedeAdoptar(const BTree& otro) const {
+        return otro.estado == estado
+               || (!otro.hayCompartidos() && estado->poolHojas.compatible(otro.estado->poolHojas)
+                   && estado->poolInternos.compatible(otro.estado->poolInternos));
     }
 
-    void insert(const TK &key) {
-        if (root == nullptr) {
-            root = new Node<TK>(M);
-            root->keys[0] = key;
-            root->count = 1;
-            ++n;
+    // pasa los pools de otro a este (ver puedeAdoptar): desde ahora sus nodos se liberan aca
+    void adoptarNodos(BTree& otro) {
+        if (otro.estado == estado)
             return;
+        std::unique_lock<std::mutex> guard(estado->mutexPools, std::defer_lock);
+        if (hayCompartidos())
+            guard.lock();
+        estado->poolHojas.absorber(otro.estado->poolHojas);
+        estado->poolInternos.absorber(otro.estado->poolInternos);
+    }
+
+    // Entrega en orden las keys del subarbol (con sus valores) a entregar(TK&&, Valor&&): se mueven
+    // de los nodos propios y se copian de los compartidos con snapshots (y de todo lo que cuelga de
+    // ellos). Despues el subarbol solo sirve para soltarlo.
+    template <typename F>
+    static void vaciarSubarbol(Node<TK, ORDEN, TV, CONTEO>* const& node, bool propio, F& entregar) {
+        propio = propio && node->refs.load(std::memory_order_acquire) == 1;
+        for (int i = 0; i <= node->count; ++i) {
+            if (!node->leaf)
+                vaciarSubarbol(node->children[i], propio, entregar);
+            if (i == node->count)
+                break;
+            if (propio) {
+                entregar(std::move(node->keys[i]), sacarValor(node, i));
+            } else if constexpr (std::is_copy_constructible_v<TK> && std::is_copy_constructible_v<Valor>) {
+                Valor valor = Valor();
+                if constexpr (!std::is_void_v<TV>)
+                    valor = node->values[i];
+                entregar(TK(node->keys[i]), std::move(valor));
+            } else {
+                throw std::logic_error("Nodo compartido con keys que no se pueden copiar");
+            }
         }
+    }
 
-        Pila<Pair<Node<TK> *, int>> pila; // almacena los pares (puntero al nodo y posicion de busqueda)
+    // inserta la key (mayor a todas) al final, por el dedo como los inserts ascendentes
+    void agregarAlFinal(TK&& key, Valor&& valor) {
+        if (dedo.is_empty() || formaDedo != forma)
+            armarDedo();
+        for (int j = 0; j < dedo.size(); ++j)
+            dedo[j].second = dedo[j].first->count;
+        insertarEnCamino(dedo, std::move(key), std::move(valor));
+        armarDedo();
+    }
 
-        bool existe = findPathToKey(key, pila);
-        if (existe)
-            return; // ya existe
+    // avanza it hasta la primera key >= key: unos pasos del iterador y si no alcanza, una busqueda
+    iterator alcanzar(iterator it, const TK& key) const {
+        for (int paso = 0; paso < PASOS_ANTES_DE_BUSCAR && it != end() && comp(*it, key); ++paso)
+            ++it;
+        if (it == end() || !comp(*it, key))
+            return it;
+        return lower_bound(key);
+    }
+
+    // avanza a y b (en la misma key) mientras sigan apuntando a keys iguales: una corrida de keys
+    // que estan en los dos. Retorna cuantas son y deja en ultimaA y ultimaB la ultima de cada lado
+    int corridaComun(iterator& a, const iterator& finA, iterator& b, const iterator& finB,
+                     const TK*& ultimaA, const TK*& ultimaB) const {
+        int keys = 0;
+        do {
+            ultimaA = &*a;
+            ultimaB = &*b;
+            ++keys;
+            ++a;
+            ++b;
+        } while (a != finA && b != finB && !comp(*a, *b) && !comp(*b, *a));
+        return keys;
+    }
 
-        TK value = key;
-        Node<TK> *rightOfValue = nullptr;
-        Node<TK> *leftOfValue = nullptr;
+    // Cuantos tramos salen al recorrer en orden las keys de este arbol y las de otro: cada corrida
+    // de keys de un solo arbol, o de keys que estan en los dos, es un tramo. Se deja de contar al
+    // pasar limite; cada tramo cuesta una busqueda a lo mas.
+    long long contarTramos(const BTree& otro, const long long& limite) const {
+        long long tramos = 0;
+        iterator a = begin();
+        iterator b = otro.begin();
+        const TK* ultimaA = nullptr;
+        const TK* ultimaB = nullptr;
+        while (a != end() && b != otro.end() && tramos <= limite) {
+            if (comp(*a, *b))
+                a = alcanzar(a, *b);
+            else if (comp(*b, *a))
+                b = otro.alcanzar(b, *a);
+            else
+                corridaComun(a, end(), b, otro.end(), ultimaA, ultimaB);
+            ++tramos;
+        }
+        return tramos + 1; // lo que queda de uno de los dos
+    }
 
-        while (true) {
-            if (pila.is_empty() || pila.top().first->count < M - 1) { // caso nodo con espacio
-                if (pila.is_empty()) {
-                    root = new Node<TK>(M);
-                    root->children[0] = leftOfValue;
-                    root->leaf = false;
-                    insertIntoNode(root, 0, value, rightOfValue);
+    enum class Estrategia { Tramos, Mezcla, PorKey };
+
+    // Elige como combinar con otro: por tramos (si se puede), mezclando las keys y reconstruyendo
+    // (si se pueden copiar) o con porKey operaciones de una key (si porKey >= 0). Los costos van en
+    // descensos desde la raiz: un tramo cuesta COSTO_TRAMO y la mezcla uno cada KEYS_POR_DESCENSO keys
+    Estrategia elegirEstrategia(const BTree& otro, const bool& porTramos, const long long& porKey) const {
+        constexpr long long SIN_OPCION = std::numeric_limits<long long>::max();
+        const long long mezcla = std::is_copy_constructible_v<TK> && std::is_copy_constructible_v<Valor>
+                                     ? (static_cast<long long>(n) + otro.n) / KEYS_POR_DESCENSO
+                                     : SIN_OPCION;
+        const long long unaPorKey = porKey >= 0 ? porKey : SIN_OPCION;
+        const long long otraOpcion = std::min(mezcla, unaPorKey);
+        if (porTramos && (otraOpcion == SIN_OPCION || contarTramos(otro, otraOpcion / COSTO_TRAMO) * COSTO_TRAMO <= otraOpcion))
+            return Estrategia::Tramos;
+        return mezcla <= unaPorKey ? Estrategia::Mezcla : Estrategia::PorKey;
+    }
+
+    // Recorre el arbol por tramos contra otro: corridas de keys que tambien estan en otro y keys
+    // que no estan (hasta la siguiente key de otro). Quedan las comunes (interseccion) o las demas
+    // (diferencia): cada tramo se corta con partir y se suelta o se une al resultado.
+    void filtrarPorTramos(const BTree& otro, const bool& comunes) {
+        ++forma;
+        Subarbol resto = desprender();
+        Subarbol resultado{nullptr, -1};
+        int soltadas = 0;
+        iterator b = otro.begin();
+        while (resto.altura >= 0) {
+            const TK& primera = primeraKey(resto.raiz);
+            b = otro.alcanzar(b, primera);
+            if (b == otro.end()) { // ninguna de las que quedan esta en otro
+                if (comunes) {
+                    soltadas += contarKeys(resto.raiz);
+                    soltar(resto.raiz);
                 } else {
-                    insertIntoNode(pila.top().first, pila.top().second, value, rightOfValue);
+                    resultado = concatenar(resultado, resto);
                 }
                 break;
+            }
+            const bool comun = !comp(primera, *b);
+            int keys = 0;
+            Pair<Subarbol, Subarbol> pedazos;
+            if (comun) {
+                iterator a = inicioDe(resto.raiz);
+                const TK* ultima = nullptr;
+                const TK* ultimaOtro = nullptr;
+                keys = corridaComun(a, iterator(resto.raiz), b, otro.end(), ultima, ultimaOtro);
+                pedazos = partir(resto, *ultima, true);
             } else {
-                Pair<Node<TK> *, TK> result =
-                        split(pila.top().first, pila.top().second, value, rightOfValue);
-                leftOfValue = pila.top().first;
-                rightOfValue = result.first;
-                value = result.second;
-                pila.pop();
+                pedazos = partir(resto, *b, false);
             }
+            if (comun == comunes) {
+                resultado = concatenar(resultado, pedazos.first);
+            } else {
+                soltadas += comun ? keys : contarKeys(pedazos.first.raiz);
+                soltar(pedazos.first.raiz);
+            }
+            resto = pedazos.second;
         }
-        ++n;
+        root = resultado.raiz;
+        n -= soltadas;
     }
 
-
-    void remove(const TK& key) {
-        Pila<Pair<Node<TK> *, int>> pila; // almacena los pares (puntero al nodo y posicion de busqueda)
-        bool existe = findPathToKey(key, pila);
-        if (!existe)
-            return; // no existe la key
-
-        Node<TK>* current = pila.top().first;
-        int index = pila.top().second;
-
-        if (!current->leaf) {
-            Pair<TK, int> successorInfo = successor(pila); // la pila tambien tiene el nodo del succesor e indice del sucessor en este caso
-            current->keys[index] = successorInfo.first; // reemplazar por sucesor
-            // actualizar nuevo a eliminar, el sucesor siempre es una hoja
-            current = pila.top().first;
-            index = successorInfo.second;
+    // Mezcla en orden las keys de este arbol y las de otro y reconstruye este arbol con las que
+    // quedarse(estaEnEste, estaEnOtro) acepta (con el valor de este si estan en los dos): O(n + m)
+    template <typename F>
+    void mezclar(const BTree& otro, const F& quedarse) {
+        if constexpr (std::is_copy_constructible_v<TK> && std::is_copy_constructible_v<Valor>) {
+            std::vector<TK> elements;
+            std::vector<Valor> valores;
+            iterator a = begin();
+            iterator b = otro.begin();
+            while (a != end() || b != otro.end()) {
+                const bool enEste = b == otro.end() || (a != end() && !comp(*b, *a));
+                const bool enOtro = a == end() || (b != otro.end() && !comp(*a, *b));
+                if (quedarse(enEste, enOtro)) {
+                    const iterator& it = enEste ? a : b;
+                    elements.push_back(*it);
+                    if constexpr (!std::is_void_v<TV>)
+                        valores.push_back(it.value());
+                }
+                if (enEste)
+                    ++a;
+                if (enOtro)
+                    ++b;
+            }
+            clear();
+            construirParalelo(elements, valores.empty() ? nullptr : valores.data(), 1, 1.0);
+        } else {
+            (void)otro, (void)quedarse;
         }
-        removeKeyFromLeaf(current, index);
+    }
 
-        if (current == root) {
-            if (current->count == 0) {
-                delete[] root->keys;
-                delete[] root->children;
-                delete root;
-                root = nullptr;
+    // -------------------- modo de una pasada ---------------
+
+    // parte el hijo i (lleno) del padre (con espacio): la mediana sube al padre
+    void dividirHijo(Node<TK, ORDEN, TV, CONTEO>* const& parent, const int& i) {
+        BTREE_CONTAR(splits, 1);
+        Node<TK, ORDEN, TV, CONTEO>* node = parent->children[i];
+        Node<TK, ORDEN, TV, CONTEO>* rightNode = nuevoNodo(node->leaf);
+        int medianIndex = node->count / 2;
+
+        moverClaves(rightNode, 0, node, medianIndex + 1, node->count);
+        for (int k = medianIndex + 1; k < node->count; ++k)
+            limpiarClave(node, k);
+        if (!node->leaf) {
+            for (int k = medianIndex + 1, j = 0; k <= node->count; ++k, ++j) {
+                moverHijo(rightNode, j, node, k);
+                node->children[k] = nullptr;
             }
-            --n;
-            return;
         }
+        rightNode->count = node->count - medianIndex - 1;
 
-        while (current->count < minKeys) {
-            pila.pop();
-            Node<TK>* parentNode = pila.top().first;
-            int parentChildIndex = pila.top().second;
+        TK median = std::move(node->keys[medianIndex]);
+        Valor medianValor = sacarValor(node, medianIndex);
+        limpiarClave(node, medianIndex);
+        node->count = medianIndex;
+        insertIntoNode(parent, i, std::move(median), std::move(medianValor), rightNode);
+    }
 
-            if (parentChildIndex != parentNode->count
-                && parentNode->children[parentChildIndex + 1]->count > minKeys) { // si el hermano derecho tiene suficiente keys
-                rotate(current, parentNode, parentChildIndex, false);
-            } else if (parentChildIndex != 0
-                       && parentNode->children[parentChildIndex -1]->count > minKeys) { // si el hermano izquierdo tiene suficiente keys
-                rotate(current, parentNode, parentChildIndex, true);
-            } else if (parentChildIndex != parentNode->count) { // merge con el hermano derecho
-                merge(current, parentNode, parentChildIndex, false);
-                if (parentNode == root) {
-                    if (parentNode->count == 0) { // caso donde la raiz se queda sin keys
-                        // eliminando root
-                        root->children[0]  = nullptr;
-                        root->keys[0] = TK();
-                        delete[] root->keys;
-                        delete[] root->children;
-                        delete root;
-                        root = current;
-                    }
-                    break;
+    // retorna true si la key quedo al final de la ultima hoja
+    template <typename K>
+    bool insertarUnaPasada(K&& key) {
+        if (root == nullptr) {
+            root = nuevoNodo(true);
+            BTREE_CONTAR(crecimientosRaiz, 1);
+            ponerClave(root, 0, std::forward<K>(key), Valor());
+            root->count = 1;
+            ++n;
+            return true;
+        }
+        Node<TK, ORDEN, TV, CONTEO>* node = unico(root);
+        if (node->count == M - 1) { // la raiz llena se parte antes de bajar
+            Node<TK, ORDEN, TV, CONTEO>* nuevaRaiz = nuevoNodo(false);
+            nuevaRaiz->children[0] = root;
+            root = nuevaRaiz;
+            BTREE_CONTAR(crecimientosRaiz, 1);
+            dividirHijo(root, 0);
+            node = root;
+        }
 
-                } else {
-                    current = parentNode;
+        BTREE_CONTAR(descensos, 1);
+        Camino camino; // hijos por los que se bajo, para sumar la key si resulta nueva (CONTEO)
+        bool derecha = true; // se bajo siempre por el ultimo hijo
+        bool izquierda = true; // o siempre por el primero
+        while (true) {
+            int i = buscarEnNodo(node, key);
+            if (i < node->count && !comp(key, node->keys[i]))
+                return false; // ya existe
+            derecha = derecha && i == node->count;
+            izquierda = izquierda && i == 0;
+            if (node->leaf) {
+                insertIntoNode(node, i, std::forward<K>(key), Valor(), nullptr);
+                if constexpr (CONTEO) {
+                    camino.push({node, i});
+                    sumarEnCamino(camino, 1);
                 }
-            } else { // merge con el hermano izquierdo
-                merge(current, parentNode, parentChildIndex, true);
-                if (parentNode == root) {
-                    if (parentNode->count == 0) { // caso donde la raiz se queda sin keys
-                        Node<TK>* sibling = parentNode->children[parentChildIndex - 1];
-                        // eliminando root
-                        root->children[0] = nullptr;
-                        root->keys[0] = TK();
-                        delete[] root->keys;
-                        delete[] root->children;
-                        delete root;
-                        root = sibling;
+                ++n;
+                return derecha;
+            }
+            Node<TK, ORDEN, TV, CONTEO>* child = node->children[i];
+            if (child->count == M - 1) {
+                child = unico(node->children[i]);
+                // en el borde, si la key va despues (o antes) de todo el hijo, se reparte con el hermano
+                int lado = derecha && comp(child->keys[M - 2], key) ? 1 : (izquierda && comp(key, child->keys[0]) ? -1 : 0);
+                if (lado == 0 || cederAlHermano(node, i, lado) == 0) {
+                    dividirHijo(node, i);
+                    if (!comp(key, node->keys[i])) {
+                        if (!comp(node->keys[i], key))
+                            return false; // la mediana era la key
+                        ++i;
                     }
-                    break;
-                } else {
-                    current = parentNode;
                 }
             }
+            if constexpr (CONTEO)
+                camino.push({node, i});
+            node = unico(node->children[i]);
         }
-        --n;
     }
-//elimina un elemento
-    int height() const {
-        if (root == nullptr)
-            return 0; // no estoy de acuerdo, pero creo que decia eso en las indicaciones. Caso contrario la altura es -1 de un arbol vacio
-
-        Node<TK> *current = root;
-        int height = 0;
 
-        while (true) {
-            if (current->leaf)
-                return height;
-            current = current->children[0];
-            ++height;
+    // si la raiz se quedo sin keys tras un merge, su unico hijo pasa a ser la raiz
+    void bajarRaiz() {
+        if (root->count == 0 && !root->leaf) {
+            Node<TK, ORDEN, TV, CONTEO>* viejaRaiz = root;
+            root = root->children[0];
+            viejaRaiz->children[0] = nullptr;
+            BTREE_CONTAR(reduccionesRaiz, 1);
+            liberarNodo(viejaRaiz);
         }
-    }//altura del arbol. Considerar altura 0 para arbol vacio
-    std::string toString(const std::string &sep = " ") const {
-        std::string result;
-        toString(root, result, sep);
-        return result;
-    } // recorrido inorder
-    std::vector<TK> rangeSearch(const TK& begin,const TK& end) {
-        std::vector<TK> result;
-        if (root == nullptr || begin > end)
-            return result;
-        rangeSearchRec(root, begin, end, result);
-        return result;
     }
 
-    TK minKey() const {
-        if (root == nullptr)
-            throw std::runtime_error("Arbol vacio");
-
-        Node<TK> *current = root;
-        while (true) {
-            if (current->leaf)
-                return current->keys[0];
-            current = current->children[0];
-        }
-    }// minimo valor de la llave en el arbol
-    TK maxKey() const {
-        if (root == nullptr)
-            throw std::runtime_error("Arbol vacio");
-
-        Node<TK> *current = root;
-        while (true) {
-            if (current->leaf)
-                return current->keys[current->count - 1];
-            current = current->children[current->count];
+    // Sube por el camino (ya propio) completando los nodos que quedaron con menos de minKeys keys, aunque
+    // les falte mas de una: cada uno se junta con un hermano si caben en un nodo (el padre pierde una
+    // key y se sigue subiendo) o se reparte con el. Al final baja la raiz si se quedo sin keys.
+    void completarCamino(Camino& pila) {
+        while (pila.size() > 1 && pila.top().first->count < minKeys) {
+            pila.pop();
+            Node<TK, ORDEN, TV, CONTEO>* parent = pila.top().first;
+            const int s = std::min(pila.top().second, parent->count - 1); // separador con el hermano
+            Node<TK, ORDEN, TV, CONTEO>* a = unico(parent->children[s]);
+            Node<TK, ORDEN, TV, CONTEO>* b = unico(parent->children[s + 1]);
+            TK sep = std::move(parent->keys[s]);
+            Valor valor = sacarValor(parent, s);
+            if (a->count + 1 + b->count <= M - 1) {
+                BTREE_CONTAR(merges, 1);
+                juntar(a, std::move(sep), std::move(valor), b);
+                moverClaves(parent, s, parent, s + 1, parent->count);
+                for (int c = s + 1; c < parent->count; ++c)
+                    moverHijo(parent, c, parent, c + 1);
+                parent->children[parent->count] = nullptr;
+                limpiarClave(parent, parent->count - 1);
+                --parent->count;
+                recontar(parent, s);
+            } else {
+                BTREE_CONTAR(rotacionesIzquierda, s < pila.top().second);
+                BTREE_CONTAR(rotacionesDerecha, s == pila.top().second);
+                repartir(a, sep, valor, b, (a->count + b->count) / 2);
+                ponerClave(parent, s, std::move(sep), std::move(valor));
+                recontar(parent, s);
+                recontar(parent, s + 1);
+                break;
+            }
         }
-    }// maximo valor de la llave en el arbol
-    void clear() {
-        if (root != nullptr) {
-            root->killSelf();
+        if (root->count == 0 && root->leaf) {
+            liberarNodo(root);
             root = nullptr;
-            n = 0;
+            BTREE_CONTAR(reduccionesRaiz, 1);
+        } else {
+            bajarRaiz();
         }
-    }// eliminar todos lo elementos del arbol
-    const int& size() const {
-        return n;
-    }// retorna el total de elementos insertados
+    }
 
-    // Construya un árbol B a partir de un vector de elementos ordenados
-    static BTree* build_from_ordered_vector(std::vector<TK> &elements, const int& M) {
-        BTree<TK>* btree = new BTree(M);
-        Pair<Node<TK>*, int>* basePromoted = nullptr;
-        if (elements.size() < M) {
-            btree->root =
-                    build_from_ordered_vector_recursivo(elements, basePromoted, elements.size() + 1, M);
+    // deja al hijo i con mas del minimo antes de bajar a el; retorna el hijo que queda en su lugar
+    Node<TK, ORDEN, TV, CONTEO>* completarHijo(Node<TK, ORDEN, TV, CONTEO>* const& node, int i) {
+        Node<TK, ORDEN, TV, CONTEO>* child = unico(node->children[i]);
+        if (child->count > minKeys)
+            return child;
+        if (i > 0 && node->children[i - 1]->count > minKeys) {
+            unico(node->children[i - 1]);
+            rotate(child, node, i, true);
+        } else if (i < node->count && node->children[i + 1]->count > minKeys) {
+            unico(node->children[i + 1]);
+            rotate(child, node, i, false);
+        } else if (i < node->count) {
+            unico(node->children[i + 1]);
+            merge(child, node, i, false);
         } else {
-            basePromoted = new Pair<Node<TK>*, int>[elements.size() + 1];
-            for (int i = 0; i <= elements.size(); ++i) {
-                basePromoted[i].first = nullptr;
-                basePromoted[i].second = i;
-            }
-
-            btree->root =
-                    build_from_ordered_vector_recursivo(elements, basePromoted, elements.size() + 1, M);
+            unico(node->children[i - 1]);
+            merge(child, node, i, true); // el hijo se junta en el hermano izquierdo
+            child = node->children[i - 1];
         }
-        return btree;
+        if (node == root)
+            bajarRaiz();
+        return child;
     }
 
-    // Verifique las propiedades de un árbol B
-    bool check_properties() const {
-        return check_properties_rec(root).valid;
+    static void anotarHijo(Camino& camino, Node<TK, ORDEN, TV, CONTEO>* const& node, const int& i) {
+        if constexpr (CONTEO)
+            camino.push({node, i});
     }
-    bool empty() const {
-        return root == nullptr;
+
+    void removerUnaPasada(const TK& key) {
+        if (root == nullptr)
+            return;
+        Node<TK, ORDEN, TV, CONTEO>* node = unico(root);
+        BTREE_CONTAR(descensos, 1);
+        Camino camino; // hijos por los que se bajo, para restar la key si existe (CONTEO)
+        // si la key esta en un nodo interno, su antecesor (o sucesor) la reemplaza al llegar a la hoja:
+        // destino es la posicion de la key y extremo el lado por el que se baja (-1 derecha, 1 izquierda)
+        Node<TK, ORDEN, TV, CONTEO>* destino = nullptr;
+        int posDestino = 0;
+        int extremo = 0;
+        while (node != nullptr) {
+            int i;
+            bool existe;
+            if (extremo == 0) {
+                i = buscarEnNodo(node, key);
+                existe = i < node->count && !comp(key, node->keys[i]);
+            } else {
+                i = extremo < 0 ? node->count - node->leaf : 0;
+                existe = node->leaf;
+            }
+
+            if (node->leaf) {
+                if (!existe)
+                    return;
+                if (destino != nullptr)
+                    moverClave(destino, posDestino, node, i);
+                removeKeyFromLeaf(node, i);
+                if constexpr (CONTEO) {
+                    camino.push({node, i});
+                    sumarEnCamino(camino, -1);
+                }
+                --n;
+                if (root->count == 0) {
+                    liberarNodo(root);
+                    root = nullptr;
+                    BTREE_CONTAR(reduccionesRaiz, 1);
+                }
+                return;
+            }
+
+            if (!existe) {
+                Node<TK, ORDEN, TV, CONTEO>* child = completarHijo(node, i);
+                if (child != root) // si la raiz bajo, node ya no existe
+                    anotarHijo(camino, node, child == node->children[i] ? i : i - 1);
+                node = child;
+                continue;
+            }
+
+            Node<TK, ORDEN, TV, CONTEO>* left = node->children[i];
+            Node<TK, ORDEN, TV, CONTEO>* right = node->children[i + 1];
+            if (left->count > minKeys || right->count > minKeys) {
+                // se reemplaza por el antecesor (o sucesor): se baja por ese hijo, que no hay que completar,
+                // y los rebalanceos de mas abajo no tocan esta posicion
+                bool antecesor = left->count > minKeys;
+                destino = node;
+                posDestino = i;
+                extremo = antecesor ? -1 : 1;
+                anotarHijo(camino, node, antecesor ? i : i + 1);
+                node = unico(node->children[antecesor ? i : i + 1]);
+            } else {
+                left = unico(node->children[i]);
+                unico(node->children[i + 1]);
+                merge(left, node, i, false); // la key baja al nodo fusionado
+                if (node == root)
+                    bajarRaiz();
+                if (left != root)
+                    anotarHijo(camino, node, i);
+                node = left;
+            }
+        }
     }
-private:
 
-    // Construye el camino desde la raíz hasta la posición donde se encuentra o debería insertarse la key.
-    bool findPathToKey(const TK &key,
-                       Pila<Pair<Node<TK> *, int>> &pila) const { // todos los children deben de estar con nullptr si es hoja
-        Node<TK> *current = root;
-        while (current != nullptr) {
-            for (int i = 0; i < current->count; ++i) {
-                if (key < current->keys[i]) {
-                    pila.push({current, i});
-                    current = current->children[i];
-                    break;
+    // Inserta key en la posicion que dejo findPathToKey en la pila, partiendo nodos hacia arriba.
+    // Retorna donde quedo la key, o nullptr si hubo splits (la key pudo moverse o subir).
+    // La key y el valor se reciben por valor: se copian o se mueven al llamar y de ahi solo se mueven.
+    Pair<Node<TK, ORDEN, TV, CONTEO>*, int> insertarEnCamino(Camino& pila, TK value, Valor valorActual) {
+        if (root == nullptr) {
+            root = nuevoNodo(true);
+            BTREE_CONTAR(crecimientosRaiz, 1);
+            ponerClave(root, 0, std::move(value), std::move(valorActual));
+            root->count = 1;
+            ++n;
+            return {root, 0};
+        }
+
+        asegurarCamino(pila); // copy-on-write si hay snapshots
+        Pair<Node<TK, ORDEN, TV, CONTEO>*, int> destino = pila.top();
+        Node<TK, ORDEN, TV, CONTEO> *rightOfValue = nullptr;
+        Node<TK, ORDEN, TV, CONTEO> *leftOfValue = nullptr;
+        const int lado = borde(pila); // inserts ordenados: los nodos llenos del borde reparten antes de partirse
+
+        while (true) {
+            if (lado != 0 && pila.size() > 1 && pila.top().first->count == M - 1) {
+                const Pair<Node<TK, ORDEN, TV, CONTEO>*, int>& padre = pila[pila.size() - 2];
+                int cedidas = cederAlHermano(padre.first, padre.second, lado);
+                if (cedidas > 0) {
+                    if (lado > 0)
+                        pila.top().second -= cedidas;
+                    if (destino.first != nullptr)
+                        destino.second = pila.top().second;
                 }
-                if (current->keys[i] < key) {
-                    if (i + 1 == current->count) {
-                        pila.push({current, current->count});
-                        current = current->children[current->count];
-                        break;
-                    }
-                    continue;
+            }
+            if (pila.is_empty() || pila.top().first->count < M - 1) { // caso nodo con espacio
+                if (pila.is_empty()) {
+                    root = nuevoNodo(false);
+                    BTREE_CONTAR(crecimientosRaiz, 1);
+                    root->children[0] = leftOfValue;
+                    insertIntoNode(root, 0, std::move(value), std::move(valorActual), rightOfValue);
+                } else {
+                    insertIntoNode(pila.top().first, pila.top().second, std::move(value), std::move(valorActual), rightOfValue);
+                    sumarEnCamino(pila, 1); // los ancestros del nodo que recibio la key crecen en uno
                 }
-                pila.push({current, i});
-                return true;
+                break;
+            } else {
+                leftOfValue = pila.top().first;
+                rightOfValue = split(pila.top().first, pila.top().second, value, valorActual, rightOfValue);
+                destino.first = nullptr;
+                pila.pop();
             }
         }
-        return false;
+        ++n;
+        return destino;
     }
 
     // se usa para insertar un valor con su hijo derecho en un nodo que tiene espacio
-    void insertIntoNode(Node<TK> *const &node, const int &index, const TK &value,
-                        Node<TK> *const &rightOfValue) {
-        node->children[node->count + 1] = node->children[node->count];
-        for (int i = node->count; i > index; --i) {
-            node->keys[i] = node->keys[i - 1];
-            node->children[i] = node->children[i - 1];
-        }
-        node->keys[index] = value;
-        node->children[index + 1] = rightOfValue;
+    // (value y valor se copian o se mueven segun se pasen)
+    template <typename K, typename V>
+    void insertIntoNode(Node<TK, ORDEN, TV, CONTEO> *const &node, const int &index, K&& value, V&& valor,
+                        Node<TK, ORDEN, TV, CONTEO> *const &rightOfValue) {
+        moverClaves(node, index + 1, node, index, node->count);
+        ponerClave(node, index, std::forward<K>(value), std::forward<V>(valor));
+        if (!node->leaf) {
+            for (int i = node->count + 1; i > index + 1; --i)
+                moverHijo(node, i, node, i - 1);
+            node->children[index + 1] = rightOfValue;
+        }
         ++node->count;
+        if (!node->leaf) { // el hijo izquierdo se partio en los dos de alrededor de value
+            recontar(node, index);
+            recontar(node, index + 1);
+        }
     }
 
-    Pair<Node<TK>*, TK> split(Node<TK> *const &node, const int &index, const TK &value, Node<TK> *const &rightOfValue) {
+    // Parte un nodo lleno insertando value (con su valor e hijo derecho) en index.
+    // value y valor salen con la mediana que sube al padre; retorna el nuevo nodo derecho
+    Node<TK, ORDEN, TV, CONTEO>* split(Node<TK, ORDEN, TV, CONTEO> *const &node, const int &index, TK &value, Valor& valor,
+                              Node<TK, ORDEN, TV, CONTEO> *const &rightOfValue) {
+        BTREE_CONTAR(splits, 1);
         int medianIndex = (M - 1) / 2;
-        TK median = TK();
-        Node<TK> *rightNode = new Node<TK>(M);
+        Node<TK, ORDEN, TV, CONTEO> *rightNode = nuevoNodo(node->leaf);
 
         if (index < medianIndex) {
             // valor mediano
-            median = node->keys[medianIndex - 1];
-            node->keys[medianIndex - 1] = TK();
+            TK median = std::move(node->keys[medianIndex - 1]);
+            Valor medianValor = sacarValor(node, medianIndex - 1);
+            limpiarClave(node, medianIndex - 1);
 
             // actualizando nodo derecho del split
-            for (int i = medianIndex, j = 0; i < node->count; ++i, ++j) {
-                rightNode->keys[j] = node->keys[i];
-                node->keys[i] = TK();
-                rightNode->children[j] = node->children[i];
-                node->children[i] = nullptr;
+            moverClaves(rightNode, 0, node, medianIndex, node->count);
+            for (int i = medianIndex; i < node->count; ++i)
+                limpiarClave(node, i);
+            if (!node->leaf) {
+                for (int i = medianIndex, j = 0; i <= node->count; ++i, ++j) {
+                    moverHijo(rightNode, j, node, i);
+                    node->children[i] = nullptr;
+                }
             }
-            rightNode->children[node->count - medianIndex] = node->children[node->count];
-            node->children[node->count] = nullptr;
-
             rightNode->count = node->count - medianIndex;
-            rightNode->leaf = node->leaf;
 
             // actualizando nodo izquierdo del split
-            node->children[medianIndex] = node->children[medianIndex - 1];
-            for (int i = medianIndex - 1; i > index; --i) {
-                node->keys[i] = node->keys[i - 1];
-                node->children[i] = node->children[i - 1];
+            moverClaves(node, index + 1, node, index, medianIndex - 1);
+            ponerClave(node, index, std::move(value), std::move(valor));
+            node->count = medianIndex;
+            if (!node->leaf) {
+                for (int i = medianIndex; i > index + 1; --i)
+                    moverHijo(node, i, node, i - 1);
+                node->children[index + 1] = rightOfValue;
+                recontar(node, index);
+                recontar(node, index + 1);
             }
-            node->keys[index] = value;
-            node->children[index + 1] = rightOfValue;
 
-            node->count = medianIndex;
+            value = std::move(median);
+            valor = std::move(medianValor);
 
         } else if (medianIndex < index) {
-            // valor mediano
-            median = node->keys[medianIndex];
-            node->keys[medianIndex] = TK();
-
             // actualizando nodo derecho del split
-            for (int i = medianIndex + 1, j = 0; i < index; ++i, ++j) {
-                rightNode->keys[j] = node->keys[i];
-                node->keys[i] = TK();
-                rightNode->children[j] = node->children[i];
-                node->children[i] = nullptr;
+            moverClaves(rightNode, 0, node, medianIndex + 1, index);
+            ponerClave(rightNode, index - medianIndex - 1, std::move(value), std::move(valor));
+            moverClaves(rightNode, index - medianIndex, node, index, node->count);
+            for (int i = medianIndex + 1; i < node->count; ++i)
+                limpiarClave(node, i);
+            if (!node->leaf) {
+                for (int i = medianIndex + 1, j = 0; i <= index; ++i, ++j) {
+                    moverHijo(rightNode, j, node, i);
+                    node->children[i] = nullptr;
+                }
+                rightNode->children[index - medianIndex] = rightOfValue;
+                for (int i = index + 1, j = index - medianIndex + 1; i <= node->count; ++i, ++j) {
+                    moverHijo(rightNode, j, node, i);
+                    node->children[i] = nullptr;
+                }
             }
-            rightNode->children[index - medianIndex - 1] = node->children[index];
-            node->children[index] = nullptr;
-
-            rightNode->keys[index - medianIndex - 1] = value;
-            node->children[index] = rightOfValue;
-
-            for (int i = index, j = index - medianIndex; i < node->count; ++i, ++j) {
-                rightNode->keys[j] = node->keys[i];
-                node->keys[i] = TK();
-                rightNode->children[j] = node->children[i];
-                node->children[i] = nullptr;
+            rightNode->count = node->count - medianIndex;
+            if (!node->leaf) {
+                recontar(rightNode, index - medianIndex - 1);
+                recontar(rightNode, index - medianIndex);
             }
-            rightNode->children[node->count - medianIndex] = node->children[node->count];
-            node->children[node->count] = nullptr;
 
-            rightNode->count = node->count - medianIndex;
-            rightNode->leaf = node->leaf;
+            // valor mediano
+            value = std::move(node->keys[medianIndex]);
+            valor = sacarValor(node, medianIndex);
+            limpiarClave(node, medianIndex);
 
             // actualizando nodo izquierdo del split
             node->count = medianIndex;
 
         } else {
-            // valor mediano
-            median = value;
+            // el valor mediano es value
 
             // actualizando nodo derecho del split
-            rightNode->children[0] = rightOfValue;
-            for (int i = medianIndex, j = 0; i < node->count; ++i, ++j) {
-                rightNode->keys[j] = node->keys[i];
-                node->keys[i] = TK();
-                rightNode->children[j + 1] = node->children[i + 1];
-                node->children[i + 1] = nullptr;
+            moverClaves(rightNode, 0, node, medianIndex, node->count);
+            for (int i = medianIndex; i < node->count; ++i)
+                limpiarClave(node, i);
+            if (!node->leaf) {
+                rightNode->children[0] = rightOfValue;
+                for (int i = medianIndex, j = 0; i < node->count; ++i, ++j) {
+                    moverHijo(rightNode, j + 1, node, i + 1);
+                    node->children[i + 1] = nullptr;
+                }
             }
             rightNode->count = node->count - medianIndex;
-            rightNode->leaf = node->leaf;
 
             // actualizando nodo izquierdo del split
             node->count = medianIndex;
+            if (!node->leaf) {
+                recontar(node, medianIndex);
+                recontar(rightNode, 0);
+            }
         }
 
-        return {rightNode, median};
+        return rightNode;
     }
 
 
-    void removeKeyFromLeaf(Node<TK>* const& node, const int& index) {
-        for (int i = index; i < node->count - 1; ++i) {
-            node->keys[i] = node->keys[i + 1];
-        }
-        node->keys[node->count - 1] = TK();
+    void removeKeyFromLeaf(Node<TK, ORDEN, TV, CONTEO>* const& node, const int& index) {
+        moverClaves(node, index, node, index + 1, node->count);
+        limpiarClave(node, node->count - 1);
         --node->count;
     }
 
     // Aplica una rotación entre el nodo y su hermano (izquierdo o derecho),
     // fromLeft = true -> rotar con el hermano izquierdo
     // fromLeft = false -> rotar con el hermano derecho
-    void rotate(Node<TK>* const& node, Node<TK>* const& parent, const int& nodeIndex, bool fromLeft) {
+    void rotate(Node<TK, ORDEN, TV, CONTEO>* const& node, Node<TK, ORDEN, TV, CONTEO>* const& parent, const int& nodeIndex, bool fromLeft) {
+        if (fromLeft)
+            BTREE_CONTAR(rotacionesIzquierda, 1);
+        else
+            BTREE_CONTAR(rotacionesDerecha, 1);
         if (fromLeft) {
-            Node<TK>* sibling = parent->children[nodeIndex - 1];
+            Node<TK, ORDEN, TV, CONTEO>* sibling = parent->children[nodeIndex - 1];
 
             // insertar el valor de la key padre con el rightmostChild del sibling en el nodo actual
-            for (int i = node->count;  i > 0; --i) {
-                node->keys[i] = node->keys[i - 1];
-                node->children[i + 1] = node->children[i];
-            }
-            node->keys[0] = parent->keys[nodeIndex - 1];
-            node->children[1] = node->children[0];
-            node->children[0] = sibling->children[sibling->count]; // rightmostChild del sibling
-            sibling->children[sibling->count] = nullptr;
+            moverClaves(node, 1, node, 0, node->count);
+            moverClave(node, 0, parent, nodeIndex - 1);
+            if (!node->leaf) {
+                for (int i = node->count + 1; i > 0; --i)
+                    moverHijo(node, i, node, i - 1);
+                moverHijo(node, 0, sibling, sibling->count); // rightmostChild del sibling
+                sibling->children[sibling->count] = nullptr;
+            }
             ++node->count;
 
             // reemplazar padre key por el antecesor en el hijo izquierdo
-            parent->keys[nodeIndex - 1] =  sibling->keys[sibling->count - 1];
-            sibling->keys[sibling->count - 1] = TK();
+            moverClave(parent, nodeIndex - 1, sibling, sibling->count - 1);
+            limpiarClave(sibling, sibling->count - 1);
             --sibling->count;
+            recontar(parent, nodeIndex - 1);
+            recontar(parent, nodeIndex);
         } else {
-            Node<TK>* sibling = parent->children[nodeIndex + 1];
+            Node<TK, ORDEN, TV, CONTEO>* sibling = parent->children[nodeIndex + 1];
 
             // insertar el valor de la key padre con el leftmostChild del sibling en el nodo actual
-            node->keys[node->count] = parent->keys[nodeIndex];
-            node->children[node->count + 1] = sibling->children[0]; // leftmostChild del sibling
-            sibling->children[0] = nullptr;
+            moverClave(node, node->count, parent, nodeIndex);
+            if (!node->leaf)
+                moverHijo(node, node->count + 1, sibling, 0); // leftmostChild del sibling
             ++node->count;
 
             // reemplazar padre key por el sucesor en el hijo derecho
-            parent->keys[nodeIndex] = sibling->keys[0];
+            moverClave(parent, nodeIndex, sibling, 0);
             // remover la key en la posicion 0 del sibling
-            for (int i = 0; i < sibling->count - 1; ++i) {
-                sibling->keys[i] = sibling->keys[i + 1];
-                sibling->children[i] = sibling->children[i + 1];
+            moverClaves(sibling, 0, sibling, 1, sibling->count);
+            limpiarClave(sibling, sibling->count - 1);
+            if (!sibling->leaf) {
+                for (int i = 0; i < sibling->count; ++i)
+                    moverHijo(sibling, i, sibling, i + 1);
+                sibling->children[sibling->count] = nullptr;
             }
-            sibling->keys[sibling->count - 1] = TK();
-            sibling->children[sibling->count - 1] = sibling->children[sibling->count];
-            sibling->children[sibling->count] = nullptr;
             --sibling->count;
+            recontar(parent, nodeIndex);
+            recontar(parent, nodeIndex + 1);
         }
     }
 
-    void merge(Node<TK>* const& node, Node<TK>* const& parent, const int& nodeIndex, bool fromLeft) {
+    void merge(Node<TK, ORDEN, TV, CONTEO>* const& node, Node<TK, ORDEN, TV, CONTEO>* const& parent, const int& nodeIndex, bool fromLeft) {
+        BTREE_CONTAR(merges, 1);
         if (fromLeft) {
-            Node<TK>* sibling = parent->children[nodeIndex - 1];
+            Node<TK, ORDEN, TV, CONTEO>* sibling = parent->children[nodeIndex - 1];
 
             // insertar la key padre en el hermano izquierdo
-            sibling->keys[sibling->count] = parent->keys[nodeIndex - 1];
+            moverClave(sibling, sibling->count, parent, nodeIndex - 1);
             ++sibling->count;
 
             // eliminar la key padre del nodo padre
             for (int i = nodeIndex - 1; i < parent->count - 1; ++i) {
-                parent->keys[i] = parent->keys[i + 1];
-                parent->children[i] = parent->children[i + 1];
+                moverClave(parent, i, parent, i + 1);
+                moverHijo(parent, i, parent, i + 1);
             }
-            parent->children[parent->count - 1] = parent->children[parent->count];
+            moverHijo(parent, parent->count - 1, parent, parent->count);
 
-            parent->keys[parent->count - 1] = TK();
+            limpiarClave(parent, parent->count - 1);
             parent->children[parent->count] = nullptr;
             parent->children[nodeIndex - 1] = sibling; // reconectar hijo izquierdo
             --parent->count;
 
             // mover keys e hijos del nodo actual al hermano izquierdo
-            for (int i = sibling->count, j = 0; j < node->count; ++i, ++j) {
-                sibling->keys[i] = node->keys[j];
-                node->keys[j] = TK();
-                sibling->children[i] = node->children[j];
-                node->children[j] = nullptr;
-                ++sibling->count;
+            if (!node->leaf) {
+                for (int i = sibling->count, j = 0; j <= node->count; ++i, ++j) {
+                    moverHijo(sibling, i, node, j);
+                    node->children[j] = nullptr;
+                }
             }
-            sibling->children[sibling->count] = node->children[node->count];
-            node->children[node->count] = nullptr;
+            moverClaves(sibling, sibling->count, node, 0, node->count);
+            sibling->count += node->count;
+            recontar(parent, nodeIndex - 1);
 
             // eliminar nodo actual
-            delete[] node->keys;
-            delete[] node->children;
-            delete node;
+            liberarNodo(node);
 
         } else { // es muy parecido a lo anterior, asi que se puede juntar en uno solo, pero lo dejo así por ahora
-            Node<TK> *sibling = parent->children[nodeIndex + 1];
+            Node<TK, ORDEN, TV, CONTEO> *sibling = parent->children[nodeIndex + 1];
 
             // insertar la key padre en el nodo actual
-            node->keys[node->count] = parent->keys[nodeIndex];
+            moverClave(node, node->count, parent, nodeIndex);
             ++node->count;
 
             // eliminar la key padre del nodo padre
             for (int i = nodeIndex; i < parent->count - 1; ++i) {
-                parent->keys[i] = parent->keys[i + 1];
-                parent->children[i] = parent->children[i + 1];
+                moverClave(parent, i, parent, i + 1);
+                moverHijo(parent, i, parent, i + 1);
             }
-            parent->children[parent->count - 1] = parent->children[parent->count];
+            moverHijo(parent, parent->count - 1, parent, parent->count);
 
-            parent->keys[parent->count - 1] = TK();
+            limpiarClave(parent, parent->count - 1);
             parent->children[parent->count] = nullptr;
             parent->children[nodeIndex] = node; // reconectar nodo actual
             --parent->count;
 
             // mover todos los keys e hijos del hermano derecho al nodo actual
-            for (int i = node->count, j = 0; j < sibling->count; ++i, ++j) {
-                node->keys[i] = sibling->keys[j];
-                sibling->keys[j] = TK();
-                node->children[i] = sibling->children[j];
-                sibling->children[j] = nullptr;
-                ++node->count;
+            if (!node->leaf) {
+                for (int i = node->count, j = 0; j <= sibling->count; ++i, ++j) {
+                    moverHijo(node, i, sibling, j);
+                    sibling->children[j] = nullptr;
+                }
             }
-            node->children[node->count] = sibling->children[sibling->count];
-            sibling->children[sibling->count] = nullptr;
+            moverClaves(node, node->count, sibling, 0, sibling->count);
+            node->count += sibling->count;
+            recontar(parent, nodeIndex);
 
             // eliminar hermano derecho
-            delete[] sibling->keys;
-            delete[] sibling->children;
-            delete sibling;
+            liberarNodo(sibling);
         }
     }
 
     // --- sucesor
     // Recibe una pila con el camino desde la raíz hasta la clave buscada,
     // incluyendo el nodo y la posición donde se encontró la key.
-    Pair<TK, int> successor(Pila<Pair<Node<TK>*, int>>& pila) const {
+    // Deja en el tope de la pila el nodo del sucesor y retorna su posicion (sin copiar keys).
+    int successor(Camino& pila) const {
         if (pila.is_empty())
             throw std::runtime_error("No existe esta key");
 
-        Node<TK>* current = pila.top().first;
+        Node<TK, ORDEN, TV, CONTEO>* current = pila.top().first;
         int index = pila.top().second;
-        TK key = current->keys[index];
 
         if (current->leaf) { // es hoja
             if (index + 1 == current->count) { // esta en el extremo
@@ -552,11 +2935,9 @@ private:
                     current = pila.top().first;
                     index = pila.top().second;
                 }
-                if (index == current->count)
-                    return {key, index}; // es el maximo, no hay sucesor
-                return {current->keys[index], index};  // el sucesor está en un ancestro
+                return index; // el sucesor está en un ancestro (index == count si es el maximo)
             }
-            return {current->keys[index + 1], index + 1}; // el sucesor es la siguiente key
+            return index + 1; // el sucesor es la siguiente key
 
         } else {
             current = current->children[index + 1]; // bajar al hijo derecho de la key actual
@@ -568,41 +2949,37 @@ private:
                 current = current->children[0];
                 pila.push({current, 0});
             }
-            return {current->keys[0], 0};
+            return 0;
         }
     }
 
 
-    void toString(Node<TK>* const& node, std::string& result, const std::string& sep) const {
+    void toString(Node<TK, ORDEN, TV, CONTEO>* const& node, std::string& result, const std::string& sep) const {
         if (node == nullptr)
             return;
 
         for (int i = 0; i < node->count; ++i) {
-            toString(node->children[i], result, sep);
+            if (!node->leaf)
+                toString(node->children[i], result, sep);
             if (!result.empty())
                 result += sep;
             result += keyToString(node->keys[i]);
         }
-        toString(node->children[node->count], result, sep);
+        if (!node->leaf)
+            toString(node->children[node->count], result, sep);
     }
 
-    void rangeSearchRec(Node<TK>* node, const TK& begin, const TK& end, std::vector<TK>& result) const {
+    // solo baja a los hijos que pueden tener keys en [begin, end]
+    template <typename K>
+    void rangeSearchRec(Node<TK, ORDEN, TV, CONTEO>* node, const K& begin, const K& end, std::vector<TK>& result) const {
         if (node == nullptr) return;
 
-        int i = 0;
-
-        while (i < node->count && node->keys[i] < begin) {
-            if (!node->leaf)
-                rangeSearchRec(node->children[i + 1], begin, end, result);
-            ++i;
-        }
+        int i = buscarEnNodo(node, begin); // primera key >= begin
 
-        for (; i < node->count && node->keys[i] <= end; ++i) {
+        for (; i < node->count && !comp(end, node->keys[i]); ++i) {
             if (!node->leaf)
                 rangeSearchRec(node->children[i], begin, end, result);
-
-            if (node->keys[i] >= begin && node->keys[i] <= end)
-                result.push_back(node->keys[i]);
+            result.push_back(node->keys[i]);
         }
 
         if (!node->leaf)
@@ -611,11 +2988,12 @@ private:
 
 
     // promoted tiene los punteros a los hijos y los indices de los elementos que suben(tiene tamaño size = numero de hijos)
-    static Node<TK>* build_from_ordered_vector_recursivo(const std::vector<TK>& elements,
-                                                         Pair<Node<TK>*, int>* const&  promoted,
+    static Node<TK, ORDEN, TV, CONTEO>* build_from_ordered_vector_recursivo(BTree* const& btree,
+                                                         const std::vector<TK>& elements,
+                                                         Pair<Node<TK, ORDEN, TV, CONTEO>*, int>* const&  promoted,
                                                          int size, int M) {
         if (size - 1 < M) { // no se puede dividir, ahi queda
-            Node<TK>* root = new Node<TK>(M);
+            Node<TK, ORDEN, TV, CONTEO>* root = btree->nuevoNodo(promoted == nullptr);
 
             if (promoted == nullptr) {
                 // caso root hoja
@@ -623,7 +3001,6 @@ private:
                     root->keys[i] = elements[i];
                     ++root->count;
                 }
-                root->leaf = true;
             } else {
                 // caso root no hoja
                 for (int  i = 0; i < size - 1; ++i) {
@@ -632,7 +3009,7 @@ private:
                     ++root->count;
                 }
                 root->children[root->count] = promoted[size - 1].first;
-                root->leaf = false;
+                btree->recontarTodos(root);
                 delete[] promoted;
             }
             return root;
@@ -640,12 +3017,12 @@ private:
         } else if (promoted != nullptr) {
             // se puede dividir
             int nextLevelSize = (size - 1 + 1 + M - 1) / M;
-            Pair<Node<TK>*, int>* nextPromoted = new Pair<Node<TK>*, int>[nextLevelSize];
+            Pair<Node<TK, ORDEN, TV, CONTEO>*, int>* nextPromoted = new Pair<Node<TK, ORDEN, TV, CONTEO>*, int>[nextLevelSize];
 
             int t = 0; // indice de nextPromoted
             int i = 0; // indice de Promoted
             for (; t < nextLevelSize; ++t) {
-                Node<TK>* newNode = new Node<TK>(M); // nuevo nodo
+                Node<TK, ORDEN, TV, CONTEO>* newNode = btree->nuevoNodo(promoted[0].first == nullptr); // nuevo nodo
 
                 int minDegree = (M % 2 == 0) ? M / 2 : (M + 1) / 2;
                 int minKeys = minDegree - 1;
@@ -660,22 +3037,21 @@ private:
 
                 for (int j = 0; j < keyCount; ++j, ++i) { // j es el índice del nodo creado
                     newNode->keys[j] = elements[promoted[i].second];
-                    newNode->children[j] = promoted[i].first;
+                    if (!newNode->leaf)
+                        newNode->children[j] = promoted[i].first;
                     ++newNode->count;
                 }
-                newNode->children[newNode->count] = promoted[i].first;
-
-                if (promoted[0].first != nullptr)
-                    newNode->leaf = false;
-                else
-                    newNode->leaf = true;
+                if (!newNode->leaf) {
+                    newNode->children[newNode->count] = promoted[i].first;
+                    btree->recontarTodos(newNode);
+                }
 
                 nextPromoted[t].first = newNode; // almacenar puntero hijo
                 nextPromoted[t].second = promoted[i].second; // almacenar posicion de padre derecho (en el caso extremo es basura)
                 ++i;
             }
             delete[] promoted;
-            return build_from_ordered_vector_recursivo(elements, nextPromoted, nextLevelSize, M);
+            return build_from_ordered_vector_recursivo(btree, elements, nextPromoted, nextLevelSize, M);
         } else {
             throw std::runtime_error("Promoted no valido");
         }
@@ -696,88 +3072,85 @@ private:
     struct SubtreeProperties {
         bool valid;
         int height;
-        TK minKey; // minima key del subarbol formado por el nodo
-        TK maxKey; // maxima key del subarbol formado por el nodo
+        const TK* minKey; // minima key del subarbol formado por el nodo (sin copiarla)
+        const TK* maxKey; // maxima key del subarbol formado por el nodo
     };
 
-    int minDegree = (M % 2 == 0) ? M / 2 : (M + 1) / 2;
-    int minKeys = minDegree - 1;
-
-    SubtreeProperties check_properties_rec(Node<TK>* const& node) const {
+    SubtreeProperties check_properties_rec(Node<TK, ORDEN, TV, CONTEO>* const& node) const {
 
         if (node == nullptr) {
-            return {true, -1, TK(), TK()};
+            return {true, -1, nullptr, nullptr};
         }
 
         if (node == root && node->count <= 0) // tiene que tener al menos una llave si es raiz
-            return {false, -1, TK(), TK()};
+            return {false, -1, nullptr, nullptr};
 
         if (node != root && node->count < minKeys) // minimo de llaves
-            return {false, -1, TK(), TK()};
+            return {false, -1, nullptr, nullptr};
 
         if (node->count > M - 1) // maximo de llaves
-            return {false, -1, TK(), TK()};
+            return {false, -1, nullptr, nullptr};
 
         int prevSubtreeHeight = 0;
-        TK prevKey = TK();
+        const TK* prevKey = nullptr;
 
-        TK maxKey = TK(); // maxima llave del subarbol formado por el nodo
-        TK minKey = TK(); // minima llave del subarbol formado por el nodo
+        const TK* maxKey = nullptr; // maxima llave del subarbol formado por el nodo
+        const TK* minKey = nullptr; // minima llave del subarbol formado por el nodo
         int height = 0; // altura del subarbol formado por el nodo
 
         for (int i = 0; i < node->count; ++ i) {
-            SubtreeProperties leftChildProps = check_properties_rec(node->children[i]);
+            SubtreeProperties leftChildProps = check_properties_rec(node->leaf ? nullptr : node->children[i]);
 
             if (!leftChildProps.valid) // el hijo izquierdo debe de ser válido
-                return {false, -1, TK(), TK()};
+                return {false, -1, nullptr, nullptr};
 
             if (i == 0) {
-                prevKey = node->keys[i];
+                prevKey = &node->keys[i];
 
-                if (!node->leaf && node->keys[i] <= leftChildProps.maxKey) // la llave actual debe ser mayor a la maxima llave del subarbol de su hijo izquierdo
-                    return {false, -1, TK(), TK()};
+                if (!node->leaf && !comp(*leftChildProps.maxKey, node->keys[i])) // la llave actual debe ser mayor a la maxima llave del subarbol de su hijo izquierdo
+                    return {false, -1, nullptr, nullptr};
                 prevSubtreeHeight = leftChildProps.height;
 
                 // minima key del subarbol formado por el del nodo
                 if (!node->leaf)
                     minKey = leftChildProps.minKey;
                 else
-                    minKey = node->keys[i];
+                    minKey = &node->keys[i];
             } else {
-                if (node->keys[i] <= prevKey) // las llaves deben de estar ordenadas
-                    return {false, -1, TK(), TK()};
+                if (!comp(*prevKey, node->keys[i])) // las llaves deben de estar ordenadas
+                    return {false, -1, nullptr, nullptr};
                 if (!node->leaf) {
-                    if (prevKey >= leftChildProps.minKey) // la llave anterior debe ser menor a la minima llave del subarbol de su hijo derecho
-                        return {false, -1, TK(), TK()};
-                    if (node->keys[i] <= leftChildProps.maxKey) // la llave actual debe ser mayor a la maxima llave del subarbol de su hijo izquierdo
-                        return {false, -1, TK(), TK()};
+                    if (!comp(*prevKey, *leftChildProps.minKey)) // la llave anterior debe ser menor a la minima llave del subarbol de su hijo derecho
+                        return {false, -1, nullptr, nullptr};
+                    if (!comp(*leftChildProps.maxKey, node->keys[i])) // la llave actual debe ser mayor a la maxima llave del subarbol de su hijo izquierdo
+                        return {false, -1, nullptr, nullptr};
                 }
                 // el hijo izquierdo de la llave actual debe de tener la misma altura que el hijo izquierdo de la llave anterior
                 if (prevSubtreeHeight != leftChildProps.height) // esto asegura tambien que las hojas esten al mismo nivel
-                    return {false, -1, TK(), TK()};
+                    return {false, -1, nullptr, nullptr};
 
-                prevKey = node->keys[i];
+                prevKey = &node->keys[i];
                 prevSubtreeHeight = leftChildProps.height;
             }
 
             if (i + 1 == node->count) {
-                SubtreeProperties rightChildProps = check_properties_rec(node->children[node->count]);
+                SubtreeProperties rightChildProps = check_properties_rec(node->leaf ? nullptr : node->children[node->count]);
 
                 if (!rightChildProps.valid) // el hijo derecho debe de ser válido
-                    return {false, -1, TK(), TK()};
+                    return {false, -1, nullptr, nullptr};
 
-                if (!node->leaf && node->keys[i] >= rightChildProps.minKey) // la llabe actual debe ser menor que la minima llave del subarbol de su hijo derecho
-                    return {false, -1, TK(), TK()};
+                if (!node->leaf && !comp(node->keys[i], *rightChildProps.minKey)) // la llabe actual debe ser menor que la minima llave del subarbol de su hijo derecho
+                    return {false, -1, nullptr, nullptr};
 
                 // el hijo izquierdo de la llave actual debe de tener la misma altura que el hijo derecho
                 if (leftChildProps.height != rightChildProps.height)
-                    return {false, -1, TK(), TK()};
+                    return {false, -1, nullptr, nullptr};
 
                 // maxima key del subarbol formado por el del nodo
                 if (!node->leaf)
                     maxKey = rightChildProps.maxKey;
                 else
-                    maxKey = node->keys[i];
+                    maxKey = &node->keys[i];
                 // altura del nodo actual
                 height = rightChildProps.height + 1;
             }
@@ -790,8 +3163,11 @@ private:
 public:
     ~BTree() {
         clear();
+        estado->arboles.fetch_sub(1, std::memory_order_release);
     }
 
 };
 
+#undef BTREE_CONTAR
+
 #endif
@@ -0,0 +1,97 @@
+#ifndef BTREEMAP_H
+#define BTREEMAP_H
+
+#include <utility>
+
+#include "btree.h"
+
+// Arbol B que guarda un valor por key. Los valores van en un array paralelo a las keys dentro
+// del mismo nodo, asi la busqueda sigue recorriendo solo keys. Las operaciones reusan la
+// maquinaria del BTree (findPathToKey, insertIntoNode, split); actualizar el valor de una key
+// existente no cambia la estructura del arbol.
+// Con un Compare transparente find acepta cualquier tipo comparable con TK (ver BTree).
+template <typename TK, typename TV, int ORDEN = 0, typename Compare = std::less<TK>>
+class BTreeMap : public BTree<TK, ORDEN, TV, false, Compare> {
+private:
+    using Base = BTree<TK, ORDEN, TV, false, Compare>;
+    using typename Base::Camino;
+    template <typename K>
+    using SiBuscable = typename Base::template SiBuscable<K>;
+
+public:
+    using Base::Base;
+
+    // Puntero al valor de la key, o nullptr si no esta (oculta el find por iterador del BTree).
+    // Con snapshots vivos el camino se copia antes, porque el valor se puede modificar.
+    TV* find(const TK& key) {
+        return find<TK>(key);
+    }
+
+    const TV* find(const TK& key) const {
+        return find<TK>(key);
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    TV* find(const K& key) {
+        if (this->hayCompartidos()) {
+            Camino pila;
+            if (!this->findPathToKey(key, pila))
+                return nullptr;
+            this->asegurarCamino(pila);
+            return &pila.top().first->values[pila.top().second];
+        }
+        Pair<Node<TK, ORDEN, TV>*, int> pos = this->buscarPosicion(key);
+        return pos.first == nullptr ? nullptr : &pos.first->values[pos.second];
+    }
+
+    template <typename K, SiBuscable<K> = 0>
+    const TV* find(const K& key) const {
+        Pair<Node<TK, ORDEN, TV>*, int> pos = this->buscarPosicion(key);
+        return pos.first == nullptr ? nullptr : &pos.first->values[pos.second];
+    }
+
+    // inserta la key con el valor o reemplaza el valor si ya existe; retorna true si la key es nueva
+    bool insert_or_assign(const TK& key, const TV& value) {
+        Camino pila;
+        if (this->findPathToKey(key, pila)) {
+            this->asegurarCamino(pila);
+            pila.top().first->values[pila.top().second] = value;
+            return false;
+        }
+        this->insertarEnCamino(pila, key, value);
+        return true;
+    }
+
+    // construye el valor con args solo si la key no existe; retorna el valor y si se inserto
+    template <typename... Args>
+    Pair<TV*, bool> try_emplace(const TK& key, Args&&... args) {
+        Camino pila;
+        if (this->findPathToKey(key, pila)) {
+            this->asegurarCamino(pila);
+            return {&pila.top().first->values[pila.top().second], false};
+        }
+
+        Pair<Node<TK, ORDEN, TV>*, int> pos = this->insertarEnCamino(pila, key, TV(std::forward<Args>(args)...));
+        if (pos.first == nullptr) // hubo splits, la key se movio
+            pos = this->buscarPosicion(key);
+        return {&pos.first->values[pos.second], true};
+    }
+
+    // valor de la key, insertando un valor por defecto si no existe
+    TV& operator[](const TK& key) {
+        return *try_emplace(key).first;
+    }
+
+    // Como BTree::split_at (oculta el del BTree): deja en este mapa las keys menores a key y
+    // retorna un mapa nuevo con las demas y sus valores (hay que liberarlo con delete).
+    BTreeMap* split_at(const TK& key) {
+        BTreeMap* derecho = new BTreeMap(*this, typename Base::DePedazo());
+        this->partirEn(key, *derecho);
+        return derecho;
+    }
+
+private:
+    BTreeMap(const BTreeMap& origen, typename Base::DePedazo pedazo) : Base(origen, pedazo) {}
+};
+
+#endif
@@ -0,0 +1,378 @@
+#ifndef COMPRESSEDBTREE_H
+#define COMPRESSEDBTREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Pair.h"
+
+// Codificacion de un bloque de keys ordenadas dentro de un arena de bytes. Cada codec da:
+//   codificar(keys, count, arena)  agrega el bloque al final del arena (alineado a 8)
+//   cantidad(bloque)               keys del bloque
+//   ubicar(bloque, key)            {cantidad de keys < key, si la siguiente es igual a key}
+//   clave(bloque, i)               key i decodificada
+template <typename TK, typename = void>
+struct CodecClaves {
+    static_assert(std::is_integral_v<TK>, "CompressedBTree soporta keys enteras y std::string");
+};
+
+namespace compresion {
+
+    inline void alinear(std::vector<char>& arena) {
+        arena.resize((arena.size() + 7) / 8 * 8, 0);
+    }
+
+    template <typename T>
+    inline void agregar(std::vector<char>& arena, const T& valor) {
+        const char* bytes = reinterpret_cast<const char*>(&valor);
+        arena.insert(arena.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    inline T leer(const char* p) {
+        T valor;
+        std::memcpy(&valor, p, sizeof(T));
+        return valor;
+    }
+
+}
+
+// Enteros con frame of reference: el bloque guarda la primera key (base) y las diferencias con
+// la base en el menor ancho que alcanza (1, 2, 4 u 8 bytes). Buscar en el bloque es contar
+// diferencias menores, que el compilador vectoriza.
+// [base][count (u32)][ancho (u32)][diferencias (count * ancho)]
+template <typename TK>
+struct CodecClaves<TK, std::enable_if_t<std::is_integral_v<TK>>> {
+    using U = std::make_unsigned_t<TK>;
+
+    static constexpr std::size_t OFFSET_CABECERA = (sizeof(TK) + 7) / 8 * 8;
+    static constexpr std::size_t OFFSET_DIFERENCIAS = OFFSET_CABECERA + 8;
+
+    static void codificar(const TK* keys, int count, std::vector<char>& arena) {
+        U rango = static_cast<U>(keys[count - 1]) - static_cast<U>(keys[0]);
+        std::uint32_t ancho = 1;
+        while (ancho < sizeof(U) && (rango >> (8 * ancho)) != 0)
+            ancho *= 2;
+        compresion::agregar(arena, keys[0]);
+        compresion::alinear(arena);
+        compresion::agregar(arena, static_cast<std::uint32_t>(count));
+        compresion::agregar(arena, ancho);
+        for (int i = 0; i < count; ++i) {
+            U diferencia = static_cast<U>(keys[i]) - static_cast<U>(keys[0]);
+            switch (ancho) {
+                case 1: compresion::agregar(arena, static_cast<std::uint8_t>(diferencia)); break;
+                case 2: compresion::agregar(arena, static_cast<std::uint16_t>(diferencia)); break;
+                case 4: compresion::agregar(arena, static_cast<std::uint32_t>(diferencia)); break;
+                default: compresion::agregar(arena, static_cast<std::uint64_t>(diferencia)); break;
+            }
+        }
+        compresion::alinear(arena);
+    }
+
+    static int cantidad(const char* bloque) {
+        return static_cast<int>(compresion::leer<std::uint32_t>(bloque + OFFSET_CABECERA));
+    }
+
+    static Pair<int, bool> ubicar(const char* bloque, const TK& key) {
+        TK base = compresion::leer<TK>(bloque);
+        int count = cantidad(bloque);
+        if (key < base)
+            return {0, false};
+        U diferencia = static_cast<U>(key) - static_cast<U>(base);
+        const char* diferencias = bloque + OFFSET_DIFERENCIAS;
+        switch (compresion::leer<std::uint32_t>(bloque + OFFSET_CABECERA + 4)) {
+            case 1: return contar(reinterpret_cast<const std::uint8_t*>(diferencias), count, diferencia);
+            case 2: return contar(reinterpret_cast<const std::uint16_t*>(diferencias), count, diferencia);
+            case 4: return contar(reinterpret_cast<const std::uint32_t*>(diferencias), count, diferencia);
+            default: return contar(reinterpret_cast<const std::uint64_t*>(diferencias), count, diferencia);
+        }
+    }
+
+    static TK clave(const char* bloque, int i) {
+        U base = static_cast<U>(compresion::leer<TK>(bloque));
+        const char* diferencias = bloque + OFFSET_DIFERENCIAS;
+        switch (compresion::leer<std::uint32_t>(bloque + OFFSET_CABECERA + 4)) {
+            case 1: return static_cast<TK>(base + reinterpret_cast<const std::uint8_t*>(diferencias)[i]);
+            case 2: return static_cast<TK>(base + reinterpret_cast<const std::uint16_t*>(diferencias)[i]);
+            case 4: return static_cast<TK>(base + reinterpret_cast<const std::uint32_t*>(diferencias)[i]);
+            default: return static_cast<TK>(base + reinterpret_cast<const std::uint64_t*>(diferencias)[i]);
+        }
+    }
+
+private:
+    template <typename D>
+    static Pair<int, bool> contar(const D* diferencias, int count, U diferencia) {
+        if (diferencia > static_cast<U>(diferencias[count - 1])) // tampoco entra en el ancho D
+            return {count, false};
+        D buscada = static_cast<D>(diferencia);
+        int menores = 0;
+        for (int i = 0; i < count; ++i)
+            menores += diferencias[i] < buscada;
+        return {menores, menores < count && diferencias[menores] == buscada};
+    }
+};
+
+// Strings con truncado de prefijo: el prefijo comun del bloque se guarda una vez y de cada key
+// queda el resto. Los primeros 8 bytes del resto van en una cabeza u64 (big endian, comparar
+// cabezas como enteros es comparar esos bytes), asi la busqueda binaria casi siempre se decide
+// sin tocar los bytes del arena.
+// [count (u32)][largo prefijo (u32)][prefijo][cabezas (u64)][largos (u32)][offsets (u32, count + 1)][restos]
+template <>
+struct CodecClaves<std::string> {
+    static void codificar(const std::string* keys, int count, std::vector<char>& arena) {
+        const std::string& primera = keys[0];
+        const std::string& ultima = keys[count - 1];
+        std::size_t prefijo = 0;
+        while (prefijo < primera.size() && prefijo < ultima.size() && primera[prefijo] == ultima[prefijo])
+            ++prefijo;
+
+        compresion::agregar(arena, static_cast<std::uint32_t>(count));
+        compresion::agregar(arena, static_cast<std::uint32_t>(prefijo));
+        arena.insert(arena.end(), primera.data(), primera.data() + prefijo);
+        compresion::alinear(arena);
+        for (int i = 0; i < count; ++i)
+            compresion::agregar(arena, cabeza(std::string_view(keys[i]).substr(prefijo)));
+        for (int i = 0; i < count; ++i)
+            compresion::agregar(arena, static_cast<std::uint32_t>(keys[i].size() - prefijo));
+        std::uint32_t offset = 0;
+        compresion::agregar(arena, offset);
+        for (int i = 0; i < count; ++i) {
+            offset += static_cast<std::uint32_t>(resto(std::string_view(keys[i]).substr(prefijo)).size());
+            compresion::agregar(arena, offset);
+        }
+        for (int i = 0; i < count; ++i) {
+            std::string_view r = resto(std::string_view(keys[i]).substr(prefijo));
+            arena.insert(arena.end(), r.begin(), r.end());
+        }
+        compresion::alinear(arena);
+    }
+
+    static int cantidad(const char* bloque) {
+        return static_cast<int>(compresion::leer<std::uint32_t>(bloque));
+    }
+
+    static Pair<int, bool> ubicar(const char* bloque, const std::string& key) {
+        Vista vista(bloque);
+        std::string_view prefijo(bloque + 8, vista.prefijo);
+        int c = std::string_view(key).substr(0, vista.prefijo).compare(prefijo);
+        if (c < 0 || (c == 0 && key.size() < vista.prefijo))
+            return {0, false};
+        if (c > 0)
+            return {vista.count, false};
+
+        std::string_view buscada = std::string_view(key).substr(vista.prefijo);
+        std::uint64_t h = cabeza(buscada);
+        int lo = 0, hi = vista.count;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            std::uint64_t hm = vista.cabeza(mid);
+            if (hm < h || (hm == h && vista.comparar(mid, buscada) < 0))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return {lo, lo < vista.count && vista.cabeza(lo) == h && vista.comparar(lo, buscada) == 0};
+    }
+
+    static std::string clave(const char* bloque, int i) {
+        Vista vista(bloque);
+        std::uint32_t largo = vista.largo(i);
+        std::string key(bloque + 8, vista.prefijo);
+        std::uint64_t h = vista.cabeza(i);
+        for (std::uint32_t j = 0; j < largo && j < 8; ++j)
+            key.push_back(static_cast<char>(h >> (56 - 8 * j)));
+        key.append(vista.resto(i));
+        return key;
+    }
+
+private:
+    static std::uint64_t cabeza(std::string_view s) {
+        std::uint64_t h = 0;
+        for (std::size_t j = 0; j < 8; ++j)
+            h = (h << 8) | (j < s.size() ? static_cast<unsigned char>(s[j]) : 0);
+        return h;
+    }
+
+    static std::string_view resto(std::string_view s) {
+        return s.size() > 8 ? s.substr(8) : std::string_view();
+    }
+
+    // lectura de los arrays de un bloque ya codificado
+    struct Vista {
+        const char* bloque;
+        int count;
+        std::uint32_t prefijo;
+        std::size_t offsetCabezas;
+
+        explicit Vista(const char* bloque_)
+            : bloque(bloque_), count(CodecClaves::cantidad(bloque_)),
+              prefijo(compresion::leer<std::uint32_t>(bloque_ + 4)),
+              offsetCabezas((8 + prefijo + 7) / 8 * 8) {}
+
+        std::uint64_t cabeza(int i) const {
+            return compresion::leer<std::uint64_t>(bloque + offsetCabezas + 8 * i);
+        }
+
+        std::uint32_t largo(int i) const {
+            return compresion::leer<std::uint32_t>(bloque + offsetCabezas + 8 * count + 4 * i);
+        }
+
+        std::uint32_t offset(int i) const {
+            return compresion::leer<std::uint32_t>(bloque + offsetCabezas + 12 * count + 4 * i);
+        }
+
+        std::string_view resto(int i) const {
+            const char* restos = bloque + offsetCabezas + 16 * count + 4;
+            return std::string_view(restos + offset(i), offset(i + 1) - offset(i));
+        }
+
+        // compara la key i con buscada (ambas sin el prefijo) cuando las cabezas son iguales
+        int comparar(int i, std::string_view buscada) const {
+            int c = resto(i).compare(CodecClaves::resto(buscada));
+            if (c != 0)
+                return c;
+            return (largo(i) > buscada.size()) - (largo(i) < buscada.size());
+        }
+    };
+};
+
+// Arbol B+ estatico (solo lectura) con las keys comprimidas: las hojas son bloques de hasta B
+// keys codificados con CodecClaves<TK> y cada nivel interno son bloques con la primera key de
+// B bloques del nivel de abajo. Los bloques de un nivel van seguidos en un arena de bytes y el
+// hijo j del bloque b es el bloque b * B + j del nivel siguiente, asi no hay punteros.
+// Se arma de una vez desde keys ordenadas (por ejemplo el recorrido de un BTree).
+template <typename TK, int B = 64>
+class CompressedBTree {
+    static_assert(B >= 2, "Un bloque necesita al menos 2 keys");
+
+private:
+    using Codec = CodecClaves<TK>;
+
+    struct Nivel {
+        std::vector<char> arena;
+        std::vector<std::size_t> inicios; // offset de cada bloque en el arena
+
+        const char* bloque(std::size_t b) const {
+            return arena.data() + inicios[b];
+        }
+    };
+
+    std::vector<Nivel> niveles; // niveles[0] son las hojas
+    std::size_t n;
+
+public:
+    CompressedBTree() : n(0) {}
+
+    explicit CompressedBTree(const std::vector<TK>& elements) : CompressedBTree(elements.begin(), elements.end()) {}
+
+    // keys en orden estrictamente creciente
+    template <typename It>
+    CompressedBTree(It begin, It end) : n(0) {
+        std::vector<TK> actuales(begin, end);
+        for (std::size_t i = 1; i < actuales.size(); ++i) {
+            if (!(actuales[i - 1] < actuales[i]))
+                throw std::invalid_argument("Las keys deben estar ordenadas y sin repetidos");
+        }
+        n = actuales.size();
+        while (!actuales.empty()) {
+            Nivel nivel;
+            std::vector<TK> primeras;
+            for (std::size_t i = 0; i < actuales.size(); i += B) {
+                int count = static_cast<int>(std::min<std::size_t>(B, actuales.size() - i));
+                nivel.inicios.push_back(nivel.arena.size());
+                Codec::codificar(&actuales[i], count, nivel.arena);
+                primeras.push_back(actuales[i]);
+            }
+            nivel.arena.shrink_to_fit();
+            niveles.push_back(std::move(nivel));
+            if (primeras.size() == 1)
+                break;
+            actuales.swap(primeras);
+        }
+    }
+
+    bool search(const TK& key) const {
+        Pair<std::size_t, int> pos = ubicarEnHoja(key);
+        if (pos.second < 0)
+            return false;
+        return Codec::ubicar(niveles[0].bloque(pos.first), key).second;
+    }
+
+    std::vector<TK> rangeSearch(const TK& begin, const TK& end) const {
+        std::vector<TK> result;
+        if (n == 0 || end < begin)
+            return result;
+        Pair<std::size_t, int> pos = ubicarEnHoja(begin);
+        std::size_t b = pos.first;
+        int i = pos.second < 0 ? 0 : Codec::ubicar(niveles[0].bloque(b), begin).first;
+        for (; b < niveles[0].inicios.size(); ++b, i = 0) {
+            const char* bloque = niveles[0].bloque(b);
+            for (int count = Codec::cantidad(bloque); i < count; ++i) {
+                TK key = Codec::clave(bloque, i);
+                if (end < key)
+                    return result;
+                result.push_back(std::move(key));
+            }
+        }
+        return result;
+    }
+
+    TK minKey() const {
+        if (n == 0)
+            throw std::runtime_error("Arbol vacio");
+        return Codec::clave(niveles[0].bloque(0), 0);
+    }
+
+    TK maxKey() const {
+        if (n == 0)
+            throw std::runtime_error("Arbol vacio");
+        const char* ultimo = niveles[0].bloque(niveles[0].inicios.size() - 1);
+        return Codec::clave(ultimo, Codec::cantidad(ultimo) - 1);
+    }
+
+    int height() const {
+        return niveles.empty() ? 0 : static_cast<int>(niveles.size()) - 1;
+    }
+
+    int size() const {
+        return static_cast<int>(n);
+    }
+
+    bool empty() const {
+        return n == 0;
+    }
+
+    // bytes de los arenas y de los offsets de bloques
+    std::size_t bytes() const {
+        std::size_t total = 0;
+        for (const Nivel& nivel : niveles)
+            total += nivel.arena.capacity() + nivel.inicios.capacity() * sizeof(std::size_t);
+        return total;
+    }
+
+private:
+    // hoja donde estaria key y -1 si key es menor que todas las keys del arbol
+    Pair<std::size_t, int> ubicarEnHoja(const TK& key) const {
+        if (n == 0)
+            return {0, -1};
+        std::size_t b = 0;
+        for (std::size_t nivel = niveles.size() - 1; nivel > 0; --nivel) {
+            // hijo con la ultima primera-key <= key
+            Pair<int, bool> pos = Codec::ubicar(niveles[nivel].bloque(b), key);
+            int j = pos.second ? pos.first : pos.first - 1;
+            if (j < 0)
+                return {0, -1};
+            b = b * B + j;
+        }
+        return {b, 0};
+    }
+};
+
+#endif
@@ -0,0 +1,653 @@
+#ifndef CONCURRENTBTREE_H
+#define CONCURRENTBTREE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "btree.h"
+
+// Nodo del arbol concurrente: mismo bloque que BPlusNode pero con un latch de version.
+// version: bit 0 = obsoleto (el nodo salio del arbol), bit 1 = bloqueado por un escritor,
+// el resto cuenta las modificaciones. Un lector lee la version, lee el nodo sin bloquear y
+// valida que la version no cambio; si cambio, reintenta.
+// count, keys y children se leen mientras un escritor los cambia, por eso son atomicos: los
+// escritores guardan con release y los lectores cargan con acquire (en x86 son movs comunes),
+// asi ninguna lectura del nodo se mueve despues de la validacion de la version.
+template <typename TK>
+struct ConcurrentNode {
+    std::atomic<std::uint64_t> version;
+    // array de keys (separadores en los nodos internos)
+    std::atomic<TK>* keys;
+    // array de punteros a hijos (nullptr si es hoja)
+    std::atomic<ConcurrentNode*>* children;
+    // cantidad de keys
+    std::atomic<int> count;
+    // indicador de nodo hoja (no cambia mientras el nodo esta en el arbol)
+    bool leaf;
+
+    static constexpr std::size_t ALINEACION = std::max<std::size_t>(64, alignof(std::atomic<TK>));
+
+    static constexpr std::size_t alinear(std::size_t x, std::size_t a) {
+        return (x + a - 1) / a * a;
+    }
+
+    static constexpr std::size_t offsetKeys() {
+        return alinear(sizeof(ConcurrentNode), alignof(std::atomic<TK>));
+    }
+
+    static constexpr std::size_t offsetChildren(const int& M) {
+        return alinear(offsetKeys() + (M - 1) * sizeof(std::atomic<TK>), alignof(std::atomic<ConcurrentNode*>));
+    }
+
+    static constexpr std::size_t bytes(const int& M, bool leaf) {
+        return alinear(leaf ? offsetChildren(M) : offsetChildren(M) + M * sizeof(std::atomic<ConcurrentNode*>), ALINEACION);
+    }
+
+    static ConcurrentNode* create(void* memoria, const int& M, bool leaf) {
+        char* bloque = static_cast<char*>(memoria);
+        ConcurrentNode* node = new (bloque) ConcurrentNode();
+        node->keys = reinterpret_cast<std::atomic<TK>*>(bloque + offsetKeys());
+        for (int i = 0; i < M - 1; ++i)
+            new (&node->keys[i]) std::atomic<TK>(TK());
+        if (!leaf) {
+            node->children = reinterpret_cast<std::atomic<ConcurrentNode*>*>(bloque + offsetChildren(M));
+            for (int i = 0; i < M; ++i)
+                new (&node->children[i]) std::atomic<ConcurrentNode*>(nullptr);
+        }
+        node->leaf = leaf;
+        return node;
+    }
+
+private:
+    ConcurrentNode() : version(0), keys(nullptr), children(nullptr), count(0), leaf(true) {}
+};
+
+
+// Arbol B+ para varios hilos con optimistic lock coupling:
+//  - search no bloquea nada: baja validando la version de cada nodo y reintenta si cambio
+//  - insert/remove bajan igual y solo bloquean los nodos que modifican: la hoja, y al partir,
+//    rotar o fusionar, el nodo, su padre (y el hermano)
+//  - los nodos llenos se parten y los que estan en el minimo se arreglan al bajar (top-down),
+//    asi un cambio nunca sube mas de un nivel. Por eso M debe ser par: dos nodos en el minimo
+//    mas el separador caben en un nodo.
+// Las keys se leen sin bloquear mientras un escritor las puede estar copiando, asi que cada una
+// es un std::atomic<TK> sin lock (TK trivialmente copiable de 1, 2, 4 u 8 bytes).
+// Los nodos que salen del arbol no se devuelven al pool enseguida (un lector puede seguir
+// leyendolos): cada operacion se anota en la epoca actual y un nodo retirado vuelve al pool
+// cuando ya terminaron todas las operaciones que lo pudieron ver (ver Seccion).
+template <typename TK>
+class ConcurrentBTree : private OrdenArbol<0> {
+    static_assert(std::is_trivially_copyable_v<TK>, "ConcurrentBTree necesita keys trivialmente copiables");
+    static_assert(std::atomic<TK>::is_always_lock_free, "ConcurrentBTree necesita keys que entren en un atomico sin lock");
+
+private:
+    using OrdenArbol<0>::M;
+    using OrdenArbol<0>::minKeys;
+
+    using Nodo = ConcurrentNode<TK>;
+
+    static constexpr std::uint64_t OBSOLETO = 1;
+    static constexpr std::uint64_t BLOQUEADO = 2;
+
+    std::atomic<Nodo*> root;
+    std::atomic<int> n; // total de elementos en el arbol
+
+    std::mutex mutexPool; // solo para pedir y devolver bloques; leer y escribir nodos no pasa por aqui
+    NodePool poolHojas;
+    NodePool poolInternos;
+
+    // Reclamacion por epocas: cada operacion suma 1 en activos[epoca % 3] de la ranura de su
+    // hilo mientras dura (las ranuras reparten los contadores para que los hilos no compartan
+    // una linea de cache). Los nodos retirados en la epoca e van a retirados[e % 3], con mutexPool.
+    static constexpr int RANURAS = 16;
+
+    struct alignas(64) Ranura {
+        std::atomic<int> activos[3];
+
+        Ranura() {
+            for (std::atomic<int>& a : activos)
+                a.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    std::atomic<std::uint64_t> epoca;
+    mutable Ranura ranuras[RANURAS];
+    std::vector<Nodo*> retirados[3];
+
+public:
+    explicit ConcurrentBTree(const int& M_, std::pmr::memory_resource* recurso = std::pmr::get_default_resource())
+        : OrdenArbol<0>(M_), root(nullptr), n(0),
+          poolHojas(Nodo::bytes(M, true), Nodo::ALINEACION, recurso),
+          poolInternos(Nodo::bytes(M, false), Nodo::ALINEACION, recurso), epoca(0) {
+        if (M % 2 != 0)
+            throw std::invalid_argument("El grado del arbol concurrente debe ser par");
+        root.store(nuevoNodo(true));
+    }
+
+    ConcurrentBTree(const ConcurrentBTree&) = delete;
+    ConcurrentBTree& operator=(const ConcurrentBTree&) = delete;
+
+    bool search(const TK& key) const {
+        Seccion seccion(*this);
+        while (true) {
+            Nodo* node;
+            std::uint64_t v;
+            if (!leerRaiz(node, v))
+                continue;
+
+            bool reiniciar = false;
+            while (!node->leaf) {
+                int i = indiceHijo(node, key);
+                if (!bajar(node, v, hijo(node, i))) {
+                    reiniciar = true;
+                    break;
+                }
+            }
+            if (reiniciar)
+                continue;
+
+            int count = leerCount(node);
+            int i = posicion(node, count, key);
+            bool existe = i < count && !(key < clave(node, i));
+            if (validar(node, v))
+                return existe;
+        }
+    }
+
+    // retorna false si la key ya existia
+    bool insert(const TK& key) {
+        Seccion seccion(*this);
+        while (true) {
+            Nodo* node;
+            std::uint64_t v;
+            if (!leerRaiz(node, v))
+                continue;
+            Nodo* parent = nullptr;
+            std::uint64_t vParent = 0;
+            int iParent = 0;
+
+            bool reiniciar = false;
+            while (true) {
+                if (leerCount(node) == M - 1) { // lleno: se parte antes de seguir bajando
+                    if (bloquearConPadre(node, v, parent, vParent)) {
+                        split(node, parent, iParent);
+                        desbloquear(node);
+                        if (parent != nullptr)
+                            desbloquear(parent);
+                    }
+                    reiniciar = true;
+                    break;
+                }
+                if (node->leaf)
+                    break;
+                int i = indiceHijo(node, key);
+                parent = node;
+                vParent = v;
+                iParent = i;
+                if (!bajar(node, v, hijo(node, i))) {
+                    reiniciar = true;
+                    break;
+                }
+            }
+            if (reiniciar)
+                continue;
+
+            // hoja con espacio: solo se bloquea la hoja
+            int count = leerCount(node);
+            int i = posicion(node, count, key);
+            if (i < count && !(key < clave(node, i))) {
+                if (validar(node, v))
+                    return false;
+                continue;
+            }
+            if (!bloquear(node, v))
+                continue;
+            for (int j = count; j > i; --j)
+                ponerClave(node, j, clave(node, j - 1));
+            ponerClave(node, i, key);
+            ponerCount(node, count + 1);
+            desbloquear(node);
+            n.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // retorna false si la key no estaba
+    bool remove(const TK& key) {
+        Seccion seccion(*this);
+        while (true) {
+            Nodo* node;
+            std::uint64_t v;
+            if (!leerRaiz(node, v))
+                continue;
+            Nodo* parent = nullptr;
+            std::uint64_t vParent = 0;
+            int iParent = 0;
+
+            bool reiniciar = false;
+            while (true) {
+                if (parent != nullptr && leerCount(node) <= minKeys) { // en el minimo: se arregla antes de bajar
+                    arreglar(node, v, parent, vParent, iParent);
+                    reiniciar = true;
+                    break;
+                }
+                if (node->leaf)
+                    break;
+                int i = indiceHijo(node, key);
+                parent = node;
+                vParent = v;
+                iParent = i;
+                if (!bajar(node, v, hijo(node, i))) {
+                    reiniciar = true;
+                    break;
+                }
+            }
+            if (reiniciar)
+                continue;
+
+            // la hoja tiene mas del minimo (o es la raiz): solo se bloquea la hoja
+            int count = leerCount(node);
+            int i = posicion(node, count, key);
+            if (i >= count || key < clave(node, i)) {
+                if (validar(node, v))
+                    return false;
+                continue;
+            }
+            if (!bloquear(node, v))
+                continue;
+            for (int j = i; j < count - 1; ++j)
+                ponerClave(node, j, clave(node, j + 1));
+            ponerCount(node, count - 1);
+            desbloquear(node);
+            n.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    int size() const {
+        return n.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // las siguientes solo son validas sin escritores concurrentes
+    int height() const {
+        int height = 0;
+        for (Nodo* current = root.load(); !current->leaf; current = hijo(current, 0))
+            ++height;
+        return height;
+    }
+
+    bool check_properties() const {
+        int nivelHojas = -1;
+        long total = 0;
+        return check_properties_rec(root.load(), nullptr, nullptr, 0, nivelHojas, total) && total == n.load();
+    }
+
+private:
+    Nodo* nuevoNodo(bool leaf) {
+        std::lock_guard<std::mutex> guard(mutexPool);
+        NodePool& pool = leaf ? poolHojas : poolInternos;
+        return Nodo::create(pool.reservar(), M, leaf);
+    }
+
+    // Campos que cambian con el nodo en el arbol. Sin el nodo bloqueado un valor leido solo se
+    // usa si despues la version no cambio.
+    static int leerCount(const Nodo* node) {
+        return node->count.load(std::memory_order_acquire);
+    }
+
+    static void ponerCount(Nodo* node, int count) {
+        node->count.store(count, std::memory_order_release);
+    }
+
+    static TK clave(const Nodo* node, int i) {
+        return node->keys[i].load(std::memory_order_acquire);
+    }
+
+    static void ponerClave(Nodo* node, int i, const TK& key) {
+        node->keys[i].store(key, std::memory_order_release);
+    }
+
+    static Nodo* hijo(const Nodo* node, int i) {
+        return node->children[i].load(std::memory_order_acquire);
+    }
+
+    static void ponerHijo(Nodo* node, int i, Nodo* child) {
+        node->children[i].store(child, std::memory_order_release);
+    }
+
+    // primera posicion con una key >= key, recorriendo las keys en orden: las cargas no dependen
+    // entre si (una busqueda binaria encadenaria un fallo de cache por paso). El array y la key van
+    // a variables locales porque cada carga atomica obliga al compilador a releer la memoria.
+    static int posicion(const Nodo* node, int count, const TK& key) {
+        const std::atomic<TK>* keys = node->keys;
+        const TK buscada = key;
+        int i = 0;
+        while (i < count && keys[i].load(std::memory_order_acquire) < buscada)
+            ++i;
+        return i;
+    }
+
+    // hijo por el que se baja buscando key: los separadores iguales a key quedan a la izquierda
+    static int indiceHijo(const Nodo* node, const TK& key) {
+        int count = leerCount(node);
+        int i = posicion(node, count, key);
+        if (i < count && !(key < clave(node, i)))
+            ++i;
+        return i;
+    }
+
+    // -------------------- reclamacion de nodos ---------------
+
+    static std::size_t ranuraDelHilo() {
+        thread_local const std::size_t ranura = std::hash<std::thread::id>()(std::this_thread::get_id()) % RANURAS;
+        return ranura;
+    }
+
+    // Mientras vive, la operacion queda anotada en la epoca que leyo al empezar: los nodos que
+    // se retiren no vuelven al pool hasta que termine.
+    class Seccion {
+    public:
+        explicit Seccion(const ConcurrentBTree& arbol) {
+            Ranura& ranura = arbol.ranuras[ranuraDelHilo()];
+            while (true) {
+                std::uint64_t e = arbol.epoca.load();
+                activos = &ranura.activos[e % 3];
+                activos->fetch_add(1);
+                if (arbol.epoca.load() == e) // si la epoca avanzo en el medio, se anota en la nueva
+                    break;
+                activos->fetch_sub(1);
+            }
+        }
+
+        ~Seccion() {
+            activos->fetch_sub(1, std::memory_order_release);
+        }
+
+        Seccion(const Seccion&) = delete;
+        Seccion& operator=(const Seccion&) = delete;
+
+    private:
+        std::atomic<int>* activos;
+    };
+
+    // el nodo ya salio del arbol (esta marcado obsoleto)
+    void retirar(Nodo* node) {
+        std::lock_guard<std::mutex> guard(mutexPool);
+        std::uint64_t e = epoca.load();
+        retirados[e % 3].push_back(node);
+        avanzarEpoca(e);
+    }
+
+    // Con mutexPool. Si terminaron las operaciones anotadas en e - 1 (las de e - 2 y antes ya
+    // habian terminado al pasar a e), pasa a e + 1 y devuelve los nodos retirados en e - 2:
+    // solo los pudo ver una operacion empezada antes de retirarlos, y ninguna sigue activa.
+    void avanzarEpoca(std::uint64_t e) {
+        for (const Ranura& ranura : ranuras) {
+            if (ranura.activos[(e + 2) % 3].load() != 0)
+                return;
+        }
+        std::vector<Nodo*>& libres = retirados[(e + 1) % 3];
+        for (Nodo* node : libres)
+            (node->leaf ? poolHojas : poolInternos).devolver(node);
+        libres.clear();
+        epoca.store(e + 1);
+    }
+
+    // -------------------- latches de version ---------------
+
+    // espera a que nadie escriba el nodo; false si el nodo ya no esta en el arbol
+    static bool leerVersion(const Nodo* node, std::uint64_t& v) {
+        v = node->version.load(std::memory_order_acquire);
+        while (v & BLOQUEADO) {
+            std::this_thread::yield();
+            v = node->version.load(std::memory_order_acquire);
+        }
+        return !(v & OBSOLETO);
+    }
+
+    // las lecturas hechas desde que se obtuvo v son consistentes si la version no cambio (son
+    // acquire, asi que ninguna se mueve despues de esta carga)
+    static bool validar(const Nodo* node, std::uint64_t v) {
+        return node->version.load(std::memory_order_acquire) == v;
+    }
+
+    // Cada escritura al nodo bloqueado es release: un lector que lee un valor nuevo ve tambien
+    // el bloqueo y falla al validar.
+    static bool bloquear(Nodo* node, std::uint64_t v) {
+        return node->version.compare_exchange_strong(v, v + BLOQUEADO, std::memory_order_acquire);
+    }
+
+    static void desbloquear(Nodo* node) {
+        node->version.fetch_add(BLOQUEADO, std::memory_order_release);
+    }
+
+    static void desbloquearObsoleto(Nodo* node) {
+        node->version.fetch_add(BLOQUEADO + OBSOLETO, std::memory_order_release);
+    }
+
+    bool leerRaiz(Nodo*& node, std::uint64_t& v) const {
+        node = root.load(std::memory_order_acquire);
+        // la raiz solo cambia con la raiz anterior bloqueada: si sigue siendo la raiz con la
+        // version v, los cambios de raiz posteriores se detectan al validar v
+        return leerVersion(node, v) && node == root.load(std::memory_order_acquire);
+    }
+
+    // acoplamiento: obtiene la version del hijo y recien despues valida al padre
+    static bool bajar(Nodo*& node, std::uint64_t& v, Nodo* hijo) {
+        if (!validar(node, v))
+            return false;
+        std::uint64_t vHijo;
+        if (!leerVersion(hijo, vHijo) || !validar(node, v))
+            return false;
+        node = hijo;
+        v = vHijo;
+        return true;
+    }
+
+    bool bloquearConPadre(Nodo* node, std::uint64_t v, Nodo* parent, std::uint64_t vParent) {
+        if (parent != nullptr && !bloquear(parent, vParent))
+            return false;
+        if (!bloquear(node, v)) {
+            if (parent != nullptr)
+                desbloquear(parent);
+            return false;
+        }
+        return true;
+    }
+
+    // -------------------- cambios de estructura (con los nodos bloqueados) ---------------
+
+    // parte un nodo lleno; el separador va al padre, que tiene espacio porque al bajar se parten
+    // los nodos llenos. Sin padre, el nodo es la raiz y se crea una nueva.
+    void split(Nodo* node, Nodo* parent, int iParent) {
+        Nodo* rightNode = nuevoNodo(node->leaf);
+        const int count = leerCount(node);
+        TK separador;
+        if (node->leaf) {
+            int izquierda = count / 2;
+            for (int i = izquierda, j = 0; i < count; ++i, ++j)
+                ponerClave(rightNode, j, clave(node, i));
+            ponerCount(rightNode, count - izquierda);
+            ponerCount(node, izquierda);
+            separador = clave(rightNode, 0);
+        } else {
+            int medianIndex = count / 2;
+            separador = clave(node, medianIndex);
+            for (int i = medianIndex + 1, j = 0; i < count; ++i, ++j)
+                ponerClave(rightNode, j, clave(node, i));
+            for (int i = medianIndex + 1, j = 0; i <= count; ++i, ++j)
+                ponerHijo(rightNode, j, hijo(node, i));
+            ponerCount(rightNode, count - medianIndex - 1);
+            ponerCount(node, medianIndex);
+        }
+
+        if (parent == nullptr) {
+            Nodo* nuevaRaiz = nuevoNodo(false);
+            ponerClave(nuevaRaiz, 0, separador);
+            ponerHijo(nuevaRaiz, 0, node);
+            ponerHijo(nuevaRaiz, 1, rightNode);
+            ponerCount(nuevaRaiz, 1);
+            root.store(nuevaRaiz, std::memory_order_release);
+            return;
+        }
+        const int countParent = leerCount(parent);
+        for (int i = countParent; i > iParent; --i)
+            ponerClave(parent, i, clave(parent, i - 1));
+        for (int i = countParent + 1; i > iParent + 1; --i)
+            ponerHijo(parent, i, hijo(parent, i - 1));
+        ponerClave(parent, iParent, separador);
+        ponerHijo(parent, iParent + 1, rightNode);
+        ponerCount(parent, countParent + 1);
+    }
+
+    // Deja al hijo iParent del padre con mas del minimo rotando con un hermano o fusionandolo.
+    // Bloquea padre, nodo y hermano; si alguno cambio desde que se leyo no hace nada.
+    void arreglar(Nodo* node, std::uint64_t v, Nodo* parent, std::uint64_t vParent, int iParent) {
+        if (!bloquearConPadre(node, v, parent, vParent))
+            return;
+        bool conDerecho = iParent < leerCount(parent);
+        Nodo* sibling = hijo(parent, conDerecho ? iParent + 1 : iParent - 1);
+        // sin esperar: con padre y nodo bloqueados solo se intenta una vez
+        std::uint64_t vSibling = sibling->version.load(std::memory_order_acquire);
+        if ((vSibling & (OBSOLETO | BLOQUEADO)) || !bloquear(sibling, vSibling)) {
+            desbloquear(node);
+            desbloquear(parent);
+            return;
+        }
+
+        Nodo* izquierdo = conDerecho ? node : sibling;
+        Nodo* derecho = conDerecho ? sibling : node;
+        int iSeparador = conDerecho ? iParent : iParent - 1;
+        if (leerCount(sibling) > minKeys) {
+            rotate(izquierdo, derecho, parent, iSeparador, !conDerecho);
+            desbloquear(sibling);
+            desbloquear(node);
+            desbloquear(parent);
+            return;
+        }
+
+        merge(izquierdo, derecho, parent, iSeparador);
+        desbloquearObsoleto(derecho); // puede haber lectores en el: vuelve al pool por epocas
+        desbloquear(izquierdo);
+        bool sinRaiz = leerCount(parent) == 0; // solo la raiz puede quedarse sin keys
+        if (sinRaiz) {
+            root.store(izquierdo, std::memory_order_release);
+            desbloquearObsoleto(parent);
+        } else {
+            desbloquear(parent);
+        }
+        retirar(derecho);
+        if (sinRaiz)
+            retirar(parent);
+    }
+
+    // pasa una key del hermano con keys de sobra al que esta en el minimo
+    // haciaDerecho = true -> del izquierdo al derecho
+    static void rotate(Nodo* izquierdo, Nodo* derecho, Nodo* parent, int iSeparador, bool haciaDerecho) {
+        const int countIzquierdo = leerCount(izquierdo);
+        const int countDerecho = leerCount(derecho);
+        if (haciaDerecho) {
+            for (int i = countDerecho; i > 0; --i)
+                ponerClave(derecho, i, clave(derecho, i - 1));
+            if (derecho->leaf) {
+                ponerClave(derecho, 0, clave(izquierdo, countIzquierdo - 1));
+                ponerClave(parent, iSeparador, clave(derecho, 0));
+            } else {
+                for (int i = countDerecho + 1; i > 0; --i)
+                    ponerHijo(derecho, i, hijo(derecho, i - 1));
+                ponerClave(derecho, 0, clave(parent, iSeparador));
+                ponerHijo(derecho, 0, hijo(izquierdo, countIzquierdo));
+                ponerClave(parent, iSeparador, clave(izquierdo, countIzquierdo - 1));
+            }
+            ponerCount(derecho, countDerecho + 1);
+            ponerCount(izquierdo, countIzquierdo - 1);
+        } else {
+            if (izquierdo->leaf) {
+                ponerClave(izquierdo, countIzquierdo, clave(derecho, 0));
+                ponerClave(parent, iSeparador, clave(derecho, 1));
+            } else {
+                ponerClave(izquierdo, countIzquierdo, clave(parent, iSeparador));
+                ponerHijo(izquierdo, countIzquierdo + 1, hijo(derecho, 0));
+                ponerClave(parent, iSeparador, clave(derecho, 0));
+                for (int i = 0; i < countDerecho; ++i)
+                    ponerHijo(derecho, i, hijo(derecho, i + 1));
+            }
+            for (int i = 0; i < countDerecho - 1; ++i)
+                ponerClave(derecho, i, clave(derecho, i + 1));
+            ponerCount(izquierdo, countIzquierdo + 1);
+            ponerCount(derecho, countDerecho - 1);
+        }
+    }
+
+    // junta el derecho en el izquierdo y quita el separador del padre
+    static void merge(Nodo* izquierdo, Nodo* derecho, Nodo* parent, int iSeparador) {
+        int countIzquierdo = leerCount(izquierdo);
+        const int countDerecho = leerCount(derecho);
+        if (!izquierdo->leaf) {
+            ponerClave(izquierdo, countIzquierdo++, clave(parent, iSeparador));
+            for (int i = 0; i <= countDerecho; ++i)
+                ponerHijo(izquierdo, countIzquierdo + i, hijo(derecho, i));
+        }
+        for (int i = 0; i < countDerecho; ++i)
+            ponerClave(izquierdo, countIzquierdo + i, clave(derecho, i));
+        ponerCount(izquierdo, countIzquierdo + countDerecho);
+
+        const int countParent = leerCount(parent);
+        for (int i = iSeparador; i < countParent - 1; ++i)
+            ponerClave(parent, i, clave(parent, i + 1));
+        for (int i = iSeparador + 1; i < countParent; ++i)
+            ponerHijo(parent, i, hijo(parent, i + 1));
+        ponerCount(parent, countParent - 1);
+    }
+
+    bool check_properties_rec(Nodo* node, const TK* inferior, const TK* superior, int nivel,
+                              int& nivelHojas, long& total) const {
+        const int count = leerCount(node);
+        if (count > M - 1)
+            return false;
+        if (node != root.load() && count < minKeys)
+            return false;
+        if (node->version.load() & (OBSOLETO | BLOQUEADO))
+            return false;
+        std::vector<TK> keys(count);
+        for (int i = 0; i < count; ++i) {
+            keys[i] = clave(node, i);
+            if (i > 0 && !(keys[i - 1] < keys[i]))
+                return false;
+            if (inferior != nullptr && keys[i] < *inferior)
+                return false;
+            if (superior != nullptr && !(keys[i] < *superior))
+                return false;
+        }
+
+        if (node->leaf) {
+            if (nivelHojas == -1)
+                nivelHojas = nivel;
+            total += count;
+            return nivelHojas == nivel;
+        }
+        if (count == 0)
+            return false;
+        for (int i = 0; i <= count; ++i) {
+            const TK* inf = i == 0 ? inferior : &keys[i - 1];
+            const TK* sup = i == count ? superior : &keys[i];
+            if (!check_properties_rec(hijo(node, i), inf, sup, nivel + 1, nivelHojas, total))
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
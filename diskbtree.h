@@ -0,0 +1,725 @@
+#ifndef DISKBTREE_H
+#define DISKBTREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "btree.h"
+
+// contadores de E/S del arbol en disco
+struct EstadisticasDisco {
+    std::uint64_t aciertos = 0;   // paginas encontradas en el buffer pool
+    std::uint64_t fallos = 0;     // paginas que hubo que leer del archivo (page faults del pool)
+    std::uint64_t lecturas = 0;   // pread de paginas
+    std::uint64_t escrituras = 0; // pwrite de paginas (desalojos de paginas sucias y flush)
+};
+
+// Archivo de paginas de tamaño fijo leidas y escritas con pread/pwrite.
+class ArchivoPaginas {
+private:
+    int fd;
+    std::size_t bytesPagina;
+
+public:
+    ArchivoPaginas(const std::string& ruta, std::size_t bytesPagina_) : fd(-1), bytesPagina(bytesPagina_) {
+        fd = ::open(ruta.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            throw std::runtime_error("No se pudo abrir " + ruta);
+    }
+
+    ArchivoPaginas(const ArchivoPaginas&) = delete;
+    ArchivoPaginas& operator=(const ArchivoPaginas&) = delete;
+
+    ~ArchivoPaginas() {
+        ::close(fd);
+    }
+
+    std::size_t bytes() const {
+        struct stat info;
+        if (::fstat(fd, &info) != 0)
+            throw std::runtime_error("No se pudo leer el tamaño del archivo");
+        return static_cast<std::size_t>(info.st_size);
+    }
+
+    void leer(std::uint32_t pagina, void* destino) const {
+        ssize_t leidos = ::pread(fd, destino, bytesPagina, static_cast<off_t>(pagina) * bytesPagina);
+        if (leidos < 0)
+            throw std::runtime_error("Error leyendo una pagina");
+        // una pagina nueva que aun no llego al archivo se lee como ceros
+        std::memset(static_cast<char*>(destino) + leidos, 0, bytesPagina - leidos);
+    }
+
+    void escribir(std::uint32_t pagina, const void* origen) {
+        if (::pwrite(fd, origen, bytesPagina, static_cast<off_t>(pagina) * bytesPagina)
+            != static_cast<ssize_t>(bytesPagina))
+            throw std::runtime_error("Error escribiendo una pagina");
+    }
+
+    // espera a que lo escrito llegue al disco
+    void sincronizar() {
+        if (::fsync(fd) != 0)
+            throw std::runtime_error("Error sincronizando el archivo");
+    }
+};
+
+// Cache acotada de paginas con desalojo CLOCK. Las paginas fijadas (pin) no se desalojan;
+// las sucias se escriben al archivo al desalojarlas o en flush().
+class BufferPool {
+private:
+    struct Marco {
+        std::uint32_t pagina;
+        int fijas;
+        bool sucia;
+        bool referenciada;
+        bool valida;
+    };
+
+    ArchivoPaginas& archivo;
+    std::size_t bytesPagina;
+    std::vector<Marco> marcos;
+    char* memoria;
+    std::unordered_map<std::uint32_t, int> tabla; // pagina -> marco
+    std::size_t manecilla;
+    EstadisticasDisco& estadisticas;
+
+    void escribirMarco(int m) {
+        archivo.escribir(marcos[m].pagina, datos(m));
+        marcos[m].sucia = false;
+        ++estadisticas.escrituras;
+    }
+
+    // CLOCK: la manecilla da vueltas quitando el bit de referencia hasta encontrar un marco libre
+    int victima() {
+        for (std::size_t vueltas = 0; vueltas < 2 * marcos.size() + 1; ++vueltas) {
+            int m = static_cast<int>(manecilla);
+            manecilla = (manecilla + 1) % marcos.size();
+            Marco& marco = marcos[m];
+            if (!marco.valida)
+                return m;
+            if (marco.fijas > 0)
+                continue;
+            if (marco.referenciada) {
+                marco.referenciada = false;
+                continue;
+            }
+            if (marco.sucia)
+                escribirMarco(m);
+            tabla.erase(marco.pagina);
+            marco.valida = false;
+            return m;
+        }
+        throw std::runtime_error("Buffer pool sin marcos libres");
+    }
+
+public:
+    BufferPool(ArchivoPaginas& archivo_, std::size_t bytesPagina_, std::size_t capacidad, EstadisticasDisco& estadisticas_)
+        : archivo(archivo_), bytesPagina(bytesPagina_), marcos(capacidad, Marco{0, 0, false, false, false}),
+          memoria(static_cast<char*>(::operator new(capacidad * bytesPagina_, std::align_val_t(64)))),
+          manecilla(0), estadisticas(estadisticas_) {
+        tabla.reserve(capacidad);
+    }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    ~BufferPool() {
+        ::operator delete(memoria, std::align_val_t(64));
+    }
+
+    char* datos(int m) const {
+        return memoria + static_cast<std::size_t>(m) * bytesPagina;
+    }
+
+    // fija la pagina en un marco; nueva = true no la lee del archivo (pagina recien asignada)
+    int fijar(std::uint32_t pagina, bool nueva = false) {
+        auto it = tabla.find(pagina);
+        if (it != tabla.end()) {
+            Marco& marco = marcos[it->second];
+            ++marco.fijas;
+            marco.referenciada = true;
+            ++estadisticas.aciertos;
+            return it->second;
+        }
+        int m = victima();
+        if (nueva) {
+            std::memset(datos(m), 0, bytesPagina);
+        } else {
+            archivo.leer(pagina, datos(m));
+            ++estadisticas.fallos;
+            ++estadisticas.lecturas;
+        }
+        marcos[m] = Marco{pagina, 1, nueva, true, true};
+        tabla.emplace(pagina, m);
+        return m;
+    }
+
+    void soltar(int m, bool sucia) {
+        marcos[m].sucia = marcos[m].sucia || sucia;
+        --marcos[m].fijas;
+    }
+
+    void flush() {
+        for (std::size_t m = 0; m < marcos.size(); ++m) {
+            if (marcos[m].valida && marcos[m].sucia)
+                escribirMarco(static_cast<int>(m));
+        }
+    }
+};
+
+
+// Arbol B guardado en un archivo: cada nodo es una pagina de tamaño fijo (4 KiB, 16 KiB, ...)
+// y los hijos son numeros de pagina. Las paginas se leen a traves de un BufferPool acotado.
+// Pagina 0: cabecera. Nodo: [count, leaf][keys (M-1)][children (M), numeros de pagina]
+// M sale del tamaño de pagina y de la key (el mayor M par que entra). Insert y remove bajan una
+// sola vez partiendo y completando nodos (como el modo de una pasada del BTree), asi solo hay
+// unas pocas paginas fijadas a la vez. TK debe ser trivialmente copiable.
+template <typename TK>
+class DiskBTree : private OrdenArbol<0> {
+    static_assert(std::is_trivially_copyable_v<TK>, "DiskBTree necesita keys trivialmente copiables");
+
+private:
+    using OrdenArbol<0>::M;
+    using OrdenArbol<0>::minKeys;
+
+    static constexpr std::uint64_t MAGICO = 0x42545245455f4453ull;
+    static constexpr std::uint32_t NINGUNA = 0; // la pagina 0 es la cabecera
+    static constexpr std::size_t OFFSET_KEYS = (8 + alignof(TK) - 1) / alignof(TK) * alignof(TK);
+
+    struct Cabecera {
+        std::uint64_t magico;
+        std::uint32_t bytesPagina;
+        std::uint32_t M;
+        std::uint32_t bytesKey;
+        std::uint32_t raiz;
+        std::uint32_t paginas; // paginas usadas del archivo, incluida la cabecera
+        std::uint32_t libre;   // primera pagina de la lista de libres
+        std::int64_t n;
+    };
+
+    // pagina fijada en el buffer pool mientras vive el objeto
+    class Pagina {
+    private:
+        BufferPool* pool;
+        int marco;
+        bool sucia;
+        std::uint32_t id_;
+        std::size_t offsetChildren;
+
+    public:
+        Pagina() : pool(nullptr), marco(-1), sucia(false), id_(NINGUNA), offsetChildren(0) {}
+
+        Pagina(BufferPool* pool_, std::uint32_t id, bool nueva, std::size_t offsetChildren_)
+            : pool(pool_), marco(pool_->fijar(id, nueva)), sucia(nueva), id_(id), offsetChildren(offsetChildren_) {}
+
+        Pagina(Pagina&& otra) noexcept
+            : pool(otra.pool), marco(otra.marco), sucia(otra.sucia), id_(otra.id_), offsetChildren(otra.offsetChildren) {
+            otra.pool = nullptr;
+        }
+
+        Pagina& operator=(Pagina&& otra) noexcept {
+            if (this != &otra) {
+                soltar();
+                pool = otra.pool;
+                marco = otra.marco;
+                sucia = otra.sucia;
+                id_ = otra.id_;
+                offsetChildren = otra.offsetChildren;
+                otra.pool = nullptr;
+            }
+            return *this;
+        }
+
+        ~Pagina() {
+            soltar();
+        }
+
+        void soltar() {
+            if (pool != nullptr)
+                pool->soltar(marco, sucia);
+            pool = nullptr;
+        }
+
+        std::uint32_t id() const {
+            return id_;
+        }
+
+        char* datos() const {
+            return pool->datos(marco);
+        }
+
+        // lectura: no marcan la pagina como sucia
+        int count() const {
+            return *reinterpret_cast<const std::int32_t*>(datos());
+        }
+
+        bool leaf() const {
+            return *reinterpret_cast<const std::int32_t*>(datos() + 4) != 0;
+        }
+
+        const TK* keys() const {
+            return reinterpret_cast<const TK*>(datos() + OFFSET_KEYS);
+        }
+
+        const std::uint32_t* children() const {
+            return reinterpret_cast<const std::uint32_t*>(datos() + offsetChildren);
+        }
+
+        // escritura: la pagina se escribira al archivo al desalojarla
+        void setCount(int count) {
+            sucia = true;
+            *reinterpret_cast<std::int32_t*>(datos()) = count;
+        }
+
+        void setLeaf(bool leaf) {
+            sucia = true;
+            *reinterpret_cast<std::int32_t*>(datos() + 4) = leaf;
+        }
+
+        TK* escribirKeys() {
+            sucia = true;
+            return reinterpret_cast<TK*>(datos() + OFFSET_KEYS);
+        }
+
+        std::uint32_t* escribirChildren() {
+            sucia = true;
+            return reinterpret_cast<std::uint32_t*>(datos() + offsetChildren);
+        }
+    };
+
+    ArchivoPaginas archivo;
+    Cabecera cabecera;
+    std::size_t offsetChildren;
+    mutable EstadisticasDisco estadisticas;
+    mutable BufferPool pool;
+
+    static std::size_t offsetChildrenPara(int M) {
+        return (OFFSET_KEYS + (M - 1) * sizeof(TK) + 3) / 4 * 4;
+    }
+
+    // mayor M par con el que un nodo entra en una pagina. Se valida antes de construir OrdenArbol:
+    // la pagina tiene que guardar la cabecera y un nodo con M >= 4 (el minimo par)
+    static int ordenPara(std::size_t bytesPagina) {
+        if (bytesPagina < std::max(sizeof(Cabecera), OFFSET_KEYS))
+            throw std::invalid_argument("Pagina demasiado chica");
+        int m = static_cast<int>((bytesPagina - OFFSET_KEYS + sizeof(TK)) / (sizeof(TK) + sizeof(std::uint32_t)));
+        while (m > 0 && offsetChildrenPara(m) + m * sizeof(std::uint32_t) > bytesPagina)
+            --m;
+        m -= m % 2;
+        if (m < 4)
+            throw std::invalid_argument("Pagina demasiado chica");
+        return m;
+    }
+
+public:
+    // abre el archivo del arbol, o lo crea si esta vacio; paginasEnCache acota la memoria usada
+    explicit DiskBTree(const std::string& ruta, std::size_t bytesPagina = 4096, std::size_t paginasEnCache = 1024)
+        : OrdenArbol<0>(ordenPara(bytesPagina)), archivo(ruta, bytesPagina), cabecera(),
+          offsetChildren(offsetChildrenPara(M)),
+          pool(archivo, bytesPagina, std::max<std::size_t>(paginasEnCache, 8), estadisticas) {
+        if (archivo.bytes() == 0) {
+            cabecera = Cabecera{MAGICO, static_cast<std::uint32_t>(bytesPagina), static_cast<std::uint32_t>(M),
+                                static_cast<std::uint32_t>(sizeof(TK)), NINGUNA, 1, NINGUNA, 0};
+            escribirCabecera();
+        } else {
+            std::vector<char> pagina(bytesPagina);
+            archivo.leer(0, pagina.data());
+            std::memcpy(&cabecera, pagina.data(), sizeof(Cabecera));
+            if (cabecera.magico != MAGICO || cabecera.bytesPagina != bytesPagina
+                || cabecera.bytesKey != sizeof(TK) || cabecera.M != static_cast<std::uint32_t>(M))
+                throw std::runtime_error("El archivo no es un DiskBTree con este formato");
+        }
+    }
+
+    DiskBTree(const DiskBTree&) = delete;
+    DiskBTree& operator=(const DiskBTree&) = delete;
+
+    // El destructor no puede lanzar: si falla la escritura se pierde lo que no llego al archivo.
+    // Para enterarse de un error de E/S hay que llamar a flush() antes de destruir el arbol.
+    ~DiskBTree() {
+        try {
+            flush();
+        } catch (const std::exception&) {
+        }
+    }
+
+    bool search(const TK& key) const {
+        std::uint32_t actual = cabecera.raiz;
+        while (actual != NINGUNA) {
+            Pagina node = fijar(actual);
+            int i = nodesearch::lowerBound(node.keys(), node.count(), key);
+            if (i < node.count() && !(key < node.keys()[i]))
+                return true;
+            actual = node.leaf() ? NINGUNA : node.children()[i];
+        }
+        return false;
+    }
+
+    void insert(const TK& key) {
+        if (cabecera.raiz == NINGUNA) {
+            Pagina raiz = nuevaPagina(true);
+            raiz.escribirKeys()[0] = key;
+            raiz.setCount(1);
+            cabecera.raiz = raiz.id();
+            ++cabecera.n;
+            return;
+        }
+
+        Pagina node = fijar(cabecera.raiz);
+        if (node.count() == M - 1) { // la raiz llena se parte antes de bajar
+            Pagina nuevaRaiz = nuevaPagina(false);
+            nuevaRaiz.escribirChildren()[0] = node.id();
+            dividirHijo(nuevaRaiz, 0, node);
+            cabecera.raiz = nuevaRaiz.id();
+            node = std::move(nuevaRaiz);
+        }
+
+        while (true) {
+            int i = nodesearch::lowerBound(node.keys(), node.count(), key);
+            if (i < node.count() && !(key < node.keys()[i]))
+                return; // ya existe
+            if (node.leaf()) {
+                TK* keys = node.escribirKeys();
+                for (int j = node.count(); j > i; --j)
+                    keys[j] = keys[j - 1];
+                keys[i] = key;
+                node.setCount(node.count() + 1);
+                ++cabecera.n;
+                return;
+            }
+            Pagina child = fijar(node.children()[i]);
+            if (child.count() == M - 1) {
+                dividirHijo(node, i, child);
+                if (!(key < node.keys()[i])) {
+                    if (!(node.keys()[i] < key))
+                        return; // la mediana era la key
+                    child = fijar(node.children()[++i]);
+                }
+            }
+            node = std::move(child);
+        }
+    }
+
+    void remove(TK key) {
+        if (cabecera.raiz == NINGUNA)
+            return;
+        Pagina node = fijar(cabecera.raiz);
+        while (true) {
+            int i = nodesearch::lowerBound(node.keys(), node.count(), key);
+            bool existe = i < node.count() && !(key < node.keys()[i]);
+
+            if (node.leaf()) {
+                if (!existe)
+                    return;
+                TK* keys = node.escribirKeys();
+                for (int j = i; j < node.count() - 1; ++j)
+                    keys[j] = keys[j + 1];
+                node.setCount(node.count() - 1);
+                --cabecera.n;
+                if (node.id() == cabecera.raiz && node.count() == 0) {
+                    cabecera.raiz = NINGUNA;
+                    liberarPagina(std::move(node));
+                }
+                return;
+            }
+
+            if (!existe) {
+                node = completarHijo(node, i);
+                continue;
+            }
+
+            Pagina left = fijar(node.children()[i]);
+            Pagina right = fijar(node.children()[i + 1]);
+            if (left.count() > minKeys || right.count() > minKeys) {
+                // se reemplaza por el antecesor (o sucesor) y se sigue bajando a borrar ese
+                bool antecesor = left.count() > minKeys;
+                std::uint32_t actual = antecesor ? left.id() : right.id();
+                while (true) {
+                    Pagina hoja = fijar(actual);
+                    if (hoja.leaf()) {
+                        key = hoja.keys()[antecesor ? hoja.count() - 1 : 0];
+                        break;
+                    }
+                    actual = hoja.children()[antecesor ? hoja.count() : 0];
+                }
+                node.escribirKeys()[i] = key;
+                node = antecesor ? std::move(left) : std::move(right);
+            } else {
+                merge(node, i, left, right); // la key baja al nodo fusionado
+                bajarRaiz(node, left);
+                node = std::move(left);
+            }
+        }
+    }
+
+    std::vector<TK> rangeSearch(const TK& begin, const TK& end) const {
+        std::vector<TK> result;
+        if (cabecera.raiz == NINGUNA || end < begin)
+            return result;
+        rangeSearchRec(cabecera.raiz, begin, end, result);
+        return result;
+    }
+
+    int height() const {
+        if (cabecera.raiz == NINGUNA)
+            return 0;
+        int height = 0;
+        for (Pagina node = fijar(cabecera.raiz); !node.leaf(); node = fijar(node.children()[0]))
+            ++height;
+        return height;
+    }
+
+    int size() const {
+        return static_cast<int>(cabecera.n);
+    }
+
+    bool empty() const {
+        return cabecera.raiz == NINGUNA;
+    }
+
+    // grado que resulto del tamaño de pagina
+    int order() const {
+        return M;
+    }
+
+    // paginas usadas en el archivo (incluye cabecera y paginas libres)
+    std::uint32_t pages() const {
+        return cabecera.paginas;
+    }
+
+    const EstadisticasDisco& stats() const {
+        return estadisticas;
+    }
+
+    void reset_stats() {
+        estadisticas = EstadisticasDisco();
+    }
+
+    // escribe las paginas sucias y la cabecera y espera a que lleguen al disco (fsync);
+    // lanza runtime_error si falla alguna escritura
+    void flush() {
+        pool.flush();
+        escribirCabecera();
+        archivo.sincronizar();
+    }
+
+    bool check_properties() const {
+        if (cabecera.raiz == NINGUNA)
+            return cabecera.n == 0;
+        int nivelHojas = -1;
+        std::int64_t total = 0;
+        return check_properties_rec(cabecera.raiz, nullptr, nullptr, 0, nivelHojas, total) && total == cabecera.n;
+    }
+
+private:
+    Pagina fijar(std::uint32_t id) const {
+        return Pagina(&pool, id, false, offsetChildren);
+    }
+
+    void escribirCabecera() {
+        std::vector<char> pagina(cabecera.bytesPagina, 0);
+        std::memcpy(pagina.data(), &cabecera, sizeof(Cabecera));
+        archivo.escribir(0, pagina.data());
+        ++estadisticas.escrituras;
+    }
+
+    // reutiliza una pagina libre o agrega una al final del archivo
+    Pagina nuevaPagina(bool leaf) {
+        std::uint32_t id;
+        if (cabecera.libre != NINGUNA) {
+            id = cabecera.libre;
+            Pagina libre = fijar(id);
+            std::memcpy(&cabecera.libre, libre.datos(), sizeof(std::uint32_t));
+        } else {
+            id = cabecera.paginas++;
+        }
+        Pagina pagina(&pool, id, true, offsetChildren);
+        std::memset(pagina.datos(), 0, cabecera.bytesPagina);
+        pagina.setLeaf(leaf);
+        return pagina;
+    }
+
+    // la pagina pasa a la lista de libres (el siguiente libre se guarda en sus primeros bytes)
+    void liberarPagina(Pagina&& pagina) {
+        Pagina libre = std::move(pagina);
+        libre.setCount(0);
+        std::memcpy(libre.datos(), &cabecera.libre, sizeof(std::uint32_t));
+        cabecera.libre = libre.id();
+    }
+
+    // parte el hijo i (lleno) del padre (con espacio): la mediana sube al padre
+    void dividirHijo(Pagina& parent, int i, Pagina& node) {
+        Pagina rightNode = nuevaPagina(node.leaf());
+        int medianIndex = node.count() / 2;
+        TK* keys = node.escribirKeys();
+        TK* rightKeys = rightNode.escribirKeys();
+        for (int k = medianIndex + 1, j = 0; k < node.count(); ++k, ++j)
+            rightKeys[j] = keys[k];
+        if (!node.leaf()) {
+            std::uint32_t* rightChildren = rightNode.escribirChildren();
+            for (int k = medianIndex + 1, j = 0; k <= node.count(); ++k, ++j)
+                rightChildren[j] = node.children()[k];
+        }
+        rightNode.setCount(node.count() - medianIndex - 1);
+        TK median = keys[medianIndex];
+        node.setCount(medianIndex);
+
+        TK* parentKeys = parent.escribirKeys();
+        std::uint32_t* parentChildren = parent.escribirChildren();
+        for (int k = parent.count(); k > i; --k)
+            parentKeys[k] = parentKeys[k - 1];
+        for (int k = parent.count() + 1; k > i + 1; --k)
+            parentChildren[k] = parentChildren[k - 1];
+        parentKeys[i] = median;
+        parentChildren[i + 1] = rightNode.id();
+        parent.setCount(parent.count() + 1);
+    }
+
+    // junta right en left con la key i del padre, que se quita del padre junto con el hijo i + 1
+    void merge(Pagina& parent, int i, Pagina& left, Pagina& right) {
+        TK* leftKeys = left.escribirKeys();
+        leftKeys[left.count()] = parent.keys()[i];
+        for (int k = 0; k < right.count(); ++k)
+            leftKeys[left.count() + 1 + k] = right.keys()[k];
+        if (!left.leaf()) {
+            std::uint32_t* leftChildren = left.escribirChildren();
+            for (int k = 0; k <= right.count(); ++k)
+                leftChildren[left.count() + 1 + k] = right.children()[k];
+        }
+        left.setCount(left.count() + right.count() + 1);
+
+        TK* parentKeys = parent.escribirKeys();
+        std::uint32_t* parentChildren = parent.escribirChildren();
+        for (int k = i; k < parent.count() - 1; ++k) {
+            parentKeys[k] = parentKeys[k + 1];
+            parentChildren[k + 1] = parentChildren[k + 2];
+        }
+        parent.setCount(parent.count() - 1);
+        liberarPagina(std::move(right));
+    }
+
+    // si la raiz se quedo sin keys tras un merge, su unico hijo pasa a ser la raiz
+    void bajarRaiz(Pagina& node, const Pagina& child) {
+        if (node.id() == cabecera.raiz && node.count() == 0) {
+            cabecera.raiz = child.id();
+            liberarPagina(std::move(node));
+        }
+    }
+
+    // pasa una key del hermano izquierdo (a traves del padre) al hijo i
+    void rotarDesdeIzquierda(Pagina& parent, int i, Pagina& child, Pagina& left) {
+        TK* keys = child.escribirKeys();
+        for (int k = child.count(); k > 0; --k)
+            keys[k] = keys[k - 1];
+        keys[0] = parent.keys()[i - 1];
+        if (!child.leaf()) {
+            std::uint32_t* children = child.escribirChildren();
+            for (int k = child.count() + 1; k > 0; --k)
+                children[k] = children[k - 1];
+            children[0] = left.children()[left.count()];
+        }
+        child.setCount(child.count() + 1);
+        parent.escribirKeys()[i - 1] = left.keys()[left.count() - 1];
+        left.setCount(left.count() - 1);
+    }
+
+    // pasa una key del hermano derecho (a traves del padre) al hijo i
+    void rotarDesdeDerecha(Pagina& parent, int i, Pagina& child, Pagina& right) {
+        child.escribirKeys()[child.count()] = parent.keys()[i];
+        if (!child.leaf())
+            child.escribirChildren()[child.count() + 1] = right.children()[0];
+        child.setCount(child.count() + 1);
+        parent.escribirKeys()[i] = right.keys()[0];
+        TK* keys = right.escribirKeys();
+        for (int k = 0; k < right.count() - 1; ++k)
+            keys[k] = keys[k + 1];
+        if (!right.leaf()) {
+            std::uint32_t* children = right.escribirChildren();
+            for (int k = 0; k < right.count(); ++k)
+                children[k] = children[k + 1];
+        }
+        right.setCount(right.count() - 1);
+    }
+
+    // deja al hijo i con mas del minimo antes de bajar a el; retorna el hijo que queda en su lugar
+    Pagina completarHijo(Pagina& node, int i) {
+        Pagina child = fijar(node.children()[i]);
+        if (child.count() > minKeys)
+            return child;
+        if (i > 0) {
+            Pagina left = fijar(node.children()[i - 1]);
+            if (left.count() > minKeys) {
+                rotarDesdeIzquierda(node, i, child, left);
+                return child;
+            }
+            if (i == node.count()) { // el hijo se junta en el hermano izquierdo
+                merge(node, i - 1, left, child);
+                bajarRaiz(node, left);
+                return left;
+            }
+        }
+        Pagina right = fijar(node.children()[i + 1]);
+        if (right.count() > minKeys) {
+            rotarDesdeDerecha(node, i, child, right);
+            return child;
+        }
+        merge(node, i, child, right);
+        bajarRaiz(node, child);
+        return child;
+    }
+
+    void rangeSearchRec(std::uint32_t id, const TK& begin, const TK& end, std::vector<TK>& result) const {
+        Pagina node = fijar(id);
+        int i = nodesearch::lowerBound(node.keys(), node.count(), begin); // primera key >= begin
+        for (; i < node.count() && !(end < node.keys()[i]); ++i) {
+            if (!node.leaf())
+                rangeSearchRec(node.children()[i], begin, end, result);
+            result.push_back(node.keys()[i]);
+        }
+        if (!node.leaf())
+            rangeSearchRec(node.children()[i], begin, end, result);
+    }
+
+    bool check_properties_rec(std::uint32_t id, const TK* inferior, const TK* superior, int nivel,
+                              int& nivelHojas, std::int64_t& total) const {
+        Pagina node = fijar(id);
+        if (node.count() > M - 1 || node.count() < (id == cabecera.raiz ? 1 : minKeys))
+            return false;
+        for (int i = 0; i < node.count(); ++i) {
+            if (i > 0 && !(node.keys()[i - 1] < node.keys()[i]))
+                return false;
+            if (inferior != nullptr && !(*inferior < node.keys()[i]))
+                return false;
+            if (superior != nullptr && !(node.keys()[i] < *superior))
+                return false;
+        }
+        total += node.count();
+        if (node.leaf()) {
+            if (nivelHojas == -1)
+                nivelHojas = nivel;
+            return nivelHojas == nivel;
+        }
+        for (int i = 0; i <= node.count(); ++i) {
+            const TK* inf = i == 0 ? inferior : &node.keys()[i - 1];
+            const TK* sup = i == node.count() ? superior : &node.keys()[i];
+            if (!check_properties_rec(node.children()[i], inf, sup, nivel + 1, nivelHojas, total))
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -1,35 +1,174 @@
 #ifndef NODE_H
 #define NODE_H
 
-template <typename TK>
-struct Node {
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Valores asociados a las keys (BTreeMap): un array paralelo a keys, para que la busqueda solo
+// recorra keys. Con TV = void el nodo no guarda valores y la base vacia no ocupa espacio.
+template <typename TV, int N>
+struct ValoresNodo {
+    std::array<TV, N> values;
+};
+
+template <int N>
+struct ValoresNodo<void, N> {};
+
+template <typename TV>
+struct PunteroValores {
+    TV* values;
+};
+
+template <>
+struct PunteroValores<void> {};
+
+// Con CONTEO = true los nodos internos guardan el tamaño del subarbol de cada hijo (rank/select)
+template <bool CONTEO, int N>
+struct ConteosNodo {
+    std::array<int, N> conteos;
+};
+
+template <int N>
+struct ConteosNodo<false, N> {};
+
+template <bool CONTEO>
+struct PunteroConteos {
+    int* conteos;
+};
+
+template <>
+struct PunteroConteos<false> {};
+
+template <typename TV>
+struct TamValor {
+    static constexpr std::size_t bytes = sizeof(TV);
+    static constexpr std::size_t alineacion = alignof(TV);
+};
+
+template <>
+struct TamValor<void> {
+    static constexpr std::size_t bytes = 0;
+    static constexpr std::size_t alineacion = 1;
+};
+
+// Nodo de orden fijo en tiempo de compilacion (ORDEN > 0): los arrays viven dentro del nodo.
+// La memoria la pone el arbol (ver NodePool): Node::create construye el nodo en un bloque de
+// Node::bytes(M, leaf) bytes alineado a Node::ALINEACION y Node::destroy lo destruye sin liberarlo.
+// Con valores (TV != void) el array de valores queda al inicio del nodo.
+template <typename TK, int ORDEN = 0, typename TV = void, bool CONTEO = false>
+struct alignas(std::max<std::size_t>(64, alignof(TK))) Node : ValoresNodo<TV, ORDEN - 1>, ConteosNodo<CONTEO, ORDEN> {
+    // cantidad de keys
+    int count;
+    // arboles, snapshots o padres que apuntan al nodo (copy-on-write)
+    std::atomic<int> refs;
+    // indicador de nodo hoja
+    bool leaf;
     // array de keys
+    std::array<TK, ORDEN - 1> keys;
+    // array de punteros a hijos (sin uso si es hoja)
+    std::array<Node*, ORDEN> children;
+
+    static constexpr std::size_t ALINEACION = alignof(Node);
+
+    static constexpr std::size_t bytes(const int&, bool) {
+        return sizeof(Node);
+    }
+
+    static Node* create(void* bloque, const int&, bool leaf) {
+        Node* node = new (bloque) Node();
+        node->leaf = leaf;
+        return node;
+    }
+
+    static void destroy(Node* node, const int&) {
+        node->~Node();
+    }
+
+private:
+    Node() : ValoresNodo<TV, ORDEN - 1>(), ConteosNodo<CONTEO, ORDEN>(), count(0), refs(1), leaf(true), keys(), children() {}
+};
+
+// Nodo de orden dinamico (ORDEN = 0). Vive en un solo bloque alineado a linea de cache:
+// [count, refs, leaf, punteros][keys (M-1)][values (M-1), solo si TV != void][children (M), solo si no es hoja]
+// [conteos (M), solo si CONTEO y no es hoja]
+template <typename TK, typename TV, bool CONTEO>
+struct Node<TK, 0, TV, CONTEO> : PunteroValores<TV>, PunteroConteos<CONTEO> {
+    // array de keys (dentro del bloque)
     TK* keys;
-    // array de punteros a hijos
+    // array de punteros a hijos (dentro del bloque, nullptr si es hoja)
     Node** children;
     // cantidad de keys
     int count;
+    // arboles, snapshots o padres que apuntan al nodo (copy-on-write)
+    std::atomic<int> refs;
     // indicador de nodo hoja
     bool leaf;
 
-    Node() : keys(nullptr), children(nullptr), count(0), leaf(false) {}
+    static constexpr std::size_t ALINEACION =
+            std::max({std::size_t{64}, alignof(TK), TamValor<TV>::alineacion});
+
+    static constexpr std::size_t alinear(std::size_t x, std::size_t a) {
+        return (x + a - 1) / a * a;
+    }
+
+    static constexpr std::size_t offsetKeys() {
+        return alinear(sizeof(Node), alignof(TK));
+    }
+
+    static constexpr std::size_t offsetValues(const int& M) {
+        return alinear(offsetKeys() + (M - 1) * sizeof(TK), TamValor<TV>::alineacion);
+    }
 
-    explicit Node(const int& M) {
-        keys = new TK[M - 1]();
-        children = new Node<TK>*[M]();
-        count = 0;
-        leaf = true;
+    static constexpr std::size_t offsetChildren(const int& M) {
+        return alinear(offsetValues(M) + (M - 1) * TamValor<TV>::bytes, alignof(Node*));
     }
 
-    void killSelf() {
-        delete[] this->keys;
+    static constexpr std::size_t offsetConteos(const int& M) {
+        return offsetChildren(M) + M * sizeof(Node*);
+    }
+
+    // tamaño del bloque de un nodo de orden M
+    static constexpr std::size_t bytes(const int& M, bool leaf) {
+        if (leaf)
+            return alinear(offsetChildren(M), ALINEACION);
+        return alinear(offsetConteos(M) + (CONTEO ? M * sizeof(int) : 0), ALINEACION);
+    }
+
+    static Node* create(void* memoria, const int& M, bool leaf) {
+        char* bloque = static_cast<char*>(memoria);
+        Node* node = new (bloque) Node();
+        node->keys = reinterpret_cast<TK*>(bloque + offsetKeys());
+        std::uninitialized_value_construct_n(node->keys, M - 1);
+        if constexpr (!std::is_void_v<TV>) {
+            node->values = reinterpret_cast<TV*>(bloque + offsetValues(M));
+            std::uninitialized_value_construct_n(node->values, M - 1);
+        }
         if (!leaf) {
-            for (int i = 0; i <= count; ++i)
-                this->children[i]->killSelf();
+            node->children = reinterpret_cast<Node**>(bloque + offsetChildren(M));
+            std::uninitialized_value_construct_n(node->children, M);
+            if constexpr (CONTEO) {
+                node->conteos = reinterpret_cast<int*>(bloque + offsetConteos(M));
+                std::uninitialized_value_construct_n(node->conteos, M);
+            }
         }
-        delete[] this->children;
-        delete this;
+        node->leaf = leaf;
+        return node;
     }
+
+    static void destroy(Node* node, const int& M) {
+        std::destroy_n(node->keys, M - 1);
+        if constexpr (!std::is_void_v<TV>)
+            std::destroy_n(node->values, M - 1);
+        node->~Node();
+    }
+
+private:
+    Node() : keys(nullptr), children(nullptr), count(0), refs(1), leaf(true) {}
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,148 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+
+// Pool de bloques de tamaño fijo para los nodos del arbol.
+// Pide slabs grandes al memory_resource y reparte bloques desde una lista libre;
+// los bloques devueltos se reutilizan sin pasar por el allocator.
+// liberarTodo() devuelve todos los slabs de una vez, en O(numero de slabs).
+// absorber() pasa los slabs de otro pool compatible a este, sin tocar los bloques entregados.
+class NodePool {
+private:
+    struct Slab {
+        Slab* next;
+    };
+    struct BloqueLibre {
+        BloqueLibre* next;
+    };
+
+    static constexpr std::size_t BYTES_SLAB = 64 * 1024;
+    static constexpr std::size_t MIN_BLOQUES_POR_SLAB = 16;
+
+    std::pmr::memory_resource* recurso;
+    std::size_t tamBloque;
+    std::size_t alineacion;
+    std::size_t bytesSlab;
+    std::size_t inicioBloques; // offset del primer bloque dentro del slab
+
+    Slab* slabs;
+    Slab* ultimoSlab; // el primero que se pidio: el final de la lista de slabs
+    BloqueLibre* libres;
+    char* siguiente; // siguiente bloque sin usar del slab actual
+    char* finSlab;
+    std::size_t nSlabs;
+
+    void nuevoSlab() {
+        char* memoria = static_cast<char*>(recurso->allocate(bytesSlab, alineacion));
+        Slab* slab = reinterpret_cast<Slab*>(memoria);
+        if (slabs == nullptr)
+            ultimoSlab = slab;
+        slab->next = slabs;
+        slabs = slab;
+        ++nSlabs;
+        siguiente = memoria + inicioBloques;
+        finSlab = memoria + bytesSlab;
+    }
+
+public:
+    NodePool(std::size_t tamBloque_, std::size_t alineacion_,
+             std::pmr::memory_resource* recurso_ = std::pmr::get_default_resource())
+        : recurso(recurso_),
+          tamBloque(std::max(tamBloque_, sizeof(BloqueLibre))),
+          alineacion(std::max(alineacion_, alignof(Slab))),
+          slabs(nullptr), ultimoSlab(nullptr), libres(nullptr), siguiente(nullptr), finSlab(nullptr), nSlabs(0) {
+        tamBloque = (tamBloque + alineacion - 1) / alineacion * alineacion;
+        inicioBloques = (sizeof(Slab) + alineacion - 1) / alineacion * alineacion;
+        std::size_t bloquesPorSlab = std::max(MIN_BLOQUES_POR_SLAB, BYTES_SLAB / tamBloque);
+        bytesSlab = inicioBloques + bloquesPorSlab * tamBloque;
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        liberarTodo();
+    }
+
+    void* reservar() {
+        if (libres != nullptr) {
+            BloqueLibre* bloque = libres;
+            libres = bloque->next;
+            return bloque;
+        }
+        if (siguiente == finSlab)
+            nuevoSlab();
+        void* bloque = siguiente;
+        siguiente += tamBloque;
+        return bloque;
+    }
+
+    void devolver(void* bloque) {
+        BloqueLibre* libre = static_cast<BloqueLibre*>(bloque);
+        libre->next = libres;
+        libres = libre;
+    }
+
+    // devuelve todos los slabs al memory_resource; los bloques entregados dejan de ser validos
+    void liberarTodo() {
+        while (slabs != nullptr) {
+            Slab* next = slabs->next;
+            recurso->deallocate(slabs, bytesSlab, alineacion);
+            slabs = next;
+        }
+        ultimoSlab = nullptr;
+        libres = nullptr;
+        siguiente = finSlab = nullptr;
+        nSlabs = 0;
+    }
+
+    // los bloques de otro pueden pasar a este: mismo tamaño de bloque y de slab, y un recurso
+    // que puede liberar lo que pidio el de otro
+    bool compatible(const NodePool& otro) const {
+        return otro.tamBloque == tamBloque && otro.alineacion == alineacion && otro.bytesSlab == bytesSlab
+               && (otro.recurso == recurso || otro.recurso->is_equal(*recurso));
+    }
+
+    // Pasa a este pool los slabs de otro (compatible), que queda vacio: los bloques que otro ya
+    // entrego siguen validos y desde ahora se devuelven a este. Los slabs se enganchan en O(1);
+    // los bloques libres de otro (y lo que quedaba sin usar de su slab actual) se recorren.
+    void absorber(NodePool& otro) {
+        for (; otro.siguiente != otro.finSlab; otro.siguiente += tamBloque)
+            devolver(otro.siguiente);
+        if (otro.libres != nullptr) {
+            BloqueLibre* ultimo = otro.libres;
+            while (ultimo->next != nullptr)
+                ultimo = ultimo->next;
+            ultimo->next = libres;
+            libres = otro.libres;
+        }
+        if (otro.slabs != nullptr) {
+            otro.ultimoSlab->next = slabs;
+            if (slabs == nullptr)
+                ultimoSlab = otro.ultimoSlab;
+            slabs = otro.slabs;
+            nSlabs += otro.nSlabs;
+        }
+        otro.slabs = otro.ultimoSlab = nullptr;
+        otro.libres = nullptr;
+        otro.siguiente = otro.finSlab = nullptr;
+        otro.nSlabs = 0;
+    }
+
+    std::size_t slabsReservados() const {
+        return nSlabs;
+    }
+
+    std::size_t bytesReservados() const {
+        return nSlabs * bytesSlab;
+    }
+
+    std::pmr::memory_resource* resource() const {
+        return recurso;
+    }
+};
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef NODESEARCH_H
+#define NODESEARCH_H
+
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Busqueda dentro de un nodo.
+// lowerBound retorna la primera posicion i tal que !(keys[i] < key), que como las keys del
+// nodo estan ordenadas es igual a la cantidad de keys menores a key.
+// El kernel se elige en tiempo de compilacion:
+//  - TK aritmetico: se cuentan las keys menores con comparaciones vectorizadas (AVX2 o SSE2,
+//    y un conteo escalar sin saltos como respaldo)
+//  - otros tipos: busqueda binaria sin saltos
+// Con un comparador los kernels aritmeticos se usan solo si ordena como < entre keys del mismo
+// tipo (std::less<TK> o std::less<>); con cualquier otro se hace la busqueda binaria con el.
+namespace nodesearch {
+
+    template <typename TK, typename K, typename Compare>
+    constexpr bool ordenNatural = std::is_same_v<K, TK> &&
+                                  (std::is_same_v<Compare, std::less<TK>> || std::is_same_v<Compare, std::less<>>);
+
+    template <typename T>
+    inline int contarMenoresEscalar(const T* keys, int count, const T& key) {
+        int menores = 0;
+        for (int i = 0; i < count; ++i)
+            menores += keys[i] < key;
+        return menores;
+    }
+
+    // enteros de 32 bits; los sin signo se comparan invirtiendo el bit de signo
+    template <typename T>
+    inline int contarMenores32(const T* keys, int count, const T& key) {
+        int i = 0;
+        int menores = 0;
+#if defined(__SSE2__)
+        const int32_t signo = std::is_signed_v<T> ? 0 : INT32_MIN;
+#endif
+#if defined(__AVX2__)
+        const __m256i signo8 = _mm256_set1_epi32(signo);
+        const __m256i k8 = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(key)), signo8);
+        for (; i + 8 <= count; i += 8) {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), signo8);
+            int mascara = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k8, v)));
+            menores += __builtin_popcount(mascara);
+            if (mascara != 0xFF) // las siguientes keys ya son mayores o iguales
+                return menores;
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i signo4 = _mm_set1_epi32(signo);
+        const __m128i k4 = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(key)), signo4);
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), signo4);
+            int mascara = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k4, v)));
+            menores += __builtin_popcount(mascara);
+            if (mascara != 0xF)
+                return menores;
+        }
+#endif
+        return menores + contarMenoresEscalar(keys + i, count - i, key);
+    }
+
+    // enteros de 64 bits
+    template <typename T>
+    inline int contarMenores64(const T* keys, int count, const T& key) {
+        int i = 0;
+        int menores = 0;
+#if defined(__AVX2__)
+        const __m256i signo4 = _mm256_set1_epi64x(std::is_signed_v<T> ? 0 : INT64_MIN);
+        const __m256i k4 = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(key)), signo4);
+        for (; i + 4 <= count; i += 4) {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), signo4);
+            int mascara = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k4, v)));
+            menores += __builtin_popcount(mascara);
+            if (mascara != 0xF)
+                return menores;
+        }
+#endif
+        return menores + contarMenoresEscalar(keys + i, count - i, key);
+    }
+
+    inline int contarMenores(const float* keys, int count, const float& key) {
+        int i = 0;
+        int menores = 0;
+#if defined(__AVX2__)
+        const __m256 k8 = _mm256_set1_ps(key);
+        for (; i + 8 <= count; i += 8) {
+            int mascara = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(keys + i), k8, _CMP_LT_OQ));
+            menores += __builtin_popcount(mascara);
+            if (mascara != 0xFF)
+                return menores;
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128 k4 = _mm_set1_ps(key);
+        for (; i + 4 <= count; i += 4) {
+            int mascara = _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(keys + i), k4));
+            menores += __builtin_popcount(mascara);
+            if (mascara != 0xF)
+                return menores;
+        }
+#endif
+        return menores + contarMenoresEscalar(keys + i, count - i, key);
+    }
+
+    inline int contarMenores(const double* keys, int count, const double& key) {
+        int i = 0;
+        int menores = 0;
+#if defined(__AVX2__)
+        const __m256d k4 = _mm256_set1_pd(key);
+        for (; i + 4 <= count; i += 4) {
+            int mascara = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(keys + i), k4, _CMP_LT_OQ));
+            menores += __builtin_popcount(mascara);
+            if (mascara != 0xF)
+                return menores;
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128d k2 = _mm_set1_pd(key);
+        for (; i + 2 <= count; i += 2) {
+            int mascara = _mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(keys + i), k2));
+            menores += __builtin_popcount(mascara);
+            if (mascara != 0x3)
+                return menores;
+        }
+#endif
+        return menores + contarMenoresEscalar(keys + i, count - i, key);
+    }
+
+    // busqueda binaria sin saltos: el rango se reduce a la mitad con un movimiento condicional
+    template <typename TK, typename K, typename Compare>
+    inline int busquedaBinaria(const TK* keys, int count, const K& key, const Compare& comp) {
+        if (count == 0)
+            return 0;
+        const TK* base = keys;
+        int n = count;
+        while (n > 1) {
+            int mitad = n / 2;
+            base = comp(base[mitad], key) ? base + mitad : base;
+            n -= mitad;
+        }
+        return static_cast<int>(base - keys) + comp(*base, key);
+    }
+
+    template <typename TK>
+    inline int busquedaBinaria(const TK* keys, int count, const TK& key) {
+        return busquedaBinaria(keys, count, key, std::less<>());
+    }
+
+    template <typename TK>
+    inline int lowerBound(const TK* keys, int count, const TK& key) {
+        if constexpr (std::is_integral_v<TK> && sizeof(TK) == 4)
+            return contarMenores32(keys, count, key);
+        else if constexpr (std::is_integral_v<TK> && sizeof(TK) == 8)
+            return contarMenores64(keys, count, key);
+        else if constexpr (std::is_same_v<TK, float> || std::is_same_v<TK, double>)
+            return contarMenores(keys, count, key);
+        else if constexpr (std::is_arithmetic_v<TK>)
+            return contarMenoresEscalar(keys, count, key);
+        else
+            return busquedaBinaria(keys, count, key);
+    }
+
+    // primera posicion i tal que !comp(keys[i], key)
+    template <typename TK, typename K, typename Compare>
+    inline int lowerBound(const TK* keys, int count, const K& key, const Compare& comp) {
+        if constexpr (ordenNatural<TK, K, Compare>)
+            return lowerBound(keys, count, key);
+        else
+            return busquedaBinaria(keys, count, key, comp);
+    }
+
+    // comparaciones de keys que hace lowerBound en un nodo de count keys: los kernels aritmeticos
+    // comparan todas, la busqueda binaria una por paso mas la ultima
+    template <typename TK, typename K = TK, typename Compare = std::less<TK>>
+    constexpr int comparaciones(int count) {
+        if constexpr (std::is_arithmetic_v<TK> && ordenNatural<TK, K, Compare>) {
+            return count;
+        } else {
+            int pasos = count > 0;
+            for (int n = count; n > 1; n -= n / 2)
+                ++pasos;
+            return pasos;
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef SERIALIZADOR_H
+#define SERIALIZADOR_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+// Formato binario de BTree::save / BTree::load:
+//   [Cabecera][n keys en orden][n valores en orden, solo si el arbol guarda valores]
+// Los datos se escriben con el orden de bytes de la maquina.
+namespace serializacion {
+
+    constexpr std::uint64_t MAGICO = 0x4e49425f45455254ull; // "TREE_BIN"
+    constexpr std::uint32_t VERSION = 1;
+
+    struct Cabecera {
+        std::uint64_t magico;
+        std::uint32_t version;
+        std::uint32_t bytesKey;   // sizeof(TK), para detectar que se carga con otro tipo
+        std::uint32_t bytesValor; // sizeof(TV), 0 sin valores
+        std::uint32_t reservado;
+        std::uint64_t n;
+    };
+
+}
+
+// Escribe y lee arrays de T. Los tipos trivialmente copiables van en un solo bloque de bytes;
+// para otros tipos hay que especializar Serializador<T> con escribir/leer.
+template <typename T, typename = void>
+struct Serializador {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Especializar Serializador<T> para guardar un tipo que no es trivialmente copiable");
+};
+
+template <typename T>
+struct Serializador<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+    static void escribir(std::ostream& os, const T* datos, std::size_t cantidad) {
+        os.write(reinterpret_cast<const char*>(datos), static_cast<std::streamsize>(cantidad * sizeof(T)));
+    }
+
+    static void leer(std::istream& is, T* datos, std::size_t cantidad) {
+        is.read(reinterpret_cast<char*>(datos), static_cast<std::streamsize>(cantidad * sizeof(T)));
+    }
+};
+
+// strings: largo (64 bits) seguido de los caracteres
+template <>
+struct Serializador<std::string> {
+    static void escribir(std::ostream& os, const std::string* datos, std::size_t cantidad) {
+        for (std::size_t i = 0; i < cantidad; ++i) {
+            std::uint64_t largo = datos[i].size();
+            os.write(reinterpret_cast<const char*>(&largo), sizeof(largo));
+            os.write(datos[i].data(), static_cast<std::streamsize>(largo));
+        }
+    }
+
+    static void leer(std::istream& is, std::string* datos, std::size_t cantidad) {
+        for (std::size_t i = 0; i < cantidad && is; ++i) {
+            std::uint64_t largo = 0;
+            is.read(reinterpret_cast<char*>(&largo), sizeof(largo));
+            if (!is)
+                return;
+            datos[i].resize(largo);
+            is.read(&datos[i][0], static_cast<std::streamsize>(largo));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,1205 @@
+// Casos de prueba por funcionalidad con los ASSERT de tester.h. Cada bloque es un test de ctest
+// (ver BTREE_TESTS en CMakeLists.txt):
+//   tests <bloque>   corre un bloque
+//   tests            corre todos
+// Sale con 1 si falla algun ASSERT o algo lanza una excepcion que no se esperaba.
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "../bplustree.h"
+#include "../btree.h"
+#include "../btreemap.h"
+#include "../compressedbtree.h"
+#include "../concurrentbtree.h"
+#include "../diskbtree.h"
+#include "../nodepool.h"
+#include "../nodesearch.h"
+#include "../tester.h"
+
+// true si f lanza una Excepcion
+template <typename Excepcion, typename F>
+static bool lanza(F f) {
+    try {
+        f();
+    } catch (const Excepcion&) {
+        return true;
+    } catch (...) {
+        return false;
+    }
+    return false;
+}
+
+template <typename Arbol>
+static std::vector<int> keysDe(const Arbol& arbol) {
+    return arbol.rangeSearch(INT_MIN, INT_MAX);
+}
+
+static std::vector<int> ordenadas(const std::set<int>& modelo) {
+    return std::vector<int>(modelo.begin(), modelo.end());
+}
+
+static std::vector<int> aleatorias(std::size_t cantidad, int rango, unsigned semilla) {
+    std::mt19937 gen(semilla);
+    std::uniform_int_distribution<int> dist(0, rango - 1);
+    std::vector<int> resultado(cantidad);
+    for (int& x : resultado)
+        x = dist(gen);
+    return resultado;
+}
+
+// inserts y removes al azar comparados con un std::set; las propiedades se verifican cada tanto
+template <typename Arbol>
+static bool operacionesAlAzar(Arbol& arbol, std::set<int>& modelo, int operaciones, int rango, unsigned semilla) {
+    std::mt19937 gen(semilla);
+    std::uniform_int_distribution<int> dist(0, rango - 1);
+    for (int i = 0; i < operaciones; ++i) {
+        int x = dist(gen);
+        if (gen() % 3 == 0) {
+            arbol.remove(x);
+            modelo.erase(x);
+        } else {
+            arbol.insert(x);
+            modelo.insert(x);
+        }
+        if (i % 97 == 0 && (!arbol.check_properties() || arbol.size() != static_cast<int>(modelo.size())))
+            return false;
+    }
+    return arbol.check_properties() && keysDe(arbol) == ordenadas(modelo);
+}
+
+template <typename Arbol>
+static bool operacionesAlAzar(Arbol& arbol, int operaciones, int rango, unsigned semilla) {
+    std::set<int> modelo;
+    return operacionesAlAzar(arbol, modelo, operaciones, rango, semilla);
+}
+
+// memory_resource que cuenta lo que se pide y lo que sigue pedido
+class RecursoContador : public std::pmr::memory_resource {
+public:
+    std::size_t pedidos = 0;
+    std::size_t bytesVivos = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alineacion) override {
+        ++pedidos;
+        bytesVivos += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alineacion);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alineacion) override {
+        bytesVivos -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alineacion);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& otro) const noexcept override {
+        return this == &otro;
+    }
+};
+
+// -------------------- bloques ---------------
+
+// arbol vacio, una sola key y M = 3 con el arbol dinamico
+static void edgeCases() {
+    BTree<int> vacio(3);
+    ASSERT(vacio.empty() && vacio.size() == 0 && vacio.height() == 0, "An empty tree must have size and height 0");
+    ASSERT(!vacio.search(1) && vacio.toString(" ") == "", "An empty tree must not find keys");
+    ASSERT(lanza<std::runtime_error>([&] { vacio.minKey(); }), "minKey on an empty tree must throw");
+    ASSERT(lanza<std::runtime_error>([&] { vacio.maxKey(); }), "maxKey on an empty tree must throw");
+    ASSERT(vacio.rangeSearch(0, 10).empty(), "rangeSearch on an empty tree must be empty");
+    vacio.remove(1);
+    ASSERT(vacio.check_properties() && vacio.size() == 0, "remove on an empty tree must do nothing");
+
+    BTree<int> una(3);
+    una.insert(7);
+    una.insert(7);
+    ASSERT(una.size() == 1 && una.height() == 0 && una.minKey() == 7 && una.maxKey() == 7,
+           "A tree with one key is a single leaf");
+    una.remove(7);
+    ASSERT(una.empty() && una.check_properties() && !una.search(7), "Removing the only key must empty the tree");
+
+    ASSERT(lanza<std::out_of_range>([] { BTree<int> arbol(2); }), "A degree below 3 must throw");
+
+    for (int M : {3, 4, 5, 6, 7, 16, 33}) {
+        BTree<int> arbol(M);
+        ASSERT(operacionesAlAzar(arbol, 3000, 500, M), "Random insert/remove failed for M = " << M);
+        std::vector<int> keys = keysDe(arbol);
+        std::vector<int> porIterador(arbol.begin(), arbol.end());
+        ASSERT(keys == porIterador, "rangeSearch and the iterators disagree for M = " << M);
+    }
+}
+
+// stats() en un arbol conocido y en uno al azar; con -DBTREE_CONTADORES (test counters_enabled)
+// tambien los contadores de una secuencia armada para pasar por cada caso
+static void counters() {
+    // M = 3: 20, 40 en una hoja; 10 la parte (raiz [20]); 30 y 50 llenan la derecha, que al recibir
+    // 50 cede 30 a su hermano: raiz [30], hojas [10, 20] y [40, 50]
+    BTree<int> arbol(3);
+    for (int x : {20, 40, 10, 30, 50})
+        arbol.insert(x);
+    EstadisticasBTree e = arbol.stats();
+    bool bien = e.altura == 1 && e.nodos == 3 && e.keys == 5 && e.niveles.size() == 2 && e.bytesNodos > 0
+                && e.bytesReservados >= e.bytesNodos;
+    bien = bien && e.niveles[0].nodos == 1 && e.niveles[0].keys == 1 && e.niveles[0].llenado[5] == 1
+           && e.niveles[1].nodos == 2 && e.niveles[1].keys == 4 && e.niveles[1].llenado[9] == 2;
+    ASSERT(bien && arbol.toString(",") == "10,20,30,40,50", "stats() failed on a known tree");
+
+    BTree<int> vacio(4);
+    e = vacio.stats();
+    ASSERT(e.altura == 0 && e.nodos == 0 && e.keys == 0 && e.niveles.empty(), "stats() of an empty tree must be empty");
+
+    for (int M : {3, 4, 5, 16}) {
+        BTree<int> alAzar(M);
+        bien = operacionesAlAzar(alAzar, 5000, 3000, M);
+        e = alAzar.stats();
+        std::size_t nodos = 0;
+        std::size_t keys = 0;
+        for (const EstadisticasBTree::Nivel& nivel : e.niveles) {
+            std::size_t enHistograma = 0;
+            for (std::size_t cantidad : nivel.llenado)
+                enHistograma += cantidad;
+            bien = bien && enHistograma == nivel.nodos && nivel.keys <= nivel.nodos * (M - 1);
+            nodos += nivel.nodos;
+            keys += nivel.keys;
+        }
+        bien = bien && e.altura == alAzar.height() && e.niveles.size() == static_cast<std::size_t>(e.altura + 1)
+               && e.niveles[0].nodos == 1 && nodos == e.nodos && keys == e.keys && e.keys == static_cast<std::size_t>(alAzar.size());
+        for (std::size_t i = 1; i < e.niveles.size(); ++i) // cada nodo interno tiene count + 1 hijos
+            bien = bien && e.niveles[i].nodos == e.niveles[i - 1].nodos + e.niveles[i - 1].keys;
+        ASSERT(bien, "stats() levels and histogram do not add up for M = " << M);
+    }
+
+    // 40 y 50 dejan corta la hoja derecha: toma una key de la izquierda; con 25, borrar 10 deja
+    // corta la izquierda, que toma una de la derecha; borrar 20 junta las hojas y baja la raiz
+    arbol.remove(40);
+    arbol.remove(50);
+    arbol.insert(25);
+    arbol.remove(10);
+    arbol.remove(20);
+    const ContadoresBTree c = arbol.counters();
+    ASSERT(arbol.check_properties() && arbol.toString(",") == "25,30" && arbol.height() == 0,
+           "The scripted insert/remove sequence failed");
+#ifdef BTREE_CONTADORES
+    ASSERT(c.splits == 1 && c.cesiones == 1 && c.crecimientosRaiz == 2 && c.nodosReservados == 3,
+           "Counters of the inserts: splits " << c.splits << ", cesiones " << c.cesiones << ", root growths "
+                                              << c.crecimientosRaiz << ", nodes " << c.nodosReservados);
+    ASSERT(c.rotacionesIzquierda == 1 && c.rotacionesDerecha == 1 && c.merges == 1 && c.reduccionesRaiz == 1
+               && c.nodosLiberados == 2,
+           "Counters of the removes: rotations " << c.rotacionesIzquierda << "/" << c.rotacionesDerecha << ", merges "
+                                                 << c.merges << ", root shrinks " << c.reduccionesRaiz << ", freed "
+                                                 << c.nodosLiberados);
+    // cada remove baja desde la raiz; algunos inserts en la ultima hoja entran por el dedo sin bajar
+    ASSERT(c.descensos >= 5 && c.descensos < 10 && c.nodosVisitados > 0 && c.comparaciones > 0,
+           "Counters of the descents failed: " << c.descensos);
+    arbol.reset_counters();
+    ASSERT(arbol.counters().splits == 0 && arbol.counters().descensos == 0, "reset_counters must zero the counters");
+#else
+    ASSERT(c.splits == 0 && c.merges == 0 && c.descensos == 0 && c.nodosReservados == 0,
+           "Without BTREE_CONTADORES the counters must stay at 0");
+#endif
+}
+
+// kernels de nodesearch.h contra std::lower_bound, con enteros con y sin signo en los extremos
+template <typename T>
+static bool lowerBoundCorrecto(std::vector<T> valores) {
+    std::sort(valores.begin(), valores.end());
+    for (int count = 0; count <= static_cast<int>(valores.size()); ++count) {
+        for (const T& key : valores) {
+            const int esperado = static_cast<int>(std::lower_bound(valores.data(), valores.data() + count, key) - valores.data());
+            if (nodesearch::lowerBound(valores.data(), count, key) != esperado
+                || nodesearch::lowerBound(valores.data(), count, key, std::less<T>()) != esperado
+                || nodesearch::busquedaBinaria(valores.data(), count, key) != esperado)
+                return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+static std::vector<T> valoresDePrueba(unsigned semilla) {
+    std::mt19937_64 gen(semilla);
+    std::vector<T> valores = {std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max(), T(0), T(1)};
+    if constexpr (std::is_signed_v<T>)
+        valores.push_back(T(-1));
+    else
+        valores.push_back(static_cast<T>(std::numeric_limits<T>::max() / 2 + 1)); // solo el bit alto
+    while (valores.size() < 70)
+        valores.push_back(static_cast<T>(gen()));
+    return valores;
+}
+
+static void nodeSearch() {
+    ASSERT(lowerBoundCorrecto(valoresDePrueba<std::int32_t>(1)), "lowerBound fails for int32_t");
+    ASSERT(lowerBoundCorrecto(valoresDePrueba<std::uint32_t>(2)), "lowerBound fails for uint32_t");
+    ASSERT(lowerBoundCorrecto(valoresDePrueba<std::int64_t>(3)), "lowerBound fails for int64_t");
+    ASSERT(lowerBoundCorrecto(valoresDePrueba<std::uint64_t>(4)), "lowerBound fails for uint64_t");
+    ASSERT(lowerBoundCorrecto(valoresDePrueba<std::int16_t>(5)), "lowerBound fails for int16_t");
+    ASSERT(lowerBoundCorrecto(std::vector<double>{-1e300, -2.5, -0.0, 1e-300, 3.5, 7.0, 7.25, 1e300}),
+           "lowerBound fails for double");
+    ASSERT(lowerBoundCorrecto(std::vector<float>{-1e30f, -2.5f, 0.0f, 1.0f, 1.5f, 3.0f, 1e30f}),
+           "lowerBound fails for float");
+    ASSERT(lowerBoundCorrecto(std::vector<std::string>{"", "a", "ab", "abc", "b", "ba", "zzz"}),
+           "lowerBound fails for std::string");
+
+    // con otro comparador se busca con el: keys en orden descendente
+    std::vector<int> descendente = {90, 70, 50, 30, 10};
+    ASSERT(nodesearch::lowerBound(descendente.data(), 5, 50, std::greater<int>()) == 2
+           && nodesearch::lowerBound(descendente.data(), 5, 60, std::greater<int>()) == 2
+           && nodesearch::lowerBound(descendente.data(), 5, 5, std::greater<int>()) == 5,
+           "lowerBound with std::greater must follow the comparator");
+}
+
+// BTree<TK, ORDEN> con M par e impar, contra el de orden dinamico
+static void staticOrder() {
+    BTree<int, 3> tres;
+    BTree<int, 4> cuatro;
+    BTree<int, 5> cinco;
+    BTree<int, 64> sesentaYCuatro;
+    ASSERT(operacionesAlAzar(tres, 3000, 400, 1), "BTree<int, 3> random insert/remove failed");
+    ASSERT(operacionesAlAzar(cuatro, 3000, 400, 2), "BTree<int, 4> random insert/remove failed");
+    ASSERT(operacionesAlAzar(cinco, 3000, 400, 3), "BTree<int, 5> random insert/remove failed");
+    ASSERT(operacionesAlAzar(sesentaYCuatro, 20000, 5000, 4), "BTree<int, 64> random insert/remove failed");
+
+    BTree<int> dinamico(5);
+    ASSERT(operacionesAlAzar(dinamico, 3000, 400, 3) && dinamico.toString(",") == cinco.toString(",")
+           && dinamico.height() == cinco.height(),
+           "The static and dynamic order trees must build the same tree");
+
+    std::vector<int> elements = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::unique_ptr<BTree<int, 4>> construido(BTree<int, 4>::build_from_ordered_vector(elements));
+    ASSERT(construido->check_properties() && construido->toString(",") == "1,2,3,4,5,6,7,8,9,10",
+           "build_from_ordered_vector without M must use ORDEN");
+}
+
+// los nodos salen de slabs del memory_resource y los bloques liberados se reusan
+static void nodePool() {
+    NodePool pool(40, 64);
+    void* a = pool.reservar();
+    void* b = pool.reservar();
+    ASSERT(a != b && reinterpret_cast<std::uintptr_t>(a) % 64 == 0 && reinterpret_cast<std::uintptr_t>(b) % 64 == 0,
+           "NodePool must hand out distinct aligned blocks");
+    pool.devolver(a);
+    ASSERT(pool.reservar() == a && pool.slabsReservados() == 1, "NodePool must reuse a returned block");
+    pool.liberarTodo();
+    ASSERT(pool.slabsReservados() == 0 && pool.bytesReservados() == 0, "liberarTodo must return every slab");
+
+    RecursoContador recurso;
+    {
+        BTree<int> arbol(8, &recurso);
+        for (int i = 0; i < 20000; ++i)
+            arbol.insert(i);
+        const std::size_t pedidos = recurso.pedidos;
+        ASSERT(pedidos > 0 && pedidos < 20000 / 64, "Nodes must be carved from slabs, not allocated one by one");
+        for (int i = 0; i < 20000; ++i)
+            arbol.remove(i);
+        for (int i = 0; i < 20000; ++i)
+            arbol.insert(i);
+        ASSERT(recurso.pedidos == pedidos && arbol.check_properties(),
+               "Reinserting after removing must reuse the freed blocks");
+        ASSERT(arbol.stats().bytesReservados == recurso.bytesVivos, "stats().bytesReservados must count the slabs");
+        arbol.clear();
+        ASSERT(recurso.bytesVivos == 0, "clear must return every slab to the memory_resource");
+        arbol.insert(1);
+    }
+    ASSERT(recurso.bytesVivos == 0, "The destructor must return every slab to the memory_resource");
+}
+
+// iteradores bidireccionales, lower/upper_bound, equal_range, find y el cursor
+static void iterators() {
+    BTree<int> vacio(4);
+    ASSERT(vacio.begin() == vacio.end() && vacio.lower_bound(3) == vacio.end() && vacio.find(3) == vacio.end(),
+           "The iterators of an empty tree must be end()");
+    ASSERT(!vacio.cursor(0, 10).valid(), "The cursor of an empty tree must be invalid");
+
+    for (int M : {3, 4, 5}) {
+        BTree<int> arbol(M);
+        std::set<int> modelo;
+        for (int x : aleatorias(2000, 10000, M)) {
+            arbol.insert(2 * x);
+            modelo.insert(2 * x);
+        }
+        std::vector<int> haciaAdelante(arbol.begin(), arbol.end());
+        ASSERT(haciaAdelante == ordenadas(modelo), "Forward iteration failed for M = " << M);
+
+        std::vector<int> haciaAtras;
+        for (auto it = arbol.end(); it != arbol.begin();)
+            haciaAtras.push_back(*--it);
+        ASSERT(std::equal(haciaAtras.begin(), haciaAtras.end(), modelo.rbegin(), modelo.rend()),
+               "Backward iteration from end() failed for M = " << M);
+
+        bool bien = true;
+        for (int x = -1; x <= 20001 && bien; x += 7) {
+            auto esperadoLower = modelo.lower_bound(x);
+            auto esperadoUpper = modelo.upper_bound(x);
+            auto lower = arbol.lower_bound(x);
+            auto upper = arbol.upper_bound(x);
+            bien = (lower == arbol.end()) == (esperadoLower == modelo.end())
+                   && (lower == arbol.end() || *lower == *esperadoLower)
+                   && (upper == arbol.end()) == (esperadoUpper == modelo.end())
+                   && (upper == arbol.end() || *upper == *esperadoUpper)
+                   && (arbol.find(x) != arbol.end()) == (modelo.count(x) == 1);
+            auto rango = arbol.equal_range(x);
+            bien = bien && std::distance(rango.first, rango.second) == static_cast<long>(modelo.count(x));
+        }
+        ASSERT(bien, "lower_bound/upper_bound/find/equal_range failed for M = " << M);
+
+        std::vector<int> porCursor;
+        for (auto c = arbol.cursor(1000, 3001); c.valid(); c.next())
+            porCursor.push_back(c.key());
+        ASSERT(porCursor == std::vector<int>(modelo.lower_bound(1000), modelo.upper_bound(3001)),
+               "The range cursor failed for M = " << M);
+        ASSERT(!arbol.cursor(3001, 1000).valid(), "A cursor with end < begin must be invalid");
+    }
+}
+
+// key que no se puede copiar
+struct ClaveUnica {
+    std::unique_ptr<int> valor;
+
+    ClaveUnica() = default;
+    explicit ClaveUnica(int x) : valor(std::make_unique<int>(x)) {}
+
+    bool operator<(const ClaveUnica& otra) const {
+        return *valor < *otra.valor;
+    }
+};
+
+// key que cuenta sus copias y movidas
+struct ClaveContada {
+    static inline int copias = 0;
+    static inline int movidas = 0;
+    int x = 0;
+
+    ClaveContada() = default;
+    ClaveContada(int x_) : x(x_) {}
+    ClaveContada(const ClaveContada& otra) : x(otra.x) { ++copias; }
+    ClaveContada(ClaveContada&& otra) noexcept : x(otra.x) { ++movidas; }
+
+    ClaveContada& operator=(const ClaveContada& otra) {
+        x = otra.x;
+        ++copias;
+        return *this;
+    }
+
+    ClaveContada& operator=(ClaveContada&& otra) noexcept {
+        x = otra.x;
+        ++movidas;
+        return *this;
+    }
+
+    bool operator<(const ClaveContada& otra) const {
+        return x < otra.x;
+    }
+};
+
+template <int ORDEN>
+static std::vector<int> valoresDe(const BTree<ClaveUnica, ORDEN>& arbol) {
+    std::vector<int> resultado;
+    for (auto it = arbol.begin(); it != arbol.end(); ++it)
+        resultado.push_back(*it->valor);
+    return resultado;
+}
+
+// insert(TK&&), emplace y keys que solo se pueden mover; insert(const TK&) copia una vez y solo si
+// la key es nueva, y rebalancear no copia keys
+static void moveKeys() {
+    for (int M : {3, 4, 5, 8}) {
+        BTree<ClaveUnica> arbol(M);
+        std::set<int> modelo;
+        for (int x : aleatorias(2000, 5000, M)) {
+            if (x % 2 == 0)
+                arbol.insert(ClaveUnica(x));
+            else
+                arbol.emplace(x);
+            modelo.insert(x);
+        }
+        bool bien = arbol.check_properties() && valoresDe(arbol) == ordenadas(modelo)
+                    && arbol.search(ClaveUnica(*modelo.begin())) && !arbol.search(ClaveUnica(-1));
+        for (int x : aleatorias(1000, 5000, M + 10)) {
+            arbol.remove(ClaveUnica(x));
+            modelo.erase(x);
+        }
+        bien = bien && arbol.check_properties() && valoresDe(arbol) == ordenadas(modelo);
+
+        if (M % 2 == 0) {
+            arbol.set_single_pass(true);
+            for (int x : aleatorias(1000, 5000, M + 20)) {
+                if (x % 3 == 0) {
+                    arbol.remove(ClaveUnica(x));
+                    modelo.erase(x);
+                } else {
+                    arbol.emplace(x);
+                    modelo.insert(x);
+                }
+            }
+            arbol.set_single_pass(false);
+            bien = bien && arbol.check_properties() && valoresDe(arbol) == ordenadas(modelo);
+        }
+
+        const int borradas = static_cast<int>(std::distance(modelo.lower_bound(1000), modelo.upper_bound(1500)));
+        bien = bien && arbol.remove_range(ClaveUnica(1000), ClaveUnica(1500)) == borradas;
+        modelo.erase(modelo.lower_bound(1000), modelo.upper_bound(1500));
+        std::unique_ptr<BTree<ClaveUnica>> derecho(arbol.split_at(ClaveUnica(2500)));
+        bien = bien && arbol.check_properties() && derecho->check_properties()
+               && valoresDe(arbol) == std::vector<int>(modelo.begin(), modelo.lower_bound(2500))
+               && valoresDe(*derecho) == std::vector<int>(modelo.lower_bound(2500), modelo.end());
+        arbol.join(*derecho);
+        bien = bien && derecho->empty() && arbol.check_properties() && valoresDe(arbol) == ordenadas(modelo);
+        ASSERT(bien, "A move-only key failed through insert/emplace/remove/single pass/remove_range/split_at/join for M = " << M);
+    }
+
+    BTree<ClaveUnica, 4> fijo;
+    for (int i = 0; i < 100; ++i)
+        fijo.emplace(100 - i);
+    ASSERT(fijo.check_properties() && fijo.size() == 100 && *fijo.begin()->valor == 1,
+           "A move-only key failed with BTree<TK, ORDEN>");
+
+    for (int M : {3, 4, 16}) {
+        for (bool unaPasada : {false, true}) {
+            if (unaPasada && M % 2 != 0)
+                continue;
+            BTree<ClaveContada> arbol(M);
+            arbol.set_single_pass(unaPasada);
+            std::vector<int> keys = aleatorias(3000, 1 << 20, M);
+            std::vector<ClaveContada> lvalues(keys.begin(), keys.end());
+            const std::set<int> primeraMitad(keys.begin(), keys.begin() + keys.size() / 2);
+
+            ClaveContada::copias = 0;
+            for (std::size_t i = 0; i < keys.size() / 2; ++i)
+                arbol.insert(ClaveContada(keys[i]));
+            for (std::size_t i = 0; i < keys.size() / 2; ++i)
+                arbol.emplace(keys[i] + (1 << 20));
+            ASSERT(ClaveContada::copias == 0,
+                   "insert(TK&&) and emplace must not copy keys, M = " << M << ": " << ClaveContada::copias << " copies");
+
+            const int antes = arbol.size();
+            ClaveContada::copias = 0;
+            for (std::size_t i = keys.size() / 2; i < keys.size(); ++i)
+                arbol.insert(lvalues[i]);
+            const int nuevas = arbol.size() - antes;
+            ASSERT(ClaveContada::copias == nuevas,
+                   "insert(const TK&) must copy each new key once, M = " << M << ": " << ClaveContada::copias
+                                                                          << " copies for " << nuevas << " new keys");
+            ClaveContada::copias = 0;
+            for (const ClaveContada& key : lvalues)
+                arbol.insert(key);
+            ASSERT(ClaveContada::copias == 0, "insert(const TK&) must not copy a key that is already there");
+
+            ClaveContada::copias = 0;
+            ClaveContada::movidas = 0;
+            for (const ClaveContada& key : lvalues)
+                arbol.remove(key);
+            ASSERT(ClaveContada::copias == 0 && ClaveContada::movidas > 0 && arbol.check_properties()
+                       && arbol.size() == static_cast<int>(primeraMitad.size()), // quedan las de emplace
+                   "remove must move keys when rebalancing, not copy them, M = " << M);
+        }
+    }
+}
+
+// BTreeMap: insert_or_assign, try_emplace, operator[], find y el valor de los iteradores
+static void btreeMap() {
+    BTreeMap<int, std::string> mapa(3);
+    ASSERT(mapa.find(1) == nullptr, "find on an empty map must return nullptr");
+    bool nuevas = true;
+    for (int i = 0; i < 500; ++i)
+        nuevas = mapa.insert_or_assign(i, std::to_string(i)) && nuevas;
+    ASSERT(nuevas && mapa.size() == 500 && mapa.check_properties(), "insert_or_assign must insert new keys");
+    ASSERT(!mapa.insert_or_assign(10, "diez") && *mapa.find(10) == "diez" && mapa.size() == 500,
+           "insert_or_assign must replace the value of an existing key");
+
+    Pair<std::string*, bool> emplazado = mapa.try_emplace(10, "otro");
+    ASSERT(!emplazado.second && *emplazado.first == "diez", "try_emplace must not replace an existing value");
+    emplazado = mapa.try_emplace(1000, 3, 'x');
+    ASSERT(emplazado.second && *emplazado.first == "xxx" && *mapa.find(1000) == "xxx",
+           "try_emplace must construct the value of a new key");
+    mapa[2000] += "nuevo";
+    mapa[10] += "!";
+    ASSERT(*mapa.find(2000) == "nuevo" && *mapa.find(10) == "diez!", "operator[] must insert or return the value");
+
+    bool bien = true;
+    for (auto it = mapa.begin(); it != mapa.end(); ++it)
+        bien = bien && it.value() == *mapa.find(*it);
+    ASSERT(bien, "The iterator values must match find");
+
+    for (int i = 0; i < 500; i += 2)
+        mapa.remove(i);
+    bien = mapa.check_properties();
+    for (int i = 1; i < 500 && bien; i += 2)
+        bien = mapa.find(i) != nullptr && *mapa.find(i) == std::to_string(i) && mapa.find(i - 1) == nullptr;
+    ASSERT(bien, "The values must follow their keys after removes");
+}
+
+// insert_sorted_batch (con repetidas, disperso y denso), remove_sorted_batch, remove_range y las
+// busquedas por lote
+static void sortedBatch() {
+    for (int M : {3, 4, 5, 32}) {
+        BTree<int> arbol(M);
+        std::set<int> modelo;
+        std::vector<int> lote = aleatorias(300, 2000, M);
+        lote.push_back(lote.front());
+        lote.push_back(lote.front());
+        std::sort(lote.begin(), lote.end()); // con repetidas
+        arbol.insert_sorted_batch(lote.begin(), lote.end());
+        modelo.insert(lote.begin(), lote.end());
+        ASSERT(arbol.check_properties() && keysDe(arbol) == ordenadas(modelo),
+               "insert_sorted_batch with duplicates failed for M = " << M);
+
+        // lote denso (mezcla y reconstruye) con keys que ya estan y repetidas
+        std::vector<int> denso = aleatorias(5000, 4000, M + 100);
+        std::sort(denso.begin(), denso.end());
+        arbol.insert_sorted_batch(denso.begin(), denso.end());
+        modelo.insert(denso.begin(), denso.end());
+        ASSERT(arbol.check_properties() && keysDe(arbol) == ordenadas(modelo) && arbol.size() == static_cast<int>(modelo.size()),
+               "A dense insert_sorted_batch failed for M = " << M);
+
+        std::vector<int> consultas = aleatorias(3000, 5000, M + 200);
+        std::vector<bool> encontradas;
+        arbol.search_batch(consultas.begin(), consultas.end(), encontradas);
+        bool bien = encontradas.size() == consultas.size();
+        for (std::size_t i = 0; i < consultas.size() && bien; ++i)
+            bien = encontradas[i] == (modelo.count(consultas[i]) == 1);
+        std::sort(consultas.begin(), consultas.end());
+        arbol.search_sorted_batch(consultas.begin(), consultas.end(), encontradas);
+        for (std::size_t i = 0; i < consultas.size() && bien; ++i)
+            bien = encontradas[i] == (modelo.count(consultas[i]) == 1);
+        ASSERT(bien, "search_batch/search_sorted_batch disagree with search for M = " << M);
+
+        std::vector<int> borrar = aleatorias(1500, 5000, M + 300);
+        std::sort(borrar.begin(), borrar.end());
+        arbol.remove_sorted_batch(borrar.begin(), borrar.end());
+        for (int x : borrar)
+            modelo.erase(x);
+        ASSERT(arbol.check_properties() && keysDe(arbol) == ordenadas(modelo),
+               "remove_sorted_batch failed for M = " << M);
+
+        bien = true;
+        for (auto rango : {std::pair<int, int>{10, 12}, {500, 1500}, {3000, 2000}, {-10, 100}, {3900, 100000}}) {
+            auto desde = modelo.lower_bound(rango.first);
+            auto hasta = modelo.upper_bound(rango.second);
+            const int esperadas = rango.first > rango.second ? 0 : static_cast<int>(std::distance(desde, hasta));
+            bien = bien && arbol.remove_range(rango.first, rango.second) == esperadas;
+            if (esperadas > 0)
+                modelo.erase(desde, hasta);
+            bien = bien && arbol.check_properties() && keysDe(arbol) == ordenadas(modelo);
+        }
+        ASSERT(bien, "remove_range failed for M = " << M);
+    }
+
+    BTree<int> vacio(4);
+    std::vector<int> nada;
+    vacio.insert_sorted_batch(nada.begin(), nada.end());
+    vacio.remove_sorted_batch(nada.begin(), nada.end());
+    ASSERT(vacio.empty() && vacio.remove_range(0, 10) == 0, "Empty batches on an empty tree must do nothing");
+    std::vector<int> repetidas(10, 5);
+    vacio.insert_sorted_batch(repetidas.begin(), repetidas.end());
+    ASSERT(vacio.size() == 1 && vacio.search(5), "A batch of one repeated key must insert it once");
+}
+
+// carga masiva en paralelo con distintos hilos, llenados y tamaños (0, 1, M - 1, M, muchas)
+static void parallelBuild() {
+    bool bien = true;
+    for (int M : {3, 4, 5, 8, 64}) {
+        for (int cantidad : {0, 1, M - 1, M, 1000, 50000}) {
+            std::vector<int> elements(cantidad);
+            for (int i = 0; i < cantidad; ++i)
+                elements[i] = 3 * i;
+            for (unsigned hilos : {1u, 4u}) {
+                for (double llenado : {0.5, 1.0}) {
+                    std::unique_ptr<BTree<int>> arbol(
+                        BTree<int>::build_from_ordered_vector_parallel(elements, M, hilos, llenado));
+                    bien = bien && arbol->check_properties() && arbol->size() == cantidad && keysDe(*arbol) == elements;
+                    arbol->insert(1);
+                    arbol->remove(0);
+                    bien = bien && arbol->check_properties();
+                }
+            }
+            std::unique_ptr<BTree<int>> secuencial(BTree<int>::build_from_ordered_vector(elements, M));
+            bien = bien && secuencial->check_properties() && keysDe(*secuencial) == elements;
+        }
+    }
+    ASSERT(bien, "build_from_ordered_vector(_parallel) failed");
+    std::vector<int> elements = {1, 2, 3};
+    ASSERT(lanza<std::invalid_argument>([&] { delete BTree<int>::build_from_ordered_vector_parallel(elements, 4, 2, 0.0); }),
+           "A fill factor outside (0, 1] must throw");
+}
+
+// ConcurrentBTree: varios hilos insertando, buscando y borrando a la vez
+static void concurrent() {
+    ConcurrentBTree<int> vacio(4);
+    ASSERT(vacio.empty() && !vacio.search(1) && !vacio.remove(1) && vacio.check_properties(),
+           "An empty ConcurrentBTree must not find keys");
+    ASSERT(vacio.insert(1) && !vacio.insert(1) && vacio.size() == 1 && vacio.remove(1) && vacio.empty(),
+           "insert/remove must report whether the key was there");
+
+    ASSERT(lanza<std::invalid_argument>([] { ConcurrentBTree<int> arbol(5); }), "An odd degree must throw");
+
+    for (int M : {4, 6, 32}) {
+        ConcurrentBTree<int> arbol(M);
+        const int HILOS = 4;
+        const int POR_HILO = 5000;
+        std::atomic<bool> listo{false};
+        std::atomic<int> fallas{0};
+        std::vector<std::thread> hilos;
+        for (int h = 0; h < HILOS; ++h) {
+            hilos.emplace_back([&, h] {
+                for (int i = 0; i < POR_HILO; ++i) {
+                    if (!arbol.insert(i * HILOS + h))
+                        ++fallas;
+                }
+                for (int i = 0; i < POR_HILO; i += 2) { // las keys propias insertadas siguen ahi
+                    if (!arbol.search(i * HILOS + h) || !arbol.remove(i * HILOS + h))
+                        ++fallas;
+                }
+            });
+        }
+        std::thread lector([&] { // busquedas de keys que nunca se insertan mientras el arbol cambia
+            while (!listo.load()) {
+                for (int x = -100; x < 0; ++x) {
+                    if (arbol.search(x))
+                        ++fallas;
+                }
+            }
+        });
+        for (std::thread& hilo : hilos)
+            hilo.join();
+        listo.store(true);
+        lector.join();
+
+        bool bien = fallas.load() == 0 && arbol.check_properties() && arbol.size() == HILOS * POR_HILO / 2;
+        for (int x = 0; x < HILOS * POR_HILO && bien; ++x)
+            bien = arbol.search(x) == ((x / HILOS) % 2 == 1);
+        ASSERT(bien, "Concurrent insert/search/remove failed for M = " << M);
+    }
+}
+
+// inserts ordenados: el dedo de la ultima hoja, su invalidacion (forma) y cederAlHermano, que deja
+// los nodos llenos en lugar de a la mitad como el split por la mediana
+static void sequentialInsert() {
+    const int N = 20000;
+    for (int M : {3, 4, 5, 8, 9, 64}) {
+        for (bool unaPasada : {false, true}) {
+            if (unaPasada && M % 2 != 0)
+                continue;
+            for (bool ascendente : {true, false}) {
+                BTree<int> arbol(M);
+                arbol.set_single_pass(unaPasada);
+                std::shared_ptr<const BTree<int>> foto;
+                for (int i = 0; i < N; ++i) {
+                    arbol.insert(ascendente ? i : N - 1 - i);
+                    if (i == N / 2)
+                        foto = arbol.snapshot();
+                }
+                std::vector<int> todas(N);
+                for (int i = 0; i < N; ++i)
+                    todas[i] = i;
+                std::vector<int> enLaFoto(ascendente ? todas.begin() : todas.end() - N / 2 - 1,
+                                          ascendente ? todas.begin() + N / 2 + 1 : todas.end());
+                const EstadisticasBTree e = arbol.stats();
+                const double llenado = static_cast<double>(e.keys) / e.nodos / (M - 1);
+                ASSERT(arbol.check_properties() && keysDe(arbol) == todas && foto->check_properties() && keysDe(*foto) == enLaFoto,
+                       "Ordered inserts failed for M = " << M << (unaPasada ? ", single pass" : "")
+                                                         << (ascendente ? ", ascending" : ", descending"));
+                ASSERT(llenado > 0.9, "Ordered inserts must fill the nodes (a median split leaves them about half full): "
+                                          << llenado << " for M = " << M << (unaPasada ? ", single pass" : "")
+                                          << (ascendente ? ", ascending" : ", descending"));
+            }
+        }
+    }
+
+    // el dedo se descarta cuando otra operacion cambia la forma del arbol
+    for (int M : {3, 4}) {
+        BTree<int> arbol(M);
+        std::set<int> modelo;
+        int siguiente = 0;
+        auto agregar = [&](int cantidad) {
+            for (int i = 0; i < cantidad; ++i, ++siguiente) {
+                arbol.insert(siguiente);
+                modelo.insert(siguiente);
+            }
+            return arbol.check_properties() && keysDe(arbol) == ordenadas(modelo);
+        };
+        bool bien = agregar(1000);
+        for (int x = siguiente - 1; x > siguiente - 200; --x) { // borra al final y el dedo queda viejo
+            arbol.remove(x);
+            modelo.erase(x);
+        }
+        siguiente -= 150; // unas keys ya estan: se ignoran
+        bien = bien && agregar(500);
+        bien = bien && arbol.remove_range(siguiente - 300, siguiente) == 300; // siguiente no esta
+        modelo.erase(modelo.lower_bound(siguiente - 300), modelo.end());
+        bien = bien && agregar(500);
+        std::unique_ptr<BTree<int>> derecho(arbol.split_at(siguiente - 100));
+        modelo.erase(modelo.lower_bound(siguiente - 100), modelo.end());
+        bien = bien && agregar(500);
+        arbol.insert(-1); // no pasa por el dedo
+        modelo.insert(-1);
+        bien = bien && agregar(100);
+        arbol.clear();
+        modelo.clear();
+        bien = bien && agregar(300);
+        ASSERT(bien, "The finger must be dropped when the tree changes shape, M = " << M);
+    }
+}
+
+// modo de una pasada: solo con M par, y con el mismo resultado que el modo normal
+static void singlePass() {
+    BTree<int> impar(5);
+    ASSERT(lanza<std::invalid_argument>([&] { impar.set_single_pass(true); }) && !impar.single_pass(),
+           "The single-pass mode must reject an odd degree");
+    for (int M : {4, 6, 16}) {
+        BTree<int> arbol(M);
+        arbol.set_single_pass(true);
+        ASSERT(arbol.single_pass() && operacionesAlAzar(arbol, 5000, 800, M),
+               "Single-pass random insert/remove failed for M = " << M);
+    }
+    BTree<int, 4> fijo;
+    fijo.set_single_pass(true);
+    ASSERT(operacionesAlAzar(fijo, 5000, 800, 9), "Single-pass random insert/remove failed for BTree<int, 4>");
+}
+
+// snapshots: no ven los cambios posteriores, pueden vivir mas que el arbol y leerse desde otro hilo
+static void snapshots() {
+    BTree<int> vacio(4);
+    std::shared_ptr<const BTree<int>> deVacio = vacio.snapshot();
+    vacio.insert(1);
+    ASSERT(deVacio->empty() && vacio.size() == 1, "The snapshot of an empty tree must stay empty");
+
+    for (int M : {3, 4, 5}) {
+        auto arbol = std::make_unique<BTree<int>>(M);
+        std::set<int> modelo;
+        bool bien = operacionesAlAzar(*arbol, modelo, 2000, 1000, M);
+        std::shared_ptr<const BTree<int>> foto = arbol->snapshot();
+        const std::vector<int> antes = ordenadas(modelo);
+
+        std::atomic<bool> listo{false};
+        std::atomic<bool> lecturasBien{true};
+        std::thread lector([&] {
+            while (!listo.load()) {
+                if (keysDe(*foto) != antes)
+                    lecturasBien = false;
+            }
+        });
+        bien = bien && operacionesAlAzar(*arbol, modelo, 3000, 1000, M + 10);
+        listo.store(true);
+        lector.join();
+        ASSERT(bien && lecturasBien.load() && foto->check_properties() && keysDe(*foto) == antes,
+               "A snapshot must not see later changes for M = " << M);
+
+        arbol.reset();
+        ASSERT(foto->check_properties() && keysDe(*foto) == antes, "A snapshot must outlive its tree");
+    }
+}
+
+// DiskBTree: operaciones contra un std::set, y el contenido persiste al reabrir el archivo
+static void diskBTree() {
+    const std::string ruta = "tests_disk_btree.bin";
+    std::remove(ruta.c_str());
+    std::set<int> modelo;
+    {
+        DiskBTree<int> arbol(ruta, 128, 8);
+        ASSERT(arbol.empty() && !arbol.search(1) && arbol.order() % 2 == 0 && arbol.order() >= 4,
+               "A new DiskBTree must be empty and have an even order");
+        ASSERT(operacionesAlAzar(arbol, modelo, 5000, 3000, 1), "DiskBTree random insert/remove failed");
+        arbol.flush();
+        DiskBTree<int> lector(ruta, 128, 8); // otra vista del archivo mientras el arbol sigue abierto
+        ASSERT(keysDe(lector) == ordenadas(modelo) && lector.check_properties(),
+               "After flush() the file must hold every key without closing the tree");
+    }
+    {
+        DiskBTree<int> arbol(ruta, 128, 8);
+        ASSERT(arbol.size() == static_cast<int>(modelo.size()) && keysDe(arbol) == ordenadas(modelo) && arbol.check_properties(),
+               "A reopened DiskBTree must keep its keys");
+        ASSERT(arbol.rangeSearch(100, 200) == std::vector<int>(modelo.lower_bound(100), modelo.upper_bound(200)),
+               "DiskBTree rangeSearch failed");
+    }
+    ASSERT(lanza<std::runtime_error>([&] { DiskBTree<int> otro(ruta, 256); }),
+           "Opening a DiskBTree with another page size must throw");
+    std::remove(ruta.c_str());
+
+    // un error de escritura sale de flush() y no del destructor (lanzar ahi llama a std::terminate):
+    // con RLIMIT_FSIZE al tamaño actual del archivo las paginas nuevas no se pueden escribir
+    {
+        struct rlimit antes;
+        ::getrlimit(RLIMIT_FSIZE, &antes);
+        void (*senal)(int) = std::signal(SIGXFSZ, SIG_IGN); // pwrite falla con EFBIG en lugar de matar el proceso
+        bool lanzo = false;
+        {
+            DiskBTree<int> arbol(ruta, 128, 64);
+            for (int i = 0; i < 200; ++i) // entran en el buffer pool sin desalojar paginas
+                arbol.insert(i);
+            struct rlimit limite = antes;
+            limite.rlim_cur = 128; // solo la cabecera
+            ::setrlimit(RLIMIT_FSIZE, &limite);
+            lanzo = lanza<std::runtime_error>([&] { arbol.flush(); });
+        } // el destructor vuelve a fallar al escribir
+        ::setrlimit(RLIMIT_FSIZE, &antes);
+        std::signal(SIGXFSZ, senal);
+        ASSERT(lanzo, "flush() must throw when a page cannot be written");
+        std::remove(ruta.c_str());
+    }
+
+    // paginas que no guardan la cabecera o un nodo con M >= 4 (la cabecera ocupa 40 bytes)
+    auto paginaChica = [&](auto key, std::size_t bytesPagina) {
+        try {
+            DiskBTree<decltype(key)> arbol(ruta, bytesPagina);
+        } catch (const std::invalid_argument& e) {
+            return std::string(e.what()) == "Pagina demasiado chica";
+        } catch (...) {
+        }
+        return false;
+    };
+    struct Grande {
+        char bytes[64];
+    };
+    ASSERT(paginaChica(0, 0) && paginaChica(0, 8) && paginaChica(0, 16) && paginaChica(0, 24) && paginaChica(0, 32)
+               && paginaChica(0, 39) && paginaChica(Grande{}, 215),
+           "A page too small for the header or for M = 4 must throw \"Pagina demasiado chica\"");
+    std::FILE* archivo = std::fopen(ruta.c_str(), "rb");
+    ASSERT(archivo == nullptr, "A rejected page size must not create the file");
+    if (archivo != nullptr)
+        std::fclose(archivo);
+    ASSERT(DiskBTree<int>(ruta, 40).order() == 4, "A 40-byte page must hold M = 4 with int keys");
+    std::remove(ruta.c_str());
+    ASSERT(DiskBTree<Grande>(ruta, 216).order() == 4, "A 216-byte page must hold M = 4 with 64-byte keys");
+    std::remove(ruta.c_str());
+}
+
+// save/load: vuelta completa con otro M, arbol vacio, valores y archivos invalidos
+static void serialization() {
+    BTree<int> vacio(4);
+    std::stringstream flujo;
+    vacio.save(flujo);
+    BTree<int> cargado(3);
+    cargado.insert(5);
+    cargado.load(flujo);
+    ASSERT(cargado.empty() && cargado.check_properties(), "Loading an empty tree must leave it empty");
+
+    for (int M : {3, 4, 5}) {
+        BTree<int> arbol(M);
+        std::set<int> modelo;
+        bool bien = operacionesAlAzar(arbol, modelo, 3000, 2000, M);
+        std::stringstream guardado;
+        arbol.save(guardado);
+        BTree<int> otro(M + 7);
+        otro.load(guardado, 2);
+        ASSERT(bien && otro.check_properties() && keysDe(otro) == ordenadas(modelo),
+               "save/load must keep the keys for M = " << M);
+    }
+
+    BTreeMap<int, double> mapa(4);
+    for (int i = 0; i < 1000; ++i)
+        mapa.insert_or_assign(i, i * 0.5);
+    std::stringstream guardado;
+    mapa.save(guardado);
+    BTreeMap<int, double> otroMapa(3);
+    otroMapa.load(guardado);
+    bool bien = otroMapa.size() == 1000 && otroMapa.check_properties();
+    for (int i = 0; i < 1000 && bien; ++i)
+        bien = otroMapa.find(i) != nullptr && *otroMapa.find(i) == i * 0.5;
+    ASSERT(bien, "save/load must keep the values of a BTreeMap");
+
+    std::stringstream basura("no es un arbol");
+    ASSERT(lanza<std::runtime_error>([&] { cargado.load(basura); }), "Loading garbage must throw");
+    std::stringstream deOtroTipo;
+    mapa.save(deOtroTipo);
+    ASSERT(lanza<std::runtime_error>([&] { cargado.load(deOtroTipo); }), "Loading another key/value type must throw");
+}
+
+// CompressedBTree con enteros (FOR) y strings (prefijos), con B chico para tener varios niveles
+static void compressedKeys() {
+    CompressedBTree<int> vacio;
+    ASSERT(vacio.empty() && vacio.height() == 0 && !vacio.search(1) && vacio.rangeSearch(0, 10).empty(),
+           "An empty CompressedBTree must not find keys");
+
+    CompressedBTree<int, 4> una(std::vector<int>{42});
+    ASSERT(una.size() == 1 && una.search(42) && !una.search(41) && una.minKey() == 42 && una.maxKey() == 42,
+           "A CompressedBTree with one key failed");
+
+    std::set<int> modelo;
+    for (int x : aleatorias(5000, 1 << 30, 1))
+        modelo.insert(x - (1 << 29));
+    std::vector<int> keys = ordenadas(modelo);
+    CompressedBTree<int, 4> enteros(keys);
+    bool bien = enteros.size() == static_cast<int>(keys.size()) && enteros.height() > 1
+                && enteros.minKey() == keys.front() && enteros.maxKey() == keys.back();
+    for (int x : aleatorias(2000, 1 << 30, 2))
+        bien = bien && enteros.search(x - (1 << 29)) == (modelo.count(x - (1 << 29)) == 1);
+    for (int x : keys)
+        bien = bien && enteros.search(x);
+    ASSERT(bien, "CompressedBTree<int> search failed");
+    ASSERT(keysDe(enteros) == keys && enteros.rangeSearch(0, 1000000) == std::vector<int>(modelo.lower_bound(0), modelo.upper_bound(1000000)),
+           "CompressedBTree<int> rangeSearch failed");
+
+    std::vector<std::string> palabras;
+    for (int i = 0; i < 3000; ++i)
+        palabras.push_back("/usuarios/" + std::to_string(100000 + i * 7));
+    CompressedBTree<std::string, 8> strings(palabras);
+    bien = strings.size() == 3000 && strings.search("/usuarios/100007") && !strings.search("/usuarios/100008")
+           && !strings.search("") && !strings.search("/usuarios/") && strings.bytes() < 3000 * sizeof(std::string);
+    ASSERT(bien, "CompressedBTree<std::string> search failed");
+    ASSERT(strings.rangeSearch("/usuarios/100700", "/usuarios/100721")
+               == std::vector<std::string>(palabras.begin() + 100, palabras.begin() + 104),
+           "CompressedBTree<std::string> rangeSearch failed");
+
+    std::vector<int> desordenadas = {3, 1, 2};
+    ASSERT(lanza<std::invalid_argument>([&] { CompressedBTree<int> arbol(desordenadas); }),
+           "Unsorted keys must throw");
+}
+
+// rank/select/count_range/median/percentile contra un vector ordenado
+static void orderStatistics() {
+    for (int M : {3, 4, 5}) {
+        BTree<int, 0, void, true> arbol(M);
+        std::set<int> modelo;
+        bool bien = operacionesAlAzar(arbol, modelo, 4000, 3000, M);
+        std::vector<int> keys = ordenadas(modelo);
+        const int n = static_cast<int>(keys.size());
+        for (int i = 0; i < n && bien; ++i)
+            bien = arbol.select(i) == keys[i] && arbol.rank(keys[i]) == i;
+        for (int x = -5; x < 3005 && bien; x += 13)
+            bien = arbol.rank(x) == std::lower_bound(keys.begin(), keys.end(), x) - keys.begin()
+                   && arbol.count_range(x, x + 100)
+                          == std::upper_bound(keys.begin(), keys.end(), x + 100) - std::lower_bound(keys.begin(), keys.end(), x);
+        ASSERT(bien, "rank/select/count_range failed for M = " << M);
+        ASSERT(arbol.median() == keys[(n - 1) / 2] && arbol.percentile(0) == keys[0] && arbol.percentile(1) == keys[n - 1]
+                   && arbol.percentile(0.5) == keys[(n + 1) / 2 - 1],
+               "median/percentile failed for M = " << M);
+        ASSERT(arbol.count_range(100, 50) == 0, "count_range with end < begin must be 0");
+        ASSERT(lanza<std::out_of_range>([&] { arbol.select(-1); }) && lanza<std::out_of_range>([&] { arbol.select(n); }),
+               "select outside [0, n) must throw");
+        ASSERT(lanza<std::invalid_argument>([&] { arbol.percentile(1.5); }), "A percentile outside [0, 1] must throw");
+    }
+
+    BTree<int, 0, void, true> vacio(3);
+    ASSERT(vacio.rank(5) == 0 && vacio.count_range(0, 10) == 0, "rank/count_range of an empty tree must be 0");
+    ASSERT(lanza<std::out_of_range>([&] { vacio.select(0); }) && lanza<std::out_of_range>([&] { vacio.median(); }),
+           "select/median of an empty tree must throw");
+    ASSERT(lanza<std::out_of_range>([&] { vacio.percentile(0); }) && lanza<std::out_of_range>([&] { vacio.percentile(0.5); })
+               && lanza<std::out_of_range>([&] { vacio.percentile(1); }),
+           "percentile of an empty tree must throw");
+    ASSERT(lanza<std::invalid_argument>([&] { vacio.percentile(-0.1); }), "An invalid percentile is checked first");
+
+    BTree<int, 0, void, true> una(3);
+    una.insert(9);
+    ASSERT(una.select(0) == 9 && una.median() == 9 && una.percentile(0.3) == 9 && una.rank(10) == 1,
+           "Order statistics of a single key failed");
+}
+
+// split_at, join y union/interseccion/diferencia contra std::set_*
+static void setOps() {
+    for (int M : {3, 4, 5, 16}) {
+        std::vector<int> x = aleatorias(3000, 6000, M);
+        std::vector<int> y = aleatorias(2000, 6000, M + 50);
+        std::set<int> a(x.begin(), x.end());
+        std::set<int> b(y.begin(), y.end());
+        auto arbolDe = [M](const std::set<int>& keys) {
+            auto arbol = std::make_unique<BTree<int>>(M);
+            for (int k : keys)
+                arbol->insert(k);
+            return arbol;
+        };
+        std::vector<int> esperado;
+
+        auto unionAB = arbolDe(a);
+        auto otroB = arbolDe(b);
+        unionAB->set_union(*otroB);
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(esperado));
+        ASSERT(unionAB->check_properties() && keysDe(*unionAB) == esperado && otroB->empty(),
+               "set_union failed for M = " << M);
+
+        esperado.clear();
+        auto interseccion = arbolDe(a);
+        interseccion->set_intersection(*arbolDe(b));
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(esperado));
+        ASSERT(interseccion->check_properties() && keysDe(*interseccion) == esperado,
+               "set_intersection failed for M = " << M);
+
+        esperado.clear();
+        auto diferencia = arbolDe(a);
+        diferencia->set_difference(*arbolDe(b));
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(esperado));
+        ASSERT(diferencia->check_properties() && keysDe(*diferencia) == esperado,
+               "set_difference failed for M = " << M);
+
+        bool bien = true;
+        for (int corte : {-1, 0, 1500, 3000, 6000}) {
+            auto arbol = arbolDe(a);
+            std::unique_ptr<BTree<int>> derecho(arbol->split_at(corte));
+            bien = bien && arbol->check_properties() && derecho->check_properties()
+                   && keysDe(*arbol) == std::vector<int>(a.begin(), a.lower_bound(corte))
+                   && keysDe(*derecho) == std::vector<int>(a.lower_bound(corte), a.end());
+            arbol->join(*derecho);
+            bien = bien && derecho->empty() && arbol->check_properties() && keysDe(*arbol) == ordenadas(a);
+        }
+        ASSERT(bien, "split_at/join failed for M = " << M);
+    }
+
+    // split_at de un BTreeMap retorna un BTreeMap: el pedazo derecho conserva find, operator[], ...
+    for (int M : {3, 4}) {
+        BTreeMap<int, std::string> mapa(M);
+        for (int i = 0; i < 1000; ++i)
+            mapa.insert_or_assign(i, std::to_string(i));
+        std::unique_ptr<BTreeMap<int, std::string>> mayores(mapa.split_at(600));
+        bool bien = mapa.size() == 600 && mayores->size() == 400 && mapa.check_properties() && mayores->check_properties();
+        for (int i = 0; i < 1000 && bien; ++i) {
+            const BTreeMap<int, std::string>& tiene = i < 600 ? mapa : *mayores;
+            const BTreeMap<int, std::string>& noTiene = i < 600 ? *mayores : mapa;
+            bien = tiene.find(i) != nullptr && *tiene.find(i) == std::to_string(i) && noTiene.find(i) == nullptr;
+        }
+        (*mayores)[2000] = "nuevo";
+        bien = bien && mayores->insert_or_assign(600, "seiscientos") == false && *mayores->find(2000) == "nuevo";
+        mapa.join(*mayores);
+        bien = bien && mayores->empty() && mapa.size() == 1001 && mapa.check_properties()
+               && *mapa.find(600) == "seiscientos" && *mapa.find(599) == "599" && *mapa.find(2000) == "nuevo";
+        ASSERT(bien, "BTreeMap::split_at/join failed for M = " << M);
+    }
+
+    BTree<int> vacio(4);
+    std::unique_ptr<BTree<int>> derecho(vacio.split_at(5));
+    ASSERT(vacio.empty() && derecho->empty(), "Splitting an empty tree must give two empty trees");
+    BTree<int> menores(4);
+    BTree<int> mayores(4);
+    menores.insert(10);
+    mayores.insert(5);
+    ASSERT(lanza<std::invalid_argument>([&] { menores.join(mayores); }), "join with overlapping keys must throw");
+    BTree<int> otroGrado(5);
+    otroGrado.insert(20);
+    ASSERT(lanza<std::invalid_argument>([&] { menores.join(otroGrado); }), "join with another degree must throw");
+}
+
+// Compare: orden descendente y busquedas heterogeneas con std::less<>
+static void transparentLookup() {
+    BTree<int, 0, void, false, std::greater<int>> descendente(3);
+    std::set<int, std::greater<int>> modelo;
+    std::mt19937 gen(1);
+    bool bien = true;
+    for (int i = 0; i < 2000 && bien; ++i) { // como operacionesAlAzar, que compara en orden ascendente
+        int x = static_cast<int>(gen() % 500);
+        if (i % 3 == 0) {
+            descendente.remove(x);
+            modelo.erase(x);
+        } else {
+            descendente.insert(x);
+            modelo.insert(x);
+        }
+        bien = i % 97 != 0 || descendente.check_properties();
+    }
+    ASSERT(bien && std::vector<int>(descendente.begin(), descendente.end()) == std::vector<int>(modelo.begin(), modelo.end())
+               && descendente.rangeSearch(400, 100) == std::vector<int>(modelo.lower_bound(400), modelo.upper_bound(100)),
+           "BTree with std::greater random insert/remove failed");
+    descendente.clear();
+    for (int i = 1; i <= 5; ++i)
+        descendente.insert(i);
+    ASSERT(descendente.toString(",") == "5,4,3,2,1" && *descendente.begin() == 5 && descendente.minKey() == 5,
+           "BTree with std::greater must keep the keys in descending order");
+    ASSERT(*descendente.lower_bound(3) == 3 && *descendente.upper_bound(3) == 2,
+           "lower_bound/upper_bound must follow the comparator");
+
+    BTree<std::string, 0, void, false, std::less<>> palabras(4);
+    for (const char* palabra : {"pera", "manzana", "uva", "kiwi", "banana"})
+        palabras.insert(palabra);
+    std::string_view buscada = "uvas";
+    ASSERT(palabras.search(buscada.substr(0, 3)) && !palabras.search(buscada) && palabras.search("kiwi"),
+           "Transparent search with string_view/const char* failed");
+    ASSERT(*palabras.lower_bound(std::string_view("m")) == "manzana" && palabras.find("naranja") == palabras.end(),
+           "Transparent lower_bound/find failed");
+    std::vector<std::string> porCursor;
+    for (auto c = palabras.cursor("c", "p"); c.valid(); c.next())
+        porCursor.push_back(c.key());
+    ASSERT(porCursor == std::vector<std::string>({"kiwi", "manzana"}), "A transparent cursor failed");
+
+    BTreeMap<std::string, int, 0, std::less<>> mapa(3);
+    mapa.insert_or_assign("a", 1);
+    mapa.insert_or_assign("b", 2);
+    ASSERT(mapa.find(std::string_view("b")) != nullptr && *mapa.find(std::string_view("b")) == 2
+               && mapa.find(std::string_view("c")) == nullptr,
+           "Transparent BTreeMap::find failed");
+}
+
+// BPlusTree: hojas enlazadas para recorrer rangos
+static void rangeScan() {
+    BPlusTree<int> vacio(4);
+    ASSERT(vacio.empty() && vacio.height() == 0 && !vacio.search(1) && vacio.rangeSearch(0, 10).empty(),
+           "An empty BPlusTree must not find keys");
+    for (int M : {3, 4, 5, 32}) {
+        BPlusTree<int> arbol(M);
+        std::set<int> modelo;
+        ASSERT(operacionesAlAzar(arbol, modelo, 4000, 1000, M), "BPlusTree random insert/remove failed for M = " << M);
+        std::vector<int> visitadas;
+        arbol.rangeScan(200, 400, [&](const int& key) { visitadas.push_back(key); });
+        ASSERT(visitadas == std::vector<int>(modelo.lower_bound(200), modelo.upper_bound(400)),
+               "BPlusTree rangeScan failed for M = " << M);
+
+        std::vector<int> keys = ordenadas(modelo);
+        std::unique_ptr<BPlusTree<int>> construido(BPlusTree<int>::build_from_ordered_vector(keys, M));
+        ASSERT(construido->check_properties() && keysDe(*construido) == keys,
+               "BPlusTree build_from_ordered_vector failed for M = " << M);
+    }
+}
+
+struct Bloque {
+    const char* nombre;
+    void (*correr)();
+};
+
+static const Bloque BLOQUES[] = {
+    {"btree_map", btreeMap},
+    {"compressed_keys", compressedKeys},
+    {"concurrent", concurrent},
+    {"counters", counters},
+    {"disk_btree", diskBTree},
+    {"edge_cases", edgeCases},
+    {"iterators", iterators},
+    {"move_keys", moveKeys},
+    {"node_pool", nodePool},
+    {"node_search", nodeSearch},
+    {"order_statistics", orderStatistics},
+    {"parallel_build", parallelBuild},
+    {"range_scan", rangeScan},
+    {"sequential_insert", sequentialInsert},
+    {"serialization", serialization},
+    {"set_ops", setOps},
+    {"single_pass", singlePass},
+    {"snapshots", snapshots},
+    {"sorted_batch", sortedBatch},
+    {"static_order", staticOrder},
+    {"transparent_lookup", transparentLookup},
+};
+
+int main(int argc, char** argv) {
+    bool encontrado = false;
+    for (const Bloque& bloque : BLOQUES) {
+        if (argc > 1 && std::strcmp(argv[1], bloque.nombre) != 0)
+            continue;
+        encontrado = true;
+        try {
+            bloque.correr();
+        } catch (const std::exception& e) {
+            std::cerr << bloque.nombre << ": excepcion inesperada: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (!encontrado) {
+        std::cerr << "No hay un bloque " << argv[1] << std::endl;
+        return 2;
+    }
+    return TrueAsserts == TotalAsserts ? 0 : 1;
+}